@@ -0,0 +1,102 @@
+#pragma once
+// Minimal microbenchmark harness for the [env:native] build.
+// Each BENCH() registers a function; bench_main.cpp runs them in order
+// (optionally filtered by a substring: `.pio/build/native/program proto`).
+// C# tether: a stripped-down BenchmarkDotNet with one line per result.
+
+#include <Arduino.h>
+#include <NimBLEDevice.h>
+#include <ShimHeap.hpp>
+#include <chrono>
+
+namespace bench {
+
+/// Timing + heap delta for `iters` runs of one operation.
+struct Sample {
+  uint64_t iters  = 0;
+  double   ns     = 0;   // wall time for all iterations
+  uint64_t allocs = 0;   // operator new calls during the run
+  uint64_t bytes  = 0;   // bytes requested from the heap
+
+  double usPerOp() const     { return iters ? ns / 1000.0 / iters : 0; }
+  double opsPerSec() const   { return ns > 0 ? iters * 1e9 / ns : 0; }
+  double allocsPerOp() const { return iters ? (double)allocs / iters : 0; }
+};
+
+/// Run `body(i)` for i in [0, iters) and measure it.
+template<typename F>
+Sample run(uint64_t iters, F&& body) {
+  using Clock = std::chrono::steady_clock;
+  const shim::HeapStats h0 = shim::heapStats();
+  const auto t0 = Clock::now();
+  for (uint64_t i = 0; i < iters; ++i) body(i);
+  const auto t1 = Clock::now();
+  const shim::HeapStats h1 = shim::heapStats();
+
+  Sample s;
+  s.iters  = iters;
+  s.ns     = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+  s.allocs = h1.allocs - h0.allocs;
+  s.bytes  = h1.bytes - h0.bytes;
+  return s;
+}
+
+/// Print one result line: name, throughput in `unit`/s, µs/op, allocs/op, then free-form extras.
+void report(const char* name, const Sample& s, const char* unit, const char* extraFmt = nullptr, ...)
+  __attribute__((format(printf, 4, 5)));
+
+/// Print a throughput line where the unit is bytes (reports MB/s instead of ops/s).
+void reportBytes(const char* name, const Sample& s, uint64_t bytesPerOp, const char* extraFmt = nullptr, ...)
+  __attribute__((format(printf, 4, 5)));
+
+/// "ok", or "DIFF" for a result that does not match what it must; any DIFF
+/// makes the run exit non-zero, so the suite can gate a change.
+const char* check(bool ok);
+
+/// Modeled SH1106 bus time for `bytes` at the I2C clock OledView uses (9 bit-times per byte).
+inline double i2cMicros(uint64_t bytes, uint32_t hz = 400000) { return bytes * 9.0 * 1e6 / hz; }
+
+/// Modeled BLE air time: one notification per 7.5 ms connection event (the
+/// floor a phone central usually grants; faster links just scale it).
+inline double bleAirMs(uint64_t notifies) { return notifies * 7.5; }
+
+/// The BLE server, with no central left connected by an earlier bench. One
+/// server is shared; a bench run alone may reach this before any begin()
+/// has created it.
+inline NimBLEServer* freshServer() {
+  NimBLEServer* server = NimBLEDevice::createServer();
+  for (uint16_t h : server->getPeerDevices()) server->shimDisconnect(h);
+  return server;
+}
+
+/// Deterministic prose-like text (words from a small vocabulary, seeded), so
+/// compression ratios are not flattered by repeating one line.
+inline String prose(size_t n, uint32_t seed) {
+  static const char* const W[] = {
+    "the", "a", "to", "and", "of", "in", "is", "it", "you", "that", "for", "on", "with", "as",
+    "battery", "journal", "watch", "model", "token", "stream", "answer", "prompt", "today",
+    "meeting", "remember", "because", "should", "could", "notes", "idea", "later", "first",
+    "walk", "coffee", "project", "build", "firmware", "display", "button", "reply", "short",
+    "question", "maybe", "really", "about", "after", "before", "morning", "evening", "plan",
+  };
+  String s;
+  s.reserve(n);
+  uint32_t x = seed * 2654435761u + 1;
+  while (s.length() < n) {
+    x = x * 1664525u + 1013904223u;
+    if (s.length()) s += ((x >> 8) % 13 == 0) ? ". " : " ";
+    s += W[(x >> 16) % (sizeof(W) / sizeof(W[0]))];
+  }
+  s.remove(n);
+  return s;
+}
+
+using Fn = void (*)();
+int add(const char* name, Fn fn);
+
+} // namespace bench
+
+#define BENCH(id) \
+  static void id(); \
+  static const int id##_registered = bench::add(#id, id); \
+  static void id()
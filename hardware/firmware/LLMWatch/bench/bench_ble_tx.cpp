@@ -0,0 +1,117 @@
+// BLE transmit path: BleJournal::notifyBytes -> BleTxQueue -> NimBLECharacteristic::notify.
+
+#include "Bench.hpp"
+#include "BleJournal.hpp"
+#include "BleLink.hpp"
+#include "ProtoV1.hpp"
+
+namespace {
+  NimBLECharacteristic* textChar() {
+    return NimBLEDevice::getServer()->getServiceByUUID(UUID_SVC)->getCharacteristic(UUID_TEXT);
+  }
+
+  // The pre-queue notifyBytes slept 5 ms after every notification.
+  constexpr uint32_t OLD_DELAY_MS = 5;
+}
+
+BENCH(ble_txQueue) {
+  static BleJournal ble;
+  ble.begin("bench-tx", [](const String&) {});
+  NimBLECharacteristic* text = textChar();
+  NimBLEDevice::getServer()->shimConnect(185);
+  const size_t chunk = ble.payloadSize();
+
+  // 1) Caller-blocked time for a 4 KB READALL-sized reply.
+  std::string body(4000, 'x');
+  for (size_t i = 63; i < body.size(); i += 64) body[i] = '\n';
+  text->shimDeferStatus = true;              // stack keeps the buffers until we say so
+  const uint32_t v0 = millis();
+  const bench::Sample send = bench::run(1, [&](uint64_t) {
+    // One message per line, as ProtoV1 DATA lines are: control traffic may cut in between.
+    for (size_t i = 0; i < body.size(); i += 64)
+      ble.notifyBytes((const uint8_t*)body.data() + i, std::min<size_t>(64, body.size() - i), TxPrio::Bulk);
+  });
+  const uint32_t blockedMs = millis() - v0;
+  const uint32_t notifies = (uint32_t)((body.size() + chunk - 1) / chunk);
+  bench::report("ble.tx.reply4k.enqueue", send, "reply",
+                "blocked=%ums (was %ums: %u notifies x %ums)",
+                (unsigned)blockedMs, (unsigned)(notifies * OLD_DELAY_MS), (unsigned)notifies, (unsigned)OLD_DELAY_MS);
+
+  // 2) An ACK queued behind that reply: how many notifications go out before it?
+  uint32_t seq = 0, ackAt = 0;
+  text->shimOnNotify = [&](const uint8_t* d, size_t n) {
+    seq++;
+    if (n >= 4 && memcmp(d, "ACK ", 4) == 0) ackAt = seq;
+  };
+  const uint32_t inflight = text->shimNotifies;  // already handed over before the ACK
+  ble.notifyText("ACK id=42", TxPrio::Control);
+  while (text->shimComplete(1)) {}
+  text->shimOnNotify = nullptr;
+  text->shimDeferStatus = false;
+  const BleTxQueue::Stats st = ble.txStats();
+  printf("%-34s ack after %u of %u notifies (in flight when queued=%u, FIFO would be %u)\n",
+         "ble.tx.ackBehindBulk", (unsigned)(ackAt - 1), (unsigned)seq, (unsigned)inflight, (unsigned)(seq - 1));
+  printf("%-34s queued=%u notifies=%u bytes=%u drops=%u backpressure=%u hw[ctl/norm/bulk]=%u/%u/%u\n",
+         "ble.tx.stats", (unsigned)st.queued, (unsigned)st.notifies, (unsigned)st.bytes,
+         (unsigned)st.drops, (unsigned)st.backpressure,
+         (unsigned)st.highWater[0], (unsigned)st.highWater[1], (unsigned)st.highWater[2]);
+
+  // 3) Steady-state cost of queue + drain per line (completions fire at once).
+  const String line = "DATA the quick brown fox jumps over the lazy dog";
+  const bench::Sample s = bench::run(200000, [&](uint64_t) { ble.notifyText(line, TxPrio::Bulk); });
+  bench::report("ble.tx.notifyText", s, "line");
+}
+
+// Line packing: one ProtoV1 burst (prompt + ACKs + pings) at several negotiated MTUs.
+BENCH(ble_coalesce) {
+  static BleJournal ble;
+  static BleLink link(ble);
+  static ProtoV1 proto(link);
+  proto.begin("bench-pack", ProtoHandlers{});
+  NimBLECharacteristic* text = textChar();
+  NimBLEServer* server = NimBLEDevice::getServer();
+  const uint16_t conn = server->shimConnect(23);
+
+  // Size of every notification, to check none exceeds the link's payload.
+  static size_t maxSeen = 0;
+  text->shimOnNotify = [](const uint8_t*, size_t n) { if (n > maxSeen) maxSeen = n; };
+
+  String prompt;
+  while (prompt.length() < 600) prompt += "tell me about the lake and the two pages. ";
+
+  const uint16_t mtus[] = { 23, 185, 247, 517 };
+  for (uint16_t mtu : mtus) {
+    server->shimSetMTU(conn, mtu);
+    delay(BLE_TX_FLUSH_MS); ble.loop();               // nothing left over from the last round
+    const size_t payload = ble.payloadSize();
+    const BleTxQueue::Stats a = ble.txStats();
+    maxSeen = 0;
+
+    proto.sendPrompt(prompt);
+    for (uint32_t id = 1; id <= 8; ++id) proto.sendAck(id);
+    for (uint32_t t = 0; t < 4; ++t) proto.sendTok(" tok");
+    delay(BLE_TX_FLUSH_MS); ble.loop();
+
+    const BleTxQueue::Stats b = ble.txStats();
+    const uint32_t msgs = b.queued - a.queued;
+    const uint32_t notifies = b.notifies - a.notifies;
+    const uint32_t bytes = b.bytes - a.bytes;
+    // Radio cost per notification: 3 B ATT + 4 B L2CAP header.
+    const double eff = 100.0 * bytes / (bytes + 7.0 * notifies);
+    char name[48];
+    snprintf(name, sizeof(name), "ble.pack.mtu%u", (unsigned)mtu);
+    printf("%-34s payload=%3u msgs=%3u notifies=%3u (unpacked>=%u) largest=%3u eff=%5.1f%%\n",
+           name, (unsigned)payload, (unsigned)msgs, (unsigned)notifies, (unsigned)msgs,
+           (unsigned)maxSeen, eff);
+  }
+
+  // A lone ACK: how long it waits for company before the flush deadline sends it.
+  uint32_t sentAt = 0;
+  text->shimOnNotify = [&](const uint8_t*, size_t) { sentAt = millis(); };
+  const uint32_t t0 = millis();
+  proto.sendAck(99);
+  while (!sentAt) { delay(1); ble.loop(); }
+  text->shimOnNotify = nullptr;
+  printf("%-34s %ums (BLE_TX_FLUSH_MS=%u)\n", "ble.pack.loneAckDelay", (unsigned)(sentAt - t0), (unsigned)BLE_TX_FLUSH_MS);
+  server->shimDisconnect(conn);
+}
@@ -0,0 +1,518 @@
+// JournalStore append/read throughput against the RAM-backed LittleFS shim.
+
+#include "Bench.hpp"
+#include "JournalStore.hpp"
+#include "JournalWriter.hpp"
+#include <functional>
+#include <vector>
+
+namespace {
+  String makeLine(size_t n, uint64_t seed) {
+    String s;
+    s.reserve(n);
+    for (size_t i = 0; i < n; ++i) s += (char)('a' + (seed + i * 7) % 26);
+    return s;
+  }
+}
+
+BENCH(journal_appendLine) {
+  JournalStore store;
+  store.begin();
+  const size_t lens[] = { 32, 128 };
+  for (size_t n : lens) {
+    store.clear();
+    const String line = makeLine(n, n);
+    LittleFS.shimResetStats();
+    const uint64_t iters = 20000;
+    const bench::Sample s = bench::run(iters, [&](uint64_t) { store.appendLine(line); });
+    const shimfs::Stats& fs = LittleFS.shimStats();
+    char name[48];
+    snprintf(name, sizeof(name), "journal.appendLine.%zuB", n);
+    bench::reportBytes(name, s, n + 2, "opens/line=%.2f writes/line=%.2f",
+                       (double)fs.opens / iters, (double)fs.writeCalls / iters);
+  }
+  store.clear();
+}
+
+// SAVE:-sized lines arriving every LINE_MS: per-line open/append/close vs
+// the group-commit writer (size threshold + idle deadline).
+BENCH(journal_groupCommit) {
+  constexpr uint32_t LINE_MS = 20;
+  JournalStore store;
+  store.begin();
+  const size_t lens[] = { 32, 128 };
+  for (size_t n : lens) {
+    const String line = makeLine(n, n);
+    const uint64_t iters = 20000;
+
+    store.clear();
+    LittleFS.shimResetStats();
+    const bench::Sample direct = bench::run(iters, [&](uint64_t) { store.appendLine(line); delay(LINE_MS); });
+    const shimfs::Stats d = LittleFS.shimStats();
+    const String want = store.readAll();
+
+    store.clear();
+    LittleFS.shimResetStats();
+    JournalWriter writer(store);
+    const bench::Sample batched = bench::run(iters, [&](uint64_t) {
+      writer.append(line);
+      delay(LINE_MS);
+      writer.loop(millis());
+    });
+    writer.flush();
+    const shimfs::Stats b = LittleFS.shimStats();
+    const JournalWriter::Stats& w = writer.stats();
+    const bool same = store.readAll() == want;
+
+    char name[48];
+    snprintf(name, sizeof(name), "journal.perLine.%zuB", n);
+    bench::reportBytes(name, direct, n + 2, "opens/line=%.2f writes/line=%.2f",
+                       (double)d.opens / iters, (double)d.writeCalls / iters);
+    snprintf(name, sizeof(name), "journal.groupCommit.%zuB", n);
+    bench::reportBytes(name, batched, n + 2, "opens/line=%.3f commits=%u B/commit=%.0f commit=%.1fus avg %uus max file=%s",
+                       (double)b.opens / iters, (unsigned)w.commits, (double)w.bytes / w.commits,
+                       (double)w.totalUs / w.commits, (unsigned)w.maxUs, bench::check(same));
+  }
+
+  // Idle deadline: a lone line reaches flash JOURNAL_IDLE_MS after it was queued.
+  store.clear();
+  JournalWriter writer(store);
+  writer.append(String("lonely"));
+  const uint32_t t0 = millis();
+  while (writer.pending()) { delay(10); writer.loop(millis()); }
+  printf("%-34s %ums (JOURNAL_IDLE_MS=%u, batch=%uB)\n", "journal.groupCommit.idleFlush",
+         (unsigned)(millis() - t0), (unsigned)JOURNAL_IDLE_MS, (unsigned)JOURNAL_BATCH_BYTES);
+  store.clear();
+}
+
+BENCH(journal_readAll) {
+  JournalStore store;
+  store.begin();
+  const size_t sizes[] = { 4 * 1024, 64 * 1024 };
+  for (size_t total : sizes) {
+    store.clear();
+    const String line = makeLine(62, total);
+    for (size_t written = 0; written < total; written += line.length() + 2) store.appendLine(line);
+
+    LittleFS.shimResetStats();
+    const uint64_t iters = (256 * 1024) / total + 4;
+    size_t got = 0;
+    uint64_t live0 = shim::heapStats().live;
+    shim::heapResetPeak();
+    const bench::Sample s = bench::run(iters, [&](uint64_t) { got = store.readAll().length(); });
+    uint64_t peak = shim::heapStats().peak - live0;
+    shimfs::Stats fs = LittleFS.shimStats();
+    char name[48];
+    snprintf(name, sizeof(name), "journal.readAll.%zuKB", total / 1024);
+    bench::reportBytes(name, s, got, "read calls/op=%.0f peakHeap=%lluB",
+                       (double)fs.readCalls / iters, (unsigned long long)peak);
+
+    // Same bytes through the block reader into a fixed buffer.
+    LittleFS.shimResetStats();
+    live0 = shim::heapStats().live;
+    shim::heapResetPeak();
+    const bench::Sample r = bench::run(iters, [&](uint64_t) {
+      uint8_t buf[256];
+      JournalStore::Reader rd = store.openReader();
+      got = 0;
+      for (size_t n; (n = rd.read(buf, sizeof(buf))) > 0; ) got += n;
+      rd.close();
+    });
+    peak = shim::heapStats().peak - live0;
+    fs = LittleFS.shimStats();
+    snprintf(name, sizeof(name), "journal.reader.%zuKB", total / 1024);
+    bench::reportBytes(name, r, got, "read calls/op=%.0f peakHeap=%lluB (256B buffer)",
+                       (double)fs.readCalls / iters, (unsigned long long)peak);
+  }
+  store.clear();
+}
+
+// Segmented log: tail / seq / time-range reads touch one or two segments and
+// at most JOURNAL_INDEX_EVERY headers, whatever the journal size; clear and
+// retention delete files; a remount walks only past each segment's last index
+// entry. The "scan" rows are what the flat file needed: read it all.
+BENCH(journal_segments) {
+  JournalStore store;
+  store.begin();
+  const size_t counts[] = { 250, 2000 };
+  for (size_t count : counts) {
+    store.clear();
+    const uint32_t base = store.stats().nextSeq;
+    std::vector<String> lines;
+    for (size_t i = 0; i < count; ++i) {
+      lines.push_back(makeLine(40 + i % 41, i));
+      store.appendLine(lines.back().c_str(), lines.back().length(), 1000 + (uint32_t)i);
+    }
+    const JournalStore::Stats st = store.stats();
+    auto expect = [&](uint32_t a, uint32_t b) {   // text of records [a, b) by seq
+      String s;
+      for (uint32_t q = a; q < b; ++q) { s += lines[q - base]; s += "\r\n"; }
+      return s;
+    };
+    auto drain = [](JournalStore::Reader r) {
+      String s;
+      s.reserve(r.size());
+      uint8_t buf[256];
+      for (size_t n; (n = r.read(buf, sizeof(buf))) > 0; ) s.concat((const char*)buf, n);
+      r.close();
+      return s;
+    };
+    const uint32_t mid = st.firstSeq + st.records / 2;
+    const uint32_t tMid = 1000 + (mid - base);
+    bool ok = drain(store.openLast(10)) == expect(st.nextSeq - 10, st.nextSeq)
+           && drain(store.openFrom(mid)) == expect(mid, st.nextSeq)
+           && drain(store.openTime(tMid, tMid + 19)) == expect(mid, mid + 20)
+           && drain(store.openReader()) == expect(st.firstSeq, st.nextSeq);
+
+    struct Case { const char* name; std::function<JournalStore::Reader()> open; };
+    const Case cases[] = {
+      { "last10", [&] { return store.openLast(10); } },
+      { "from",   [&] { return store.openFrom(st.nextSeq - 20); } },
+      { "time",   [&] { return store.openTime(tMid, tMid + 19); } },
+      { "scan",   [&] { return store.openReader(); } },
+    };
+    for (const Case& c : cases) {
+      LittleFS.shimResetStats();
+      const uint64_t iters = 400;
+      size_t got = 0;
+      const bench::Sample s = bench::run(iters, [&](uint64_t) {
+        uint8_t buf[256];
+        JournalStore::Reader r = c.open();
+        got = 0;
+        for (size_t n; (n = r.read(buf, sizeof(buf))) > 0; ) got += n;
+        r.close();
+      });
+      const shimfs::Stats fs = LittleFS.shimStats();
+      char name[48];
+      snprintf(name, sizeof(name), "journal.seg.%s.%zu", c.name, count);
+      bench::report(name, s, "op", "opens/op=%.1f KB read/op=%.2f out=%zuB segs=%u dropped=%u %s",
+                    (double)fs.opens / iters, fs.bytesRead / 1024.0 / iters, got,
+                    (unsigned)st.segments, (unsigned)st.dropped, bench::check(ok));
+    }
+
+    // Remount, then again with a torn tail on the active segment.
+    JournalStore again;
+    uint32_t t0 = micros();
+    again.begin();
+    const uint32_t mountUs = micros() - t0;
+    const uint32_t scanned = again.stats().mountScanned;
+    // The active segment is the one with the highest base (names are fixed-width hex).
+    File dir = LittleFS.open("/j");
+    String last;
+    for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+      String n = f.name();
+      if (n.endsWith(".seg") && (last.length() == 0 || strcmp(n.c_str(), last.c_str()) > 0)) last = n;
+    }
+    String seg = String("/j/") + last;
+    File torn = LittleFS.open(seg.c_str(), FILE_APPEND);
+    const uint8_t junk[] = { 0x30, 0x00, 0xde, 0xad, 0xbe, 0xef, 0x01, 0x02, 0x03 };
+    torn.write(junk, sizeof(junk));
+    torn.close();
+    JournalStore recovered;
+    recovered.begin();
+    const JournalStore::Stats rs = recovered.stats();
+    recovered.appendLine(String("after"));
+    ok = rs.records == st.records && rs.nextSeq == st.nextSeq
+      && drain(recovered.openLast(2)) == lines.back() + "\r\nafter\r\n";
+    char name[48];
+    snprintf(name, sizeof(name), "journal.seg.mount.%zu", count);
+    printf("%-34s %uus scanned=%u of %u records; torn: %uB skipped, scanned=%u recovery=%s\n",
+           name, (unsigned)mountUs, (unsigned)scanned, (unsigned)st.records,
+           (unsigned)rs.tornBytes, (unsigned)rs.mountScanned, bench::check(ok));
+    store.begin();
+  }
+
+  // Clear: one remove per file, independent of the bytes stored.
+  LittleFS.shimResetStats();
+  const uint32_t segs = store.stats().segments;
+  uint32_t t0 = micros();
+  store.clear();
+  printf("%-34s %uus removes=%u (segments=%u) bytesRead=%llu\n", "journal.seg.clear",
+         (unsigned)(micros() - t0), (unsigned)LittleFS.shimStats().removes, (unsigned)segs,
+         (unsigned long long)LittleFS.shimStats().bytesRead);
+
+  // A pre-segment /journal.txt is moved into the log at mount. One that fits
+  // is removed; one larger than retention keeps leaves its newest lines in
+  // the log and the whole file as /journal.txt.bak.
+  for (size_t count : { (size_t)200, (size_t)(JOURNAL_MAX_SEGS * JOURNAL_SEG_BYTES / 40) }) {
+    store.clear();
+    LittleFS.remove("/journal.txt.bak");
+    std::vector<String> lines;
+    File legacy = LittleFS.open("/journal.txt", FILE_WRITE);
+    for (size_t i = 0; i < count; ++i) {
+      lines.push_back(makeLine(40 + i % 41, i));
+      legacy.println(lines.back());
+    }
+    legacy.close();
+    JournalStore moved;
+    moved.begin();
+    const JournalStore::Stats st = moved.stats();
+    String want, got;
+    for (size_t i = count - std::min<size_t>(st.records, count); i < count; ++i) { want += lines[i]; want += "\r\n"; }
+    JournalStore::Reader r = moved.openReader();
+    uint8_t buf[256];
+    for (size_t n; (n = r.read(buf, sizeof(buf))) > 0; ) got.concat((const char*)buf, n);
+    r.close();
+    const bool fits = st.records == count;
+    const bool ok = got == want && !LittleFS.exists("/journal.txt")
+                 && (fits ? !st.legacyLost && !LittleFS.exists("/journal.txt.bak")
+                          : st.legacyLost == count - st.records && LittleFS.exists("/journal.txt.bak"));
+    char name[48];
+    snprintf(name, sizeof(name), "journal.seg.legacy.%zu", count);
+    printf("%-34s kept=%u lost=%u bak=%s %s\n", name, (unsigned)st.records, (unsigned)st.legacyLost,
+           LittleFS.exists("/journal.txt.bak") ? "yes" : "no", bench::check(ok));
+  }
+  LittleFS.remove("/journal.txt.bak");
+  store.begin();
+  store.clear();
+
+  // Flash fills in the middle of a record: the append fails and the torn
+  // bytes never count as a record. The next append (room again) goes to a
+  // fresh segment, or into the emptied one if the torn record was its first,
+  // and a remount finds the same records.
+  for (size_t before : { (size_t)0, (size_t)50 }) {
+    store.clear();
+    String last;
+    for (size_t i = 0; i < before; ++i) { last = makeLine(40 + i % 41, i); store.appendLine(last); }
+    const JournalStore::Stats st = store.stats();
+    LittleFS.shimSpaceLeft(JournalStore::REC_HDR + 10);
+    const bool failed = !store.appendLine(makeLine(60, 99));
+    LittleFS.shimSpaceLeft(SIZE_MAX);
+    const JournalStore::Stats torn = store.stats();
+    store.appendLine(String("after"));
+    JournalStore again;
+    again.begin();
+    const JournalStore::Stats rs = again.stats();
+    String got;
+    JournalStore::Reader r = again.openLast(2);
+    uint8_t buf[256];
+    for (size_t n; (n = r.read(buf, sizeof(buf))) > 0; ) got.concat((const char*)buf, n);
+    r.close();
+    const bool ok = failed && torn.records == st.records && torn.nextSeq == st.nextSeq
+                 && rs.records == st.records + 1 && rs.tornBytes == (before ? JournalStore::REC_HDR + 10 : 0)
+                 && got == (before ? last + "\r\n" : String()) + "after\r\n";
+    char name[48];
+    snprintf(name, sizeof(name), "journal.seg.shortWrite.%zu", before);
+    printf("%-34s failed=%s segs=%u->%u remount torn=%uB records=%u %s\n", name, failed ? "yes" : "no",
+           (unsigned)st.segments, (unsigned)rs.segments, (unsigned)rs.tornBytes, (unsigned)rs.records, bench::check(ok));
+  }
+  store.begin();
+  store.clear();
+}
+
+// LZ codec on journal-like prose, then compaction of sealed segments: disk
+// bytes before/after, cost per compactStep(), and reads through the block cache.
+BENCH(journal_lz) {
+  const String text = bench::prose(64 * 1024, 7);
+  const uint8_t* in = (const uint8_t*)text.c_str();
+  static Lz::Encoder enc;
+  static uint8_t comp[64 * 1024 + 64 * 1024 / 8];
+  static uint8_t back[64 * 1024];
+  size_t blocks[64], sizes[64];
+  size_t nb = 0, total = 0;
+  const bench::Sample c = bench::run(20, [&](uint64_t) {
+    nb = 0;
+    total = 0;
+    for (size_t at = 0; at < text.length(); at += JOURNAL_LZ_BLOCK) {
+      const size_t n = std::min((size_t)JOURNAL_LZ_BLOCK, text.length() - at);
+      size_t k = enc.encode(in + at, n, comp + total, n);
+      if (!k) { memcpy(comp + total, in + at, n); k = n; }
+      blocks[nb] = total;
+      sizes[nb++] = k;
+      total += k;
+    }
+  });
+  bool ok = true;
+  const bench::Sample d = bench::run(50, [&](uint64_t) {
+    size_t out = 0;
+    for (size_t b = 0; b < nb; ++b) {
+      const size_t n = std::min((size_t)JOURNAL_LZ_BLOCK, text.length() - out);
+      if (sizes[b] == n) memcpy(back + out, comp + blocks[b], n);
+      else ok &= Lz::decode(comp + blocks[b], sizes[b], back + out, n) == n;
+      out += n;
+    }
+  });
+  ok &= memcmp(back, in, text.length()) == 0;
+  bench::reportBytes("journal.lz.compress", c, text.length(), "ratio=%.3f (%zuB -> %zuB, %zuB blocks)",
+                     (double)total / text.length(), (size_t)text.length(), total, (size_t)JOURNAL_LZ_BLOCK);
+  bench::reportBytes("journal.lz.decompress", d, text.length(), "roundTrip=%s", bench::check(ok));
+
+  // Fill every segment, then compact the sealed ones a block at a time.
+  JournalStore store;
+  store.begin();
+  store.clear();
+  const uint32_t seq0 = store.stats().nextSeq;   // record seq0 + i has ts 1000 + i
+  for (uint32_t i = 0; store.stats().segments < JOURNAL_MAX_SEGS || store.stats().dropped == 0; ++i) {
+    const String line = bench::prose(40 + i % 120, i);
+    store.appendLine(line.c_str(), line.length(), 1000 + i);
+  }
+  const String want = store.readAll();
+  const JournalStore::Stats before = store.stats();
+  JournalStore plain;
+  plain.begin();
+  const uint32_t plainScanned = plain.stats().mountScanned;
+  uint32_t steps = 0, maxUs = 0, t0 = micros();
+  for (;;) {
+    const uint32_t s0 = micros();
+    if (!store.compactStep()) break;
+    maxUs = std::max(maxUs, (uint32_t)(micros() - s0));
+    steps++;
+  }
+  const uint32_t allUs = micros() - t0;
+  const JournalStore::Stats after = store.stats();
+  ok = store.readAll() == want;
+  printf("%-34s %u segs: %uB -> %uB on flash (%.3f) steps=%u %.0fus avg %uus max read=%s\n",
+         "journal.lz.compact", (unsigned)after.compressed, (unsigned)before.diskBytes,
+         (unsigned)after.diskBytes, (double)after.diskBytes / before.diskBytes, (unsigned)steps,
+         steps ? (double)allUs / steps : 0.0, (unsigned)maxUs, bench::check(ok));
+
+  // Remount: compressed segments are described by their trailer, not scanned.
+  JournalStore again;
+  again.begin();
+  printf("%-34s scanned=%u of %u records (was %u before compaction)\n", "journal.lz.mount",
+         (unsigned)again.stats().mountScanned, (unsigned)after.records, (unsigned)plainScanned);
+
+  // Reads now decode blocks; the last 10 records sit in the plain active segment,
+  // a time range in the middle sits in compressed ones.
+  const uint32_t tMid = 1000 + (after.firstSeq + after.records / 2 - seq0);
+  struct Case { const char* name; std::function<JournalStore::Reader()> open; };
+  const Case cases[] = {
+    { "last10", [&] { return store.openLast(10); } },
+    { "time",   [&] { return store.openTime(tMid, tMid + 19); } },
+    { "scan",   [&] { return store.openReader(); } },
+  };
+  for (const Case& cs : cases) {
+    LittleFS.shimResetStats();
+    const uint64_t iters = 200;
+    size_t got = 0;
+    const bench::Sample s = bench::run(iters, [&](uint64_t) {
+      uint8_t buf[256];
+      JournalStore::Reader r = cs.open();
+      got = 0;
+      for (size_t n; (n = r.read(buf, sizeof(buf))) > 0; ) got += n;
+      r.close();
+    });
+    const shimfs::Stats fs = LittleFS.shimStats();
+    char name[48];
+    snprintf(name, sizeof(name), "journal.lz.%s", cs.name);
+    bench::report(name, s, "op", "opens/op=%.1f KB read/op=%.2f out=%zuB",
+                  (double)fs.opens / iters, fs.bytesRead / 1024.0 / iters, got);
+  }
+  store.clear();
+}
+
+// Search: per-group bloom filters against a full scan. Prose lines share a
+// 50-word vocabulary, so common terms are in nearly every group; "kiwi" is
+// in every 97th record and "ticket777" in one.
+BENCH(journal_find) {
+  JournalStore store;
+  store.begin();
+  store.clear();
+  std::vector<String> lines;
+  for (uint32_t i = 0; i < 2000; ++i) lines.push_back(bench::prose(40 + i % 120, i));
+  const bench::Sample app = bench::run(2000, [&](uint64_t i) {
+    store.appendLine(lines[i].c_str(), lines[i].length(), 1000);
+  });
+  store.clear();
+  lines.clear();
+
+  const uint32_t seq0 = store.stats().nextSeq;
+  for (uint32_t i = 0; store.stats().segments < JOURNAL_MAX_SEGS || store.stats().dropped == 0; ++i) {
+    String line = bench::prose(40 + i % 120, i);
+    if (i % 97 == 50) line += " kiwi";
+    if (i == 777) line += " ticket777";
+    lines.push_back(line);
+    store.appendLine(line.c_str(), line.length(), 1000 + i);
+  }
+
+  // Update cost: the word hashing each append now does, against the append itself.
+  uint8_t filter[JOURNAL_BLOOM_BYTES];
+  size_t li = 0;
+  const bench::Sample idx = bench::run(20000, [&](uint64_t) {
+    const String& l = lines[li++ % lines.size()];
+    JournalStore::indexWords(filter, l.c_str(), l.length());
+  });
+  bench::report("journal.find.indexWords", idx, "rec", "%.1f%% of an appendLine (%.2fus)",
+                100 * idx.usPerOp() / app.usPerOp(), app.usPerOp());
+
+  // Reference: every kept record, word by word.
+  auto words = [](const String& s, std::vector<String>& out) {
+    out.clear();
+    String w;
+    for (size_t i = 0; i <= s.length(); ++i) {
+      const char c = i < s.length() ? s[i] : ' ';
+      if (isalnum((unsigned char)c) || (uint8_t)c >= 0x80) w += (char)tolower(c);
+      else if (w.length()) { out.push_back(w); w = ""; }
+    }
+  };
+  auto reference = [&](const char* q, std::vector<uint32_t>& hits) {
+    std::vector<String> want, have;
+    words(q, want);
+    hits.clear();
+    for (uint32_t seq = store.stats().nextSeq; seq-- > store.stats().firstSeq; ) {
+      words(lines[seq - seq0], have);
+      bool all = true;
+      for (const String& w : want) all &= std::find(have.begin(), have.end(), w) != have.end();
+      if (all && hits.size() < 16) hits.push_back(seq);
+    }
+  };
+
+  const JournalStore::Stats st = store.stats();
+  printf("%-34s %uB for %u records (%.1f%% of %uB text, %uB/group)\n", "journal.find.index",
+         (unsigned)st.indexBytes, (unsigned)st.records, 100.0 * st.indexBytes / st.rawBytes,
+         (unsigned)st.rawBytes, (unsigned)JOURNAL_BLOOM_BYTES);
+
+  // Baseline: what a search without the index reads.
+  LittleFS.shimResetStats();
+  const bench::Sample scan = bench::run(20, [&](uint64_t) {
+    uint8_t buf[256];
+    JournalStore::Reader r = store.openReader();
+    while (r.read(buf, sizeof(buf))) {}
+    r.close();
+  });
+  bench::report("journal.find.fullScan", scan, "op", "KB read/op=%.1f",
+                LittleFS.shimStats().bytesRead / 1024.0 / 20);
+
+  const char* queries[][2] = {
+    { "common",  "battery coffee" },
+    { "rare",    "kiwi" },
+    { "unique",  "ticket777" },
+    { "absent",  "xylophone" },
+  };
+  for (int pass = 0; pass < 2; ++pass) {
+    if (pass == 1) while (store.compactStep()) {}
+    for (const auto& q : queries) {
+      uint32_t hits[16];
+      size_t k = 0;
+      JournalStore::FindStats fs{};
+      LittleFS.shimResetStats();
+      const uint64_t iters = 200;
+      const bench::Sample s = bench::run(iters, [&](uint64_t) { k = store.find(q[1], hits, 16, &fs); });
+      const double kb = LittleFS.shimStats().bytesRead / 1024.0 / iters;
+      std::vector<uint32_t> want;
+      reference(q[1], want);
+      const bool ok = want == std::vector<uint32_t>(hits, hits + k);
+      char name[48];
+      snprintf(name, sizeof(name), "journal.find.%s%s", q[0], pass ? ".lz" : "");
+      bench::report(name, s, "query", "hits=%u groups=%u cand=%u recs=%u KB read=%.1f match=%s",
+                    (unsigned)k, (unsigned)fs.groups, (unsigned)fs.candidates, (unsigned)fs.records,
+                    kb, bench::check(ok));
+    }
+  }
+
+  // The hits as a body: "<seq> <ts> <text>" lines.
+  uint32_t hits[16];
+  const size_t k = store.find("kiwi", hits, 16);
+  JournalStore::Reader r = store.openSeqs(hits, k);
+  String body;
+  uint8_t buf[128];
+  for (size_t n; (n = r.read(buf, sizeof(buf))) > 0; ) body.concat((const char*)buf, n);
+  r.close();
+  String want;
+  for (size_t i = 0; i < k; ++i) {
+    want += String(hits[i]) + " " + String(1000 + hits[i] - seq0) + " " + lines[hits[i] - seq0] + "\r\n";
+  }
+  printf("%-34s %u records %uB size=%u body=%s\n", "journal.find.openSeqs", (unsigned)k,
+         (unsigned)body.length(), (unsigned)r.size(), bench::check(body == want));
+  store.clear();
+}
@@ -0,0 +1,61 @@
+// Native benchmark runner: `pio run -e native`, then `.pio/build/native/program [filter]`.
+
+#include "Bench.hpp"
+#include <cstdarg>
+#include <vector>
+
+namespace {
+  struct Entry { const char* name; bench::Fn fn; };
+  std::vector<Entry>& registry() { static std::vector<Entry> r; return r; }
+  uint32_t failed = 0;
+
+  void printExtra(const char* fmt, va_list ap) {
+    if (!fmt) { printf("\n"); return; }
+    printf("  ");
+    vprintf(fmt, ap);
+    printf("\n");
+  }
+}
+
+int bench::add(const char* name, Fn fn) {
+  registry().push_back({ name, fn });
+  return (int)registry().size();
+}
+
+const char* bench::check(bool ok) {
+  if (!ok) failed++;
+  return ok ? "ok" : "DIFF";
+}
+
+void bench::report(const char* name, const Sample& s, const char* unit, const char* extraFmt, ...) {
+  printf("%-34s %12.0f %s/s %10.3f us/%s %8.2f allocs/%s",
+         name, s.opsPerSec(), unit, s.usPerOp(), unit, s.allocsPerOp(), unit);
+  va_list ap;
+  va_start(ap, extraFmt);
+  printExtra(extraFmt, ap);
+  va_end(ap);
+}
+
+void bench::reportBytes(const char* name, const Sample& s, uint64_t bytesPerOp, const char* extraFmt, ...) {
+  const double mbps = s.ns > 0 ? (double)bytesPerOp * s.iters * 1e3 / s.ns : 0;   // bytes/ns*1e3 = MB/s
+  printf("%-34s %12.2f MB/s  %10.3f us/op %8.2f allocs/op",
+         name, mbps, s.usPerOp(), s.allocsPerOp());
+  va_list ap;
+  va_start(ap, extraFmt);
+  printExtra(extraFmt, ap);
+  va_end(ap);
+}
+
+int main(int argc, char** argv) {
+  const char* filter = (argc > 1) ? argv[1] : nullptr;
+  Serial.setSink(nullptr);   // firmware logging would drown the results
+
+  printf("# LLMWatch native benchmarks%s%s\n", filter ? " filter=" : "", filter ? filter : "");
+  for (const Entry& e : registry()) {
+    if (filter && !strstr(e.name, filter)) continue;
+    printf("## %s\n", e.name);
+    e.fn();
+  }
+  if (failed) printf("# %u check(s) failed\n", (unsigned)failed);
+  return failed ? 1 : 0;
+}
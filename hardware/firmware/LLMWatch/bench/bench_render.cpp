@@ -0,0 +1,402 @@
+// main.cpp render paths and loop(). The sketch is compiled into this translation unit
+// (it is excluded from the native src filter) so its static screens and
+// streaming state are reachable without changing the firmware.
+
+#include "Bench.hpp"
+#include "../src/main.cpp"
+
+namespace {
+  const char kLorem[] =
+    "the model answers in short tokens and the watch wraps them onto a tiny "
+    "screen one word at a time while the user waits for the rest of it ";
+
+  String makeText(size_t n) {
+    String s;
+    s.reserve(n);
+    while (s.length() < n) s += kLorem[s.length() % (sizeof(kLorem) - 1)];
+    return s;
+  }
+}
+
+BENCH(render_drawStreaming) {
+  oled.begin();
+  const size_t lens[] = { 64, 256, 1024, 4096 };
+  for (size_t n : lens) {
+    // Full repaint of the streaming screen with n chars received so far.
+    g_streamView.reset();
+    g_streamView.append(makeText(n));
+    oled.shimDisplay().shimResetStats();
+    const uint64_t iters = 200000 / n + 50;
+    const bench::Sample s = bench::run(iters, [](uint64_t) { g_streamView.invalidate(); drawStreaming(); });
+    const double busPerFrame = (double)oled.shimDisplay().shimStats().busBytes / iters;
+    char name[48];
+    snprintf(name, sizeof(name), "render.drawStreaming.len%zu", n);
+    bench::report(name, s, "frame", "bus=%.0fB/frame i2c~%.0fus/frame",
+                  busPerFrame, bench::i2cMicros((uint64_t)busPerFrame));
+  }
+  g_streamView.reset();
+}
+
+BENCH(render_streamResponse) {
+  // A whole answer arriving as 4-char TOK: lines every TOK_MS, with loop()
+  // drawing through the frame scheduler; cost per token should not grow with length.
+  // Run with the header + 3 rows layout and with the hardware-scrolled one.
+  constexpr uint32_t TOK_MS = 8;
+  oled.begin();
+  const size_t lens[] = { 256, 1024, 4096 };
+  for (bool hw : { false, true })
+  for (size_t n : lens) {
+    g_streamView.setHwScroll(hw);
+    const String text = makeText(n);
+    std::vector<String> toks;
+    for (size_t i = 0; i < n; i += 4) toks.push_back(String("TOK:") + text.substring(i, i + 4));
+
+    g_streamActive = false;
+    oled.shimDisplay().shimResetStats();
+    const uint32_t rows0 = g_streamView.rowsDrawn();
+    const RenderScheduler::Stats r0 = g_render.stats();
+    const bench::Sample s = bench::run(toks.size(), [&](uint64_t i) {
+      onBleCommand(toks[i]);
+      delay(TOK_MS);
+      renderFrame(millis());
+    });
+    delay(RENDER_STREAM_MS);
+    renderFrame(millis());                                  // the last tokens' frame
+    const RenderScheduler::Stats r1 = g_render.stats();
+    const double busPerTok = (double)oled.shimDisplay().shimStats().busBytes / toks.size();
+    char name[48];
+    snprintf(name, sizeof(name), "render.streamResponse%s.len%zu", hw ? ".hw" : "", n);
+    U8G2& d = oled.shimDisplay();
+    const bool synced = memcmp(d.shimPanel(), d.getBufferPtr(), U8G2::BUF_BYTES) == 0;   // partial sends lost nothing
+    bench::report(name, s, "tok", "bus=%.0fB/tok (%.0fB/line) rows=%.2f/tok frames=%.2f/tok coalesced=%u panel=%s",
+                  busPerTok, (double)d.shimStats().busBytes / g_streamView.lines(),
+                  (double)(g_streamView.rowsDrawn() - rows0) / toks.size(),
+                  (double)(r1.frames - r0.frames) / toks.size(), (unsigned)(r1.coalesced - r0.coalesced),
+                  synced ? "ok" : "STALE");
+  }
+  g_streamView.setHwScroll(STREAM_HW_SCROLL);
+  g_streamActive = false;
+  g_streamBuf = "";
+  screen = Screen::Home;
+}
+
+BENCH(render_typing) {
+  oled.begin();
+  typist.clear();
+  for (int i = 0; i < 60; ++i) typist.accept();
+  const bench::Sample s = bench::run(5000, [](uint64_t) { drawTyping(oled, typist); });
+  bench::report("render.drawTyping.60ch", s, "frame");
+
+  // Wheel steps: only the "Pick: [x]" tile changes between frames.
+  oled.shimDisplay().shimResetStats();
+  const OledView::Stats a = oled.stats();
+  const bench::Sample w = bench::run(5000, [](uint64_t) { typist.next(); drawTyping(oled, typist); });
+  const OledView::Stats b = oled.stats();
+  const double bus = (double)oled.shimDisplay().shimStats().busBytes / w.iters;
+  bench::report("render.drawTyping.wheelStep", w, "frame", "bus=%.0fB/frame i2c~%.0fus/frame (full=1056B) pages=%.2f/frame",
+                bus, bench::i2cMicros((uint64_t)bus), (double)(b.pages - a.pages) / w.iters);
+}
+
+BENCH(ble_callbackTime) {
+  // Time the NimBLE host task spends inside onWrite per streamed token. It used
+  // to run onBleCommand (redraw + I2C) right there; now it only enqueues.
+  oled.begin();
+  ble.begin(DEVICE_NAME, onBleCommand);
+  NimBLECharacteristic* cmd =
+    NimBLEDevice::getServer()->getServiceByUUID(UUID_SVC)->getCharacteristic(UUID_CMD);
+  const String text = makeText(1024);
+  std::vector<std::string> toks;
+  for (size_t i = 0; i < text.length(); i += 4) toks.push_back(std::string("TOK:") + text.substring(i, i + 4).c_str());
+
+  g_streamActive = false;
+  oled.shimDisplay().shimResetStats();
+  const bench::Sample inl = bench::run(toks.size(), [&](uint64_t i) {
+    onBleCommand(String(toks[i].c_str()));
+    drawStreaming();                                      // the old handler drew every token
+  });
+  const double busInline = (double)oled.shimDisplay().shimStats().busBytes / toks.size();
+
+  g_streamActive = false;
+  const bench::Sample cb = bench::run(toks.size(), [&](uint64_t i) { cmd->shimWrite(toks[i]); });
+  const bench::Sample drain = bench::run(1, [](uint64_t) { ble.loop(); });
+  bench::report("ble.callback.inlineHandler", inl, "write", "+i2c~%.0fus/write (old: all inside the BLE task)",
+                bench::i2cMicros((uint64_t)busInline));
+  bench::report("ble.callback.enqueueOnly", cb, "write", "loop() drain of %zu=%.0fus", toks.size(), drain.ns / 1000.0);
+
+  // Burst with loop() stalled: writes past the queue are dropped and counted,
+  // the producer waits at most BLE_RX_FULL_WAIT_US for each.
+  const BleJournal::RxStats st0 = ble.rxStats();
+  const uint32_t v0 = micros();
+  for (int i = 0; i < 40; ++i) cmd->shimWrite(std::string(200, 'x'));
+  const uint32_t stalled = micros() - v0;
+  const BleJournal::RxStats st = ble.rxStats();
+  const uint32_t drops = st.drops - st0.drops;
+  printf("%-34s queued=%u drops=%u waits=%u highWater=%uB depth=%uB stalled=%uus %s\n", "ble.rx.backpressure",
+         (unsigned)(st.queued - st0.queued), (unsigned)drops, (unsigned)(st.waits - st0.waits), (unsigned)st.highWater,
+         (unsigned)st.depth, (unsigned)stalled,
+         bench::check(drops && st.queued - st0.queued + drops == 40 && stalled < 1000 + 40 * BLE_RX_FULL_WAIT_US));
+  ble.loop();
+  g_streamActive = false;
+  g_streamBuf = "";
+  screen = Screen::Home;
+}
+
+BENCH(render_coalesce) {
+  // Bursts of tokens between loop() passes (one BLE connection event can
+  // deliver several writes): every token used to be a frame.
+  oled.begin();
+  ble.begin(DEVICE_NAME, onBleCommand);
+  NimBLECharacteristic* cmd =
+    NimBLEDevice::getServer()->getServiceByUUID(UUID_SVC)->getCharacteristic(UUID_CMD);
+  const String text = makeText(2048);
+  constexpr size_t BURST = 20;
+  constexpr uint32_t PASS_MS = 15;                          // virtual time per loop() pass
+
+  g_streamActive = false;
+  oled.shimDisplay().shimResetStats();
+  const RenderScheduler::Stats a = g_render.stats();
+  size_t toks = 0;
+  const bench::Sample s = bench::run(1, [&](uint64_t) {
+    for (size_t i = 0; i < text.length(); ) {
+      for (size_t k = 0; k < BURST && i < text.length(); ++k, i += 4, ++toks)
+        cmd->shimWrite(std::string("TOK:") + text.substring(i, i + 4).c_str());
+      delay(PASS_MS);
+      ble.loop();
+      renderFrame(millis());
+    }
+  });
+  const RenderScheduler::Stats b = g_render.stats();
+  const uint64_t bus = oled.shimDisplay().shimStats().busBytes;
+  bench::report("render.coalesce.burst20", s, "stream",
+                "toks=%zu requests=%u frames=%u coalesced=%u bus=%lluB i2c~%.0fms",
+                toks, (unsigned)(b.requests - a.requests), (unsigned)(b.frames - a.frames),
+                (unsigned)(b.coalesced - a.coalesced), (unsigned long long)bus, bench::i2cMicros(bus) / 1000.0);
+  g_streamActive = false;
+  g_streamBuf = "";
+  screen = Screen::Home;
+}
+
+BENCH(ble_readAll) {
+  // READALL of a 64 KB journal: staged from flash a block at a time, so the
+  // heap does not grow with the journal (it used to hold a String of it all).
+  // Then the same journal to a host that sent CAPS:LZ: block frames, sealed
+  // segments sent as compacted on flash, the active one compressed on the fly.
+  ble.begin(DEVICE_NAME, onBleCommand);
+  NimBLEServer* server = NimBLEDevice::getServer();
+  NimBLECharacteristic* text = server->getServiceByUUID(UUID_SVC)->getCharacteristic(UUID_TEXT);
+  const uint16_t conn = server->shimConnect(247);
+  store.begin();
+  store.clear();
+  for (uint32_t i = 0, n = 0; n < 64 * 1024; ++i) {
+    const String line = bench::prose(40 + i % 60, i);
+    store.appendLine(line);
+    n += line.length() + 2;
+  }
+  while (store.compactStep()) {}
+  const String want = store.readAll();
+
+  static std::string air;           // the collector is not part of the firmware
+  static size_t firstLen;           // the LZ header is a notification of its own
+  air.reserve(want.length() + 1024);
+  text->shimOnNotify = [](const uint8_t* d, size_t n) {
+    if (air.empty()) firstLen = n;
+    air.append((const char*)d, n);
+  };
+  for (bool lz : { false, true }) {
+    if (lz) {
+      onBleCommand("CAPS:LZ");
+      for (int i = 0; i < 4; ++i) { delay(BLE_TX_FLUSH_MS); ble.loop(); }
+    }
+    air.clear();
+    const uint32_t n0 = text->shimNotifies;
+    const uint32_t ms0 = millis();
+    const uint64_t live0 = shim::heapStats().live;
+    shim::heapResetPeak();
+    const bench::Sample s = bench::run(1, [](uint64_t) {
+      onBleCommand("READALL");
+      while (g_txReader) { delay(BLE_TX_FLUSH_MS); ble.loop(); pumpBody(); }
+      for (int i = 0; i < 4; ++i) { delay(BLE_TX_FLUSH_MS); ble.loop(); }
+    });
+    const uint64_t peak = shim::heapStats().peak - live0;
+    const uint32_t notifies = text->shimNotifies - n0;
+    const uint32_t simMs = millis() - ms0;
+
+    // Host side: text is the body as is; LZ is a header, then frames to decode.
+    std::string body;
+    bool ok;
+    if (!lz) {
+      ok = air == want.c_str();
+    } else {
+      unsigned long first = 0, count = 0;
+      const std::string hdr = air.substr(0, air.empty() ? 0 : firstLen);
+      ok = sscanf(hdr.c_str(), "LZ first=%lu count=%lu", &first, &count) == 2;
+      std::string recs;
+      size_t i = hdr.size();
+      static uint8_t blk[JOURNAL_LZ_BLOCK];
+      while (ok && i + JournalStore::WIRE_HDR <= air.size()) {
+        const uint8_t* h = (const uint8_t*)air.data() + i;
+        const size_t raw = h[0] | h[1] << 8, stored = h[2] | h[3] << 8, skip = h[4] | h[5] << 8;
+        i += JournalStore::WIRE_HDR;
+        if (!raw) break;
+        if (stored == raw) memcpy(blk, h + JournalStore::WIRE_HDR, raw);
+        else ok = Lz::decode(h + JournalStore::WIRE_HDR, stored, blk, raw) == raw;
+        recs.append((const char*)blk + skip, raw - skip);
+        i += stored;
+      }
+      for (size_t p = 0, k = 0; ok && k < count; ++k) {
+        const size_t len = (uint8_t)recs[p] | (uint8_t)recs[p + 1] << 8;
+        body.append(recs, p + JournalStore::REC_HDR, len);
+        body += "\r\n";
+        p += JournalStore::REC_HDR + len;
+      }
+      ok = ok && body == want.c_str();
+    }
+    bench::reportBytes(lz ? "ble.readAll.64KB.lz" : "ble.readAll.64KB", s, want.length(),
+                       "peakHeap=%lluB air=%zuB notifies=%u sim=%ums air@7.5ms=%.0fms body=%s",
+                       (unsigned long long)peak, air.size(), (unsigned)notifies, (unsigned)simMs,
+                       bench::bleAirMs(notifies), bench::check(ok));
+  }
+  text->shimOnNotify = nullptr;
+  store.clear();
+  server->shimDisconnect(conn);
+}
+
+BENCH(loop_tickless) {
+  // 40 s of the real loop(): idle, a button click, a token stream ended by
+  // TOK_END, a second one left to time out. Events are scripted in virtual
+  // time and injected while rt blocks, as the NimBLE task / GPIO ISR would.
+  // Tickless: block until the nearest deadline; poll: a pass every 1 ms (the
+  // old loop spun even faster). Latency is from the event to the frame showing it.
+  oled.begin();
+  store.begin();
+  store.clear();
+  ble.begin(DEVICE_NAME, onBleCommand);
+  NimBLEServer* server = NimBLEDevice::getServer();
+  NimBLECharacteristic* cmd = server->getServiceByUUID(UUID_SVC)->getCharacteristic(UUID_CMD);
+  const uint16_t conn = server->shimConnect(247);
+  one.begin();
+  startRuntime();
+
+  struct Ev { uint32_t at; int kind; };   // 0 press, 1 release, 2 token, 3 TOK_END
+  std::vector<Ev> script;
+  script.push_back({ 5000, 0 });
+  script.push_back({ 5080, 1 });
+  for (uint32_t t = 10000; t < 13000; t += 20) script.push_back({ t, 2 });   // faster than frames: coalesced
+  script.push_back({ 13000, 3 });
+  for (uint32_t t = 20000; t < 22000; t += 40) script.push_back({ t, 2 });   // no TOK_END: times out
+
+  for (bool tickless : { true, false }) {
+    screen = Screen::Home;
+    g_streamActive = false;
+    g_status.active = false;
+    requestRedraw();
+    const uint32_t t0 = millis();
+    size_t next = 0;
+    uint32_t unseenAt = UINT32_MAX, latSum = 0, latMax = 0, latN = 0, clickMs = 0, timeoutMs = 0;
+    uint32_t frames = g_render.stats().frames;
+    const uint32_t commits0 = journal.stats().commits;
+    // Fire scripted events up to virtual time `until` (relative to t0).
+    auto fire = [&](uint32_t until) {
+      while (next < script.size() && script[next].at <= until) {
+        const Ev& e = script[next++];
+        const uint32_t now = millis() - t0;
+        if (e.at > now) delay(e.at - now);
+        switch (e.kind) {
+          case 0: shim::setPin(BTN_A, LOW); break;
+          case 1: shim::setPin(BTN_A, HIGH); break;
+          case 2: cmd->shimWrite("TOK: word"); break;
+          case 3: cmd->shimWrite("TOK_END"); break;
+        }
+        if (e.kind >= 2 && unseenAt == UINT32_MAX) unseenAt = e.at;
+      }
+    };
+    // What the pass that just ended shows.
+    auto observe = [&] {
+      const uint32_t now = millis() - t0;
+      if (g_render.stats().frames != frames) {
+        frames = g_render.stats().frames;
+        if (unseenAt != UINT32_MAX) {
+          const uint32_t lat = now - unseenAt;
+          latSum += lat; latN++;
+          if (lat > latMax) latMax = lat;
+          unseenAt = UINT32_MAX;
+        }
+      }
+      if (!clickMs && screen == Screen::Journal && now > 5000) clickMs = now - 5080;
+      if (!timeoutMs && now > 22000 && !g_streamActive) timeoutMs = now - script.back().at;
+    };
+    // Called at the end of a pass: block ms, or until the next scripted event (which wakes rt).
+    rt.shimBlock = [&](uint32_t ms) {
+      observe();
+      if (!tickless) ms = 1;
+      const uint32_t now = millis() - t0;
+      if (next < script.size() && script[next].at <= now + ms) fire(script[next].at);
+      else delay(ms);
+    };
+    rt.resetStats();
+    const bench::Sample s = bench::run(1, [&](uint64_t) {
+      while (millis() - t0 < 40000) {
+        fire(millis() - t0);
+        loop();
+        observe();   // passes that did not block
+      }
+    });
+    rt.shimBlock = nullptr;
+    const double secs = (millis() - t0) / 1000.0;
+    const LoopRuntime::Stats& st = rt.stats();
+    printf("%-34s passes=%6u (%6.1f/s) slept=%4.1f%% pass p50=%4uus p99=%5uus max=%5uus late=%ums "
+           "tok->frame=%2u/%2ums click->screen=%ums timeout=%ums commits=%u wall=%.0fms\n",
+           tickless ? "loop.tickless" : "loop.poll1ms", (unsigned)st.passes, st.passes / secs,
+           st.sleptMs / 10.0 / secs, (unsigned)rt.percentileUs(50), (unsigned)rt.percentileUs(99),
+           (unsigned)st.workMaxUs, (unsigned)st.lateMaxMs, (unsigned)(latN ? latSum / latN : 0), (unsigned)latMax,
+           (unsigned)clickMs, (unsigned)timeoutMs, (unsigned)(journal.stats().commits - commits0), s.ns / 1e6);
+  }
+  g_streamActive = false;
+  g_streamBuf = "";
+  screen = Screen::Home;
+  store.clear();
+  server->shimDisconnect(conn);
+}
+
+BENCH(boot_timeline) {
+  // setup() after a power-on and after a software reset. It used to hold
+  // four bootStep() splashes (plus 550 ms of fixed delays) before loop():
+  // 3.85 s to advertising and 5.05 s to ready after a power-on, 1.1 s / 1.3 s
+  // after a reset. Now BLE comes first, the splash is an overlay, and a
+  // command sent while it shows is answered right away.
+  for (esp_reset_reason_t reason : { ESP_RST_POWERON, ESP_RST_SW }) {
+    shim::setResetReason(reason);
+    boot.reset();
+    g_status.active = false;
+    const uint32_t t0 = micros();
+    setup();
+    NimBLEServer* server = bench::freshServer();
+    NimBLECharacteristic* cmd = server->getServiceByUUID(UUID_SVC)->getCharacteristic(UUID_CMD);
+    NimBLECharacteristic* text = server->getServiceByUUID(UUID_SVC)->getCharacteristic(UUID_TEXT);
+    static uint32_t replyUs;
+    replyUs = 0;
+    text->shimOnNotify = [](const uint8_t* d, size_t n) { if (!replyUs && n >= 4 && !memcmp(d, "BOOT", 4)) replyUs = micros(); };
+    const uint16_t conn = server->shimConnect(247);
+    cmd->shimWrite("STATS:BOOT");
+    uint32_t splashUs = 0;
+    rt.shimBlock = [&](uint32_t ms) {   // end of a pass: is the splash still up?
+      if (!splashUs && !g_status.active) splashUs = micros() - t0;
+      delay(ms);
+    };
+    while (micros() - t0 < 3000000) loop();
+    rt.shimBlock = nullptr;
+    char line[160];
+    boot.format(line, sizeof(line), (int)reason);
+    auto us = [&](BootTimeline::Stage st) { return (unsigned)boot.us(st); };
+    printf("%-34s advertising=%uus ready=%uus frame=%uus splash=%ums STATS:BOOT reply=%uus\n",
+           reason == ESP_RST_POWERON ? "boot.poweron" : "boot.swreset", us(BootTimeline::Ble),
+           us(BootTimeline::Ready), us(BootTimeline::Frame), (unsigned)(splashUs / 1000),
+           replyUs ? (unsigned)(replyUs - t0) : 0);
+    printf("%-34s %s\n", "", line);
+    text->shimOnNotify = nullptr;
+    server->shimDisconnect(conn);
+  }
+  shim::setResetReason(ESP_RST_POWERON);
+  g_status.active = false;
+  screen = Screen::Home;
+}
@@ -0,0 +1,54 @@
+#include <Arduino.h>
+#include <Wire.h>
+#include <esp_system.h>
+#include <chrono>
+
+HardwareSerial Serial;
+TwoWire Wire;
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point g_t0 = Clock::now();
+  uint64_t g_virtualUs = 0;
+  int g_pins[64];
+  bool g_pinsInit = false;
+  struct Isr { void (*fn)(); int mode; };
+  Isr g_isr[64] = {};
+  esp_reset_reason_t g_resetReason = ESP_RST_POWERON;
+
+  uint64_t nowUs() {
+    const auto real = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - g_t0).count();
+    return (uint64_t)real + g_virtualUs;
+  }
+  void initPins() {
+    if (g_pinsInit) return;
+    for (int& p : g_pins) p = HIGH;
+    g_pinsInit = true;
+  }
+}
+
+uint32_t millis() { return (uint32_t)(nowUs() / 1000); }
+uint32_t micros() { return (uint32_t)nowUs(); }
+void delay(uint32_t ms) { g_virtualUs += (uint64_t)ms * 1000; }
+void delayMicroseconds(uint32_t us) { g_virtualUs += us; }
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; initPins(); }
+int digitalRead(uint8_t pin) { initPins(); return pin < 64 ? g_pins[pin] : HIGH; }
+void digitalWrite(uint8_t pin, uint8_t val) { initPins(); if (pin < 64) g_pins[pin] = val; }
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode) { if (pin < 64) g_isr[pin] = Isr{ isr, mode }; }
+void detachInterrupt(uint8_t pin) { if (pin < 64) g_isr[pin] = Isr{}; }
+
+void shim::setPin(uint8_t pin, int level) {
+  initPins();
+  if (pin >= 64) return;
+  const int was = g_pins[pin];
+  g_pins[pin] = level;
+  const Isr& i = g_isr[pin];
+  if (!i.fn || was == level) return;
+  if ((level == HIGH && (i.mode & RISING)) || (level == LOW && (i.mode & FALLING))) i.fn();
+}
+void shim::advanceMs(uint32_t ms) { delay(ms); }
+
+esp_reset_reason_t esp_reset_reason(void) { return g_resetReason; }
+void shim::setResetReason(esp_reset_reason_t r) { g_resetReason = r; }
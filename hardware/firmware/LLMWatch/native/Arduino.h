@@ -0,0 +1,95 @@
+#pragma once
+// Thin Arduino core shim for the [env:native] host build.
+// Only what the firmware in src/ touches: String, Serial, timing, GPIO.
+// C# tether: think of this as a fake IHardware you inject in unit tests.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+#include "WString.h"
+
+using std::min;
+using std::max;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+typedef uint8_t byte;
+
+// ---- Timing ----
+// millis()/micros() run off the host monotonic clock. delay() does NOT sleep:
+// it advances a virtual offset so splash screens and status holds cost nothing
+// in benchmarks while code that measures elapsed time still sees them.
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+inline void yield() {}
+
+// ---- GPIO ----
+// Pins read HIGH (released, with pull-up) until a bench drives them.
+void pinMode(uint8_t pin, uint8_t mode);
+int  digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+
+// ---- Interrupts ----
+// An attached handler runs inline from shim::setPin() when the level changes
+// the way `mode` asks for, as the GPIO ISR would.
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+#define IRAM_ATTR
+#define digitalPinToInterrupt(p) (p)
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void detachInterrupt(uint8_t pin);
+
+namespace shim {
+  /// Drive an input pin level as if a button were pressed/released.
+  void setPin(uint8_t pin, int level);
+  /// Move the virtual clock forward (same as delay()).
+  void advanceMs(uint32_t ms);
+}
+
+// ---- Serial ----
+class HardwareSerial {
+public:
+  void begin(unsigned long) {}
+  void end() {}
+  operator bool() const { return true; }
+
+  size_t print(const String& s)  { return _write(s.c_str(), s.length()); }
+  size_t print(const char* s)    { return _write(s, strlen(s)); }
+  size_t print(char c)           { return _write(&c, 1); }
+  template<typename T> size_t print(T v) { return print(String(v)); }
+  size_t println()               { return _write("\r\n", 2); }
+  template<typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+    char tmp[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(tmp, sizeof(tmp), fmt, ap);
+    va_end(ap);
+    if (n <= 0) return 0;
+    return _write(tmp, std::min((size_t)n, sizeof(tmp) - 1));
+  }
+
+  /// Where output goes on the host; nullptr mutes it (benchmarks do this).
+  void setSink(FILE* f) { _sink = f; }
+
+private:
+  FILE* _sink = stdout;
+  size_t _write(const char* s, size_t n) { if (_sink && n) fwrite(s, 1, n, _sink); return n; }
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,59 @@
+#include <LittleFS.h>
+
+LittleFSFS LittleFS;
+
+File File::openNextFile() {
+  if (!_isDir || _childIdx >= _children.size()) return File();
+  return LittleFS.open(_children[_childIdx++].c_str(), FILE_READ);
+}
+
+File FS::open(const char* path, const char* mode, bool create) {
+  (void)create;
+  const std::string p = path ? path : "";
+  const char m = mode ? mode[0] : 'r';
+
+  if (_dirs.count(p)) {
+    std::vector<std::string> kids;
+    const std::string prefix = (p == "/") ? "/" : p + "/";
+    for (const auto& f : _files)
+      if (f.first.compare(0, prefix.size(), prefix) == 0 && f.first.find('/', prefix.size()) == std::string::npos)
+        kids.push_back(f.first);
+    _stats.opens++;
+    return File(nullptr, p, false, true, std::move(kids), &_stats);
+  }
+
+  auto it = _files.find(p);
+  if (m == 'r') {
+    if (it == _files.end()) return File();
+    _stats.opens++;
+    return File(it->second, p, false, false, {}, &_stats);
+  }
+
+  if (it == _files.end()) it = _files.emplace(p, std::make_shared<shimfs::Node>()).first;
+  if (m == 'w') it->second->data.clear();
+  _stats.opens++;
+  File f(it->second, p, true, false, {}, &_stats);
+  if (m == 'a') f.seek(0, SeekEnd);
+  return f;
+}
+
+bool FS::exists(const char* path) const {
+  return _files.count(path) > 0 || _dirs.count(path) > 0;
+}
+
+bool FS::remove(const char* path) {
+  _stats.removes++;
+  return _files.erase(path) > 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+  auto it = _files.find(from);
+  if (it == _files.end()) return false;
+  auto node = it->second;
+  _files.erase(it);
+  _files[to] = node;
+  return true;
+}
+
+bool FS::mkdir(const char* path) { _dirs[path] = true; return true; }
+bool FS::rmdir(const char* path) { return _dirs.erase(path) > 0; }
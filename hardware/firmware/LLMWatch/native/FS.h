@@ -0,0 +1,146 @@
+#pragma once
+// Host shim for the Arduino-ESP32 FS/File API, backed by RAM.
+// Every open/close/read/write is counted so journal benchmarks can report
+// the flash operations a change saves, not just host CPU time.
+
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+namespace shimfs {
+  struct Node {
+    std::vector<uint8_t> data;
+  };
+  struct Stats {
+    uint32_t opens = 0;
+    uint32_t closes = 0;
+    uint32_t readCalls = 0;
+    uint32_t writeCalls = 0;
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    uint32_t removes = 0;
+  };
+  // Bytes writes may still add before the flash is "full" (FS::shimSpaceLeft);
+  // a write past it is cut short, as a full LittleFS would.
+  inline size_t spaceLeft = SIZE_MAX;
+}
+
+class File {
+public:
+  File() = default;
+  File(std::shared_ptr<shimfs::Node> n, std::string path, bool write, bool isDir,
+       std::vector<std::string> children, shimfs::Stats* stats)
+    : _node(std::move(n)), _path(std::move(path)), _write(write), _isDir(isDir),
+      _children(std::move(children)), _stats(stats) {}
+
+  explicit operator bool() const { return _node != nullptr || _isDir; }
+
+  size_t size() const       { return _node ? _node->data.size() : 0; }
+  size_t position() const   { return _pos; }
+  int available()           { return _node ? (int)(_node->data.size() - _pos) : 0; }
+  const char* name() const  { size_t s = _path.rfind('/'); return _path.c_str() + (s == std::string::npos ? 0 : s + 1); }
+  const char* path() const  { return _path.c_str(); }
+  bool isDirectory() const  { return _isDir; }
+
+  bool seek(uint32_t pos, SeekMode mode = SeekSet) {
+    if (!_node) return false;
+    size_t base = mode == SeekSet ? 0 : mode == SeekCur ? _pos : _node->data.size();
+    size_t np = base + pos;
+    if (np > _node->data.size()) return false;
+    _pos = np;
+    return true;
+  }
+
+  int read() {
+    if (!_node || _pos >= _node->data.size()) return -1;
+    _count(1, false);
+    return _node->data[_pos++];
+  }
+  size_t read(uint8_t* buf, size_t n) {
+    if (!_node) return 0;
+    size_t k = std::min(n, _node->data.size() - _pos);
+    if (k) memcpy(buf, _node->data.data() + _pos, k);
+    _pos += k;
+    _count(k, false);
+    return k;
+  }
+  int peek() { return (_node && _pos < _node->data.size()) ? _node->data[_pos] : -1; }
+
+  size_t write(uint8_t c) { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t n) {
+    if (!_node || !_write) return 0;
+    if (shimfs::spaceLeft != SIZE_MAX) {
+      n = std::min(n, shimfs::spaceLeft);
+      shimfs::spaceLeft -= n;
+    }
+    auto& d = _node->data;
+    if (_pos + n > d.size()) d.resize(_pos + n);
+    memcpy(d.data() + _pos, buf, n);
+    _pos += n;
+    _count(n, true);
+    return n;
+  }
+  size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+  size_t print(const char* s)   { return write((const uint8_t*)s, strlen(s)); }
+  size_t println()              { return write((const uint8_t*)"\r\n", 2); }
+  template<typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+
+  void flush() {}
+  void close() {
+    if ((_node || _isDir) && _stats) _stats->closes++;
+    _node.reset();
+    _isDir = false;
+  }
+
+  /// Directory iteration (children are fixed when the directory is opened).
+  File openNextFile();
+
+private:
+  std::shared_ptr<shimfs::Node> _node;
+  std::string _path;
+  size_t _pos = 0;
+  bool _write = false;
+  bool _isDir = false;
+  std::vector<std::string> _children;
+  size_t _childIdx = 0;
+  shimfs::Stats* _stats = nullptr;
+
+  friend class FS;
+  void _count(size_t n, bool w) {
+    if (!_stats) return;
+    if (w) { _stats->writeCalls++; _stats->bytesWritten += n; }
+    else   { _stats->readCalls++;  _stats->bytesRead += n; }
+  }
+};
+
+class FS {
+public:
+  File open(const char* path, const char* mode = FILE_READ, bool create = false);
+  File open(const String& path, const char* mode = FILE_READ) { return open(path.c_str(), mode); }
+  bool exists(const char* path) const;
+  bool exists(const String& path) const { return exists(path.c_str()); }
+  bool remove(const char* path);
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool rename(const char* from, const char* to);
+  bool mkdir(const char* path);
+  bool rmdir(const char* path);
+
+  // ---- Shim-only ----
+  const shimfs::Stats& shimStats() const { return _stats; }
+  void shimResetStats()                  { _stats = shimfs::Stats{}; }
+  void shimFormat()                      { _files.clear(); _dirs.clear(); }
+  void shimSpaceLeft(size_t bytes)       { shimfs::spaceLeft = bytes; }   // SIZE_MAX: unlimited
+
+protected:
+  std::map<std::string, std::shared_ptr<shimfs::Node>> _files;
+  std::map<std::string, bool> _dirs;
+  shimfs::Stats _stats;
+};
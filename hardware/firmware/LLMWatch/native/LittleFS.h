@@ -0,0 +1,27 @@
+#pragma once
+// Host shim for the LittleFS mount used by JournalStore.
+
+#include "FS.h"
+
+class LittleFSFS : public FS {
+public:
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs",
+             uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs") {
+    (void)formatOnFail; (void)basePath; (void)maxOpenFiles; (void)partitionLabel;
+    _mounted = true;
+    return true;
+  }
+  void end()                 { _mounted = false; }
+  bool format()              { shimFormat(); return true; }
+  size_t totalBytes() const  { return 1536 * 1024; }
+  size_t usedBytes() const {
+    size_t n = 0;
+    for (const auto& f : _files) n += f.second->data.size();
+    return n;
+  }
+
+private:
+  bool _mounted = false;
+};
+
+extern LittleFSFS LittleFS;
@@ -0,0 +1,141 @@
+#include <NimBLEDevice.h>
+
+namespace {
+  NimBLEServer* g_server = nullptr;
+  NimBLEAdvertising g_adv;
+}
+
+NimBLEServer* NimBLEDevice::createServer() {
+  if (!g_server) g_server = new NimBLEServer();
+  return g_server;
+}
+NimBLEServer* NimBLEDevice::getServer()           { return g_server; }
+NimBLEAdvertising* NimBLEDevice::getAdvertising() { return &g_adv; }
+
+// ---- Characteristic ----
+
+bool NimBLECharacteristic::notify(const uint8_t* data, size_t len, uint16_t connHandle) {
+  (void)connHandle;
+  if (shimTxCredits == 0) return false;
+  if (shimTxCredits > 0) shimTxCredits--;
+  shimNotifies++;
+  shimNotifyBytes += len;
+  if (shimOnNotify) shimOnNotify(data, len);
+  if (shimDeferStatus) _heldStatus++;
+  else if (_cbs) _cbs->onStatus(this, 0);
+  return true;
+}
+
+uint32_t NimBLECharacteristic::shimComplete(uint32_t n) {
+  uint32_t fired = 0;
+  while (_heldStatus && fired < n) {
+    _heldStatus--;
+    fired++;
+    if (_cbs) _cbs->onStatus(this, 0);
+  }
+  return fired;
+}
+
+void NimBLECharacteristic::shimWrite(const std::string& v, uint16_t connHandle) {
+  _value = v;
+  if (!_cbs) return;
+  NimBLEConnInfo info(connHandle, _server ? _server->getPeerMTU(connHandle) : 23);
+  _cbs->onWrite(this, info);
+}
+
+// ---- Service ----
+
+NimBLECharacteristic* NimBLEService::createCharacteristic(const char* uuid, uint16_t props) {
+  _chars.emplace_back(new NimBLECharacteristic(uuid, props));
+  _chars.back()->_server = _server;
+  return _chars.back().get();
+}
+
+NimBLECharacteristic* NimBLEService::getCharacteristic(const char* uuid) {
+  for (auto it = _chars.rbegin(); it != _chars.rend(); ++it)
+    if ((*it)->getUUID() == uuid) return it->get();
+  return nullptr;
+}
+
+// ---- Server ----
+
+NimBLEService* NimBLEServer::createService(const char* uuid) {
+  _services.emplace_back(new NimBLEService(uuid, this));
+  return _services.back().get();
+}
+
+NimBLEService* NimBLEServer::getServiceByUUID(const char* uuid) {
+  // Latest wins: benches may construct several BleJournal instances.
+  for (auto it = _services.rbegin(); it != _services.rend(); ++it)
+    if ((*it)->getUUID() == uuid) return it->get();
+  return nullptr;
+}
+
+std::vector<uint16_t> NimBLEServer::getPeerDevices() const {
+  std::vector<uint16_t> out;
+  for (const auto& c : _conns) out.push_back(c.getConnHandle());
+  return out;
+}
+
+uint16_t NimBLEServer::getPeerMTU(uint16_t connHandle) const {
+  for (const auto& c : _conns) if (c.getConnHandle() == connHandle) return c.getMTU();
+  return 0;
+}
+
+uint16_t NimBLEServer::shimConnect(uint16_t mtu) {
+  _conns.emplace_back(_nextHandle++, 23);
+  NimBLEConnInfo& info = _conns.back();
+  NimBLEDevice::stopAdvertising();
+  if (_cbs) _cbs->onConnect(this, info);
+  if (mtu != 23) shimSetMTU(info.getConnHandle(), mtu);
+  return info.getConnHandle();
+}
+
+void NimBLEServer::shimDisconnect(uint16_t connHandle, int reason) {
+  for (auto it = _conns.begin(); it != _conns.end(); ++it) {
+    if (it->getConnHandle() != connHandle) continue;
+    NimBLEConnInfo info = *it;
+    _conns.erase(it);
+    if (_cbs) _cbs->onDisconnect(this, info, reason);
+    if (_advOnDisconnect) NimBLEDevice::startAdvertising();
+    return;
+  }
+}
+
+void NimBLEServer::shimSetMTU(uint16_t connHandle, uint16_t mtu) {
+  for (auto& c : _conns) {
+    if (c.getConnHandle() != connHandle) continue;
+    // Negotiated ATT MTU is the smaller of both sides' preference.
+    c._mtu = std::min(mtu, NimBLEDevice::getMTU());
+    if (_cbs) _cbs->onMTUChange(c._mtu, c);
+    return;
+  }
+}
+
+// The central accepts at once, within its own limits.
+bool NimBLEServer::updateConnParams(uint16_t connHandle, uint16_t minInterval, uint16_t maxInterval,
+                                    uint16_t latency, uint16_t timeout) {
+  shimParamRequests++;
+  for (auto& c : _conns) {
+    if (c.getConnHandle() != connHandle) continue;
+    (void)maxInterval;
+    c._itvl = std::max(minInterval, shimMinInterval);
+    c._latency = latency;
+    c._timeout = timeout;
+    if (_cbs) _cbs->onConnParamsUpdate(c);
+    return true;
+  }
+  return false;
+}
+
+bool NimBLEServer::updatePhy(uint16_t connHandle, uint8_t txPhysMask, uint8_t rxPhysMask, uint16_t phyOptions) {
+  (void)phyOptions;
+  shimPhyRequests++;
+  for (auto& c : _conns) {
+    if (c.getConnHandle() != connHandle) continue;
+    const uint8_t phy = (shimPhy2M && (txPhysMask & rxPhysMask & BLE_GAP_LE_PHY_2M_MASK)) ? BLE_GAP_LE_PHY_2M : BLE_GAP_LE_PHY_1M;
+    if (_cbs) _cbs->onPhyUpdate(c, phy, phy);
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,186 @@
+#pragma once
+// Host shim for the NimBLE-Arduino 2.x peripheral API used by BleJournal.
+// No radio: a bench plays the central through the shim* hooks (connect,
+// write to a characteristic, observe notifications).
+
+#include <Arduino.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+typedef enum { ESP_PWR_LVL_N12 = 0, ESP_PWR_LVL_N9, ESP_PWR_LVL_N6, ESP_PWR_LVL_N3,
+               ESP_PWR_LVL_N0, ESP_PWR_LVL_P3, ESP_PWR_LVL_P6, ESP_PWR_LVL_P9 } esp_power_level_t;
+
+struct ble_gap_conn_desc { uint16_t conn_handle; };
+
+// PHY masks and values (host/ble_gap.h)
+#define BLE_GAP_LE_PHY_1M_MASK     0x01
+#define BLE_GAP_LE_PHY_2M_MASK     0x02
+#define BLE_GAP_LE_PHY_CODED_MASK  0x04
+#define BLE_GAP_LE_PHY_1M          1
+#define BLE_GAP_LE_PHY_2M          2
+#define BLE_GAP_LE_PHY_CODED_ANY   0
+
+namespace NIMBLE_PROPERTY {
+  constexpr uint16_t BROADCAST = 0x0001;
+  constexpr uint16_t READ      = 0x0002;
+  constexpr uint16_t WRITE_NR  = 0x0004;
+  constexpr uint16_t WRITE     = 0x0008;
+  constexpr uint16_t NOTIFY    = 0x0010;
+  constexpr uint16_t INDICATE  = 0x0020;
+}
+
+class NimBLEConnInfo {
+public:
+  NimBLEConnInfo(uint16_t handle = 0, uint16_t mtu = 23) : _handle(handle), _mtu(mtu) {}
+  uint16_t getConnHandle() const   { return _handle; }
+  uint16_t getMTU() const          { return _mtu; }
+  uint16_t getConnInterval() const { return _itvl; }
+  uint16_t getConnLatency() const  { return _latency; }
+  uint16_t getConnTimeout() const  { return _timeout; }
+
+private:
+  friend class NimBLEServer;
+  uint16_t _handle;
+  uint16_t _mtu;
+  uint16_t _itvl = 24;      // 30 ms: what a phone typically opens with
+  uint16_t _latency = 0;
+  uint16_t _timeout = 500;
+};
+
+class NimBLECharacteristic;
+class NimBLEServer;
+
+class NimBLECharacteristicCallbacks {
+public:
+  virtual ~NimBLECharacteristicCallbacks() = default;
+  virtual void onRead(NimBLECharacteristic*, NimBLEConnInfo&) {}
+  virtual void onWrite(NimBLECharacteristic*, NimBLEConnInfo&) {}
+  virtual void onStatus(NimBLECharacteristic*, int) {}
+  virtual void onSubscribe(NimBLECharacteristic*, NimBLEConnInfo&, uint16_t) {}
+};
+
+class NimBLEServerCallbacks {
+public:
+  virtual ~NimBLEServerCallbacks() = default;
+  virtual void onConnect(NimBLEServer*, NimBLEConnInfo&) {}
+  virtual void onDisconnect(NimBLEServer*, NimBLEConnInfo&, int) {}
+  virtual void onMTUChange(uint16_t, NimBLEConnInfo&) {}
+  virtual void onConnParamsUpdate(NimBLEConnInfo&) {}
+  virtual void onPhyUpdate(NimBLEConnInfo&, uint8_t, uint8_t) {}
+};
+
+class NimBLECharacteristic {
+public:
+  NimBLECharacteristic(std::string uuid, uint16_t props) : _uuid(std::move(uuid)), _props(props) {}
+
+  void setCallbacks(NimBLECharacteristicCallbacks* cbs) { _cbs = cbs; }
+  void setValue(const std::string& v)               { _value = v; }
+  void setValue(const char* v)                      { _value = v ? v : ""; }
+  void setValue(const uint8_t* data, size_t len)    { _value.assign((const char*)data, len); }
+  std::string getValue() const                      { return _value; }
+  const std::string& getUUID() const                { return _uuid; }
+
+  bool notify(uint16_t connHandle = 0xFFFF) { return notify((const uint8_t*)_value.data(), _value.size(), connHandle); }
+  bool notify(const uint8_t* data, size_t len, uint16_t connHandle = 0xFFFF);
+
+  // ---- Shim-only: the central's side ----
+  /// Central writes `v`; dispatches onWrite like the host stack would.
+  void shimWrite(const std::string& v, uint16_t connHandle = 0);
+  /// Called for every notification that leaves the device.
+  std::function<void(const uint8_t*, size_t)> shimOnNotify;
+  /// -1 = unlimited; otherwise each notify() spends one and fails at 0 (models full TX buffers).
+  int32_t shimTxCredits = -1;
+  /// When true, onStatus (notify-complete) is held until shimComplete() instead of firing at once.
+  bool shimDeferStatus = false;
+  /// Deliver up to n held completions; returns how many fired.
+  uint32_t shimComplete(uint32_t n = UINT32_MAX);
+  uint32_t shimNotifies = 0;
+  uint64_t shimNotifyBytes = 0;
+
+private:
+  friend class NimBLEService;
+  std::string _uuid;
+  uint16_t _props;
+  std::string _value;
+  NimBLECharacteristicCallbacks* _cbs = nullptr;
+  NimBLEServer* _server = nullptr;
+  uint32_t _heldStatus = 0;
+};
+
+class NimBLEService {
+public:
+  NimBLEService(std::string uuid, NimBLEServer* server) : _uuid(std::move(uuid)), _server(server) {}
+  NimBLECharacteristic* createCharacteristic(const char* uuid, uint16_t props);
+  NimBLECharacteristic* getCharacteristic(const char* uuid);
+  bool start() { return true; }
+  const std::string& getUUID() const { return _uuid; }
+
+private:
+  std::string _uuid;
+  NimBLEServer* _server;
+  std::vector<std::unique_ptr<NimBLECharacteristic>> _chars;
+};
+
+class NimBLEServer {
+public:
+  void setCallbacks(NimBLEServerCallbacks* cbs, bool deleteCallbacks = false) { (void)deleteCallbacks; _cbs = cbs; }
+  NimBLEService* createService(const char* uuid);
+  NimBLEService* getServiceByUUID(const char* uuid);
+  size_t getConnectedCount() const { return _conns.size(); }
+  std::vector<uint16_t> getPeerDevices() const;
+  uint16_t getPeerMTU(uint16_t connHandle) const;
+  void advertiseOnDisconnect(bool on) { _advOnDisconnect = on; }
+  bool updateConnParams(uint16_t connHandle, uint16_t minInterval, uint16_t maxInterval, uint16_t latency, uint16_t timeout);
+  bool updatePhy(uint16_t connHandle, uint8_t txPhysMask, uint8_t rxPhysMask, uint16_t phyOptions);
+
+  // ---- Shim-only: the central's side ----
+  uint16_t shimConnect(uint16_t mtu = 23);
+  void shimDisconnect(uint16_t connHandle, int reason = 0x13);
+  void shimSetMTU(uint16_t connHandle, uint16_t mtu);
+  /// The central's floor for the interval (1.25 ms units): requests below it get this.
+  uint16_t shimMinInterval = 12;
+  /// The central does 2M PHY.
+  bool shimPhy2M = true;
+  uint32_t shimParamRequests = 0;
+  uint32_t shimPhyRequests = 0;
+
+private:
+  NimBLEServerCallbacks* _cbs = nullptr;
+  std::vector<std::unique_ptr<NimBLEService>> _services;
+  std::vector<NimBLEConnInfo> _conns;
+  uint16_t _nextHandle = 1;
+  bool _advOnDisconnect = true;
+};
+
+class NimBLEAdvertising {
+public:
+  bool addServiceUUID(const char* uuid) { (void)uuid; return true; }
+  bool setName(const std::string& name) { _name = name; return true; }
+  bool start(uint32_t durationMs = 0)   { (void)durationMs; _active = true; return true; }
+  bool stop()                           { _active = false; return true; }
+  bool isAdvertising() const            { return _active; }
+
+private:
+  std::string _name;
+  bool _active = false;
+};
+
+class NimBLEDevice {
+public:
+  static bool init(const std::string& name)  { _name() = name; return true; }
+  static bool setPower(esp_power_level_t lvl) { (void)lvl; return true; }
+  static void setSecurityAuth(bool bonding, bool mitm, bool sc) { (void)bonding; (void)mitm; (void)sc; }
+  static bool setMTU(uint16_t mtu)            { _mtu() = mtu; return true; }
+  static uint16_t getMTU()                    { return _mtu(); }
+  static NimBLEServer* createServer();
+  static NimBLEServer* getServer();
+  static NimBLEAdvertising* getAdvertising();
+  static bool startAdvertising(uint32_t durationMs = 0) { return getAdvertising()->start(durationMs); }
+  static bool stopAdvertising()                         { return getAdvertising()->stop(); }
+
+private:
+  static std::string& _name() { static std::string n; return n; }
+  static uint16_t& _mtu()     { static uint16_t m = 255; return m; }
+};
@@ -0,0 +1,43 @@
+#include "ShimHeap.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+namespace {
+  std::atomic<uint64_t> g_allocs{0};
+  std::atomic<uint64_t> g_frees{0};
+  std::atomic<uint64_t> g_bytes{0};
+  std::atomic<uint64_t> g_live{0};
+  std::atomic<uint64_t> g_peak{0};
+
+  void* countedAlloc(size_t n) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(n, std::memory_order_relaxed);
+    void* p = std::malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    const uint64_t live = g_live.fetch_add(malloc_usable_size(p), std::memory_order_relaxed) + malloc_usable_size(p);
+    uint64_t peak = g_peak.load(std::memory_order_relaxed);
+    while (live > peak && !g_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    return p;
+  }
+  void countedFree(void* p) {
+    if (!p) return;
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+    g_live.fetch_sub(malloc_usable_size(p), std::memory_order_relaxed);
+    std::free(p);
+  }
+}
+
+shim::HeapStats shim::heapStats() {
+  return HeapStats{ g_allocs.load(), g_frees.load(), g_bytes.load(), g_live.load(), g_peak.load() };
+}
+
+void shim::heapResetPeak() { g_peak.store(g_live.load()); }
+
+void* operator new(size_t n)                   { return countedAlloc(n); }
+void* operator new[](size_t n)                 { return countedAlloc(n); }
+void  operator delete(void* p) noexcept        { countedFree(p); }
+void  operator delete[](void* p) noexcept      { countedFree(p); }
+void  operator delete(void* p, size_t) noexcept   { countedFree(p); }
+void  operator delete[](void* p, size_t) noexcept { countedFree(p); }
@@ -0,0 +1,23 @@
+#pragma once
+// Heap accounting for the native env: ShimHeap.cpp replaces global
+// operator new/delete, so every String, std::map node and std::function
+// capture made by firmware code is counted.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace shim {
+  struct HeapStats {
+    uint64_t allocs = 0;
+    uint64_t frees  = 0;
+    uint64_t bytes  = 0;   // total requested
+    uint64_t live   = 0;   // bytes allocated now (allocator block sizes)
+    uint64_t peak   = 0;   // max of live since the last heapResetPeak()
+  };
+
+  /// Snapshot of the process-wide counters.
+  HeapStats heapStats();
+
+  /// Start a new peak window at the current live size.
+  void heapResetPeak();
+}
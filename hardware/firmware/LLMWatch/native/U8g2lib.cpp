@@ -0,0 +1,4 @@
+#include <U8g2lib.h>
+
+// Only used as an identity token by the shim's drawStr().
+const uint8_t u8g2_font_6x12_tf[] = { 6, 12 };
@@ -0,0 +1,139 @@
+#pragma once
+// Host shim for the U8g2 full-buffer API used by OledView.
+// Keeps a real 128x64 page-major framebuffer plus a copy of "panel RAM", and
+// counts the bytes each transfer would put on the I2C bus, so render benchmarks
+// can report both CPU time and modeled bus time.
+
+#include <Arduino.h>
+
+typedef const uint8_t* u8g2_cb_t;
+#define U8G2_R0 nullptr
+#define U8X8_PIN_NONE 255
+
+extern const uint8_t u8g2_font_6x12_tf[];
+
+class U8G2 {
+public:
+  static constexpr uint8_t  TILE_W = 16;   // 8-px tiles across
+  static constexpr uint8_t  TILE_H = 8;    // pages (8-px rows)
+  static constexpr uint16_t BUF_BYTES = TILE_W * 8 * TILE_H;
+
+  bool begin()                         { _begun = true; return true; }
+  void setI2CAddress(uint8_t adr)      { _addr = adr; }
+  void setFont(const uint8_t* font)    { _font = font; }
+  void setDrawColor(uint8_t c)         { _color = c; }
+  void setPowerSave(uint8_t on)        { (void)on; }
+
+  void clearBuffer()                   { memset(_buf, 0, sizeof(_buf)); }
+  void clearDisplay()                  { clearBuffer(); sendBuffer(); }
+
+  uint8_t* getBufferPtr()              { return _buf; }
+  uint8_t  getBufferTileWidth() const  { return TILE_W; }
+  uint8_t  getBufferTileHeight() const { return TILE_H; }
+  uint16_t getDisplayWidth() const     { return TILE_W * 8; }
+  uint16_t getDisplayHeight() const    { return TILE_H * 8; }
+
+  void drawPixel(int x, int y) {
+    if (x < 0 || y < 0 || x >= TILE_W * 8 || y >= TILE_H * 8) return;
+    uint8_t& b = _buf[(y >> 3) * (TILE_W * 8) + x];
+    const uint8_t m = (uint8_t)(1u << (y & 7));
+    if (_color == 0) b &= (uint8_t)~m;
+    else if (_color == 2) b ^= m;
+    else b |= m;
+  }
+  void drawHLine(int x, int y, int w) { for (int i = 0; i < w; ++i) drawPixel(x + i, y); }
+  void drawVLine(int x, int y, int h) { for (int i = 0; i < h; ++i) drawPixel(x, y + i); }
+  void drawBox(int x, int y, int w, int h) { for (int j = 0; j < h; ++j) drawHLine(x, y + j, w); }
+
+  /// 6x12 cell font: glyph body sits in rows [y-9, y-1] of the baseline y.
+  /// Pixels are a deterministic hash of the character, which is all the
+  /// dirty-region and bus accounting needs.
+  uint16_t drawStr(int x, int y, const char* s) {
+    if (!s) return 0;
+    int cx = x;
+    for (; *s; ++s, cx += GLYPH_W) {
+      const uint8_t c = (uint8_t)*s;
+      if (c == ' ') continue;
+      for (int r = 0; r < 9; ++r) {
+        const uint8_t bits = (uint8_t)((c * 37u + r * 11u) ^ (c >> 1));
+        for (int col = 0; col < GLYPH_W - 1; ++col)
+          if (bits & (1u << col)) drawPixel(cx + col, y - 9 + r);
+      }
+    }
+    return (uint16_t)(cx - x);
+  }
+  uint16_t getStrWidth(const char* s) const { return s ? (uint16_t)(strlen(s) * GLYPH_W) : 0; }
+
+  // ---- Transfers ----
+  void sendBuffer() { updateDisplayArea(0, 0, TILE_W, TILE_H); }
+
+  /// Copy a tile rectangle to panel RAM (U8g2 area update).
+  void updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th) {
+    if (tx >= TILE_W || ty >= TILE_H) return;
+    if (tx + tw > TILE_W) tw = TILE_W - tx;
+    if (ty + th > TILE_H) th = TILE_H - ty;
+    for (uint8_t p = ty; p < ty + th; ++p) {
+      const uint16_t off = p * (TILE_W * 8) + tx * 8;
+      memcpy(_panel + off, _buf + off, tw * 8);
+      _stats.busBytes += CMD_BYTES_PER_PAGE + tw * 8;
+    }
+    _stats.transfers++;
+  }
+
+  /// Send cnt tiles (8 bytes each, column-major like the buffer) to page y
+  /// at tile column x, straight from tile_ptr (u8x8 tile write).
+  void drawTile(uint8_t x, uint8_t y, uint8_t cnt, uint8_t* tile_ptr) {
+    if (x >= TILE_W || y >= TILE_H) return;
+    if (x + cnt > TILE_W) cnt = TILE_W - x;
+    memcpy(_panel + y * (TILE_W * 8) + x * 8, tile_ptr, cnt * 8);
+    _stats.busBytes += CMD_BYTES_PER_PAGE + cnt * 8;
+    _stats.transfers++;
+  }
+
+  /// Raw command bytes ("c" per byte in the format string, as in U8g2).
+  void sendF(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    for (const char* f = fmt; *f; ++f) {
+      const int v = va_arg(ap, int);
+      if (*f == 'c') _onCommand((uint8_t)v);
+    }
+    va_end(ap);
+  }
+
+  // ---- Shim-only introspection ----
+  struct Stats {
+    uint32_t transfers = 0;   // sendBuffer/updateDisplayArea/drawTile calls
+    uint64_t busBytes  = 0;   // data + per-page addressing overhead
+  };
+  const Stats& shimStats() const  { return _stats; }
+  void shimResetStats()           { _stats = Stats{}; }
+  const uint8_t* shimPanel() const { return _panel; }
+  uint8_t shimStartLine() const   { return _startLine; }
+
+private:
+  static constexpr int     GLYPH_W = 6;
+  static constexpr uint8_t CMD_BYTES_PER_PAGE = 4;   // ctrl + page + col lo/hi
+
+  uint8_t _buf[BUF_BYTES]   = {0};
+  uint8_t _panel[BUF_BYTES] = {0};
+  const uint8_t* _font = nullptr;
+  uint8_t _addr = 0x78;
+  uint8_t _color = 1;
+  uint8_t _startLine = 0;
+  bool _begun = false;
+  Stats _stats;
+
+  void _onCommand(uint8_t c) {
+    if ((c & 0xC0) == 0x40) _startLine = c & 0x3F;   // SH1106/SSD1306 display start line
+    _stats.busBytes += 2;
+  }
+};
+
+class U8G2_SH1106_128X64_NONAME_F_HW_I2C : public U8G2 {
+public:
+  U8G2_SH1106_128X64_NONAME_F_HW_I2C(u8g2_cb_t rotation, uint8_t reset = U8X8_PIN_NONE,
+                                      uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE) {
+    (void)rotation; (void)reset; (void)clock; (void)data;
+  }
+};
@@ -0,0 +1,194 @@
+#pragma once
+// Host-side stand-in for the Arduino-ESP32 String class (native env only).
+// Same API surface the firmware uses; storage is plain new[]/delete[] so the
+// heap counters in ShimHeap.hpp see every allocation a real String would make.
+// Note: length()/indexOf() types follow the 32-bit target where size_t == unsigned int.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+class String {
+public:
+  String() = default;
+  String(const char* s)               { _assign(s, s ? strlen(s) : 0); }
+  String(const char* s, size_t n)     { _assign(s, n); }
+  String(const std::string& s)        { _assign(s.data(), s.size()); }
+  String(const String& o)             { _assign(o._buf, o._len); }
+  String(String&& o) noexcept         { _steal(o); }
+  explicit String(char c)             { _assign(&c, 1); }
+  explicit String(int v, unsigned char base = 10)                { _fromSigned(v, base); }
+  explicit String(unsigned int v, unsigned char base = 10)       { _fromUnsigned(v, base); }
+  explicit String(long v, unsigned char base = 10)               { _fromSigned(v, base); }
+  explicit String(unsigned long v, unsigned char base = 10)      { _fromUnsigned(v, base); }
+  explicit String(long long v, unsigned char base = 10)          { _fromSigned(v, base); }
+  explicit String(unsigned long long v, unsigned char base = 10) { _fromUnsigned(v, base); }
+  explicit String(float v, unsigned int decimals = 2)  { _fromDouble(v, decimals); }
+  explicit String(double v, unsigned int decimals = 2) { _fromDouble(v, decimals); }
+  ~String() { delete[] _buf; }
+
+  String& operator=(const String& o) { if (this != &o) _assign(o._buf, o._len); return *this; }
+  String& operator=(String&& o) noexcept { if (this != &o) { delete[] _buf; _buf = nullptr; _steal(o); } return *this; }
+  String& operator=(const char* s)   { _assign(s, s ? strlen(s) : 0); return *this; }
+
+  // ---- Capacity ----
+  bool reserve(size_t n)          { return _grow(n); }
+  size_t length() const           { return _len; }
+  bool isEmpty() const            { return _len == 0; }
+  const char* c_str() const       { return _buf ? _buf : ""; }
+  operator std::string() const    { return std::string(c_str(), _len); }
+
+  // ---- Append ----
+  bool concat(const char* s, size_t n) {
+    if (!n) return true;
+    if (!_grow(_len + n)) return false;
+    memmove(_buf + _len, s, n);
+    _len += n;
+    _buf[_len] = '\0';
+    return true;
+  }
+  bool concat(const String& s)    { return concat(s.c_str(), s._len); }
+  bool concat(const char* s)      { return s ? concat(s, strlen(s)) : false; }
+  bool concat(char c)             { return concat(&c, 1); }
+  template<typename T> bool concat(T v) { return concat(String(v)); }
+
+  String& operator+=(const String& s) { concat(s); return *this; }
+  String& operator+=(const char* s)   { concat(s); return *this; }
+  String& operator+=(char c)          { concat(c); return *this; }
+  template<typename T> String& operator+=(T v) { concat(String(v)); return *this; }
+
+  // ---- Compare ----
+  bool equals(const String& o) const  { return _len == o._len && memcmp(c_str(), o.c_str(), _len) == 0; }
+  bool equals(const char* s) const    { return s && strcmp(c_str(), s) == 0; }
+  bool operator==(const String& o) const { return equals(o); }
+  bool operator==(const char* s) const   { return equals(s); }
+  bool operator!=(const String& o) const { return !equals(o); }
+  bool operator!=(const char* s) const   { return !equals(s); }
+  bool operator<(const String& o) const  { return strcmp(c_str(), o.c_str()) < 0; }
+  bool startsWith(const String& p) const { return p._len <= _len && memcmp(c_str(), p.c_str(), p._len) == 0; }
+  bool endsWith(const String& p) const   { return p._len <= _len && memcmp(c_str() + _len - p._len, p.c_str(), p._len) == 0; }
+
+  // ---- Access ----
+  char charAt(size_t i) const      { return i < _len ? _buf[i] : '\0'; }
+  char operator[](size_t i) const  { return charAt(i); }
+  char& operator[](size_t i)       { static char dummy; return i < _len ? _buf[i] : (dummy = '\0'); }
+  void toCharArray(char* out, size_t n, size_t from = 0) const {
+    if (!out || !n) return;
+    size_t k = (from < _len) ? _len - from : 0;
+    if (k > n - 1) k = n - 1;
+    if (k) memcpy(out, c_str() + from, k);
+    out[k] = '\0';
+  }
+
+  // ---- Search ----
+  int indexOf(char c, size_t from = 0) const {
+    for (size_t i = from; i < _len; ++i) if (_buf[i] == c) return (int)i;
+    return -1;
+  }
+  int indexOf(const String& s, size_t from = 0) const {
+    if (from > _len) return -1;
+    const char* hit = strstr(c_str() + from, s.c_str());
+    return hit ? (int)(hit - c_str()) : -1;
+  }
+  int lastIndexOf(char c) const { return _len ? lastIndexOf(c, _len - 1) : -1; }
+  int lastIndexOf(char c, size_t from) const {
+    if (!_len) return -1;
+    if (from >= _len) from = _len - 1;
+    for (size_t i = from + 1; i-- > 0;) if (_buf[i] == c) return (int)i;
+    return -1;
+  }
+  String substring(size_t from) const { return substring(from, _len); }
+  String substring(size_t from, size_t to) const {
+    if (from > to) { size_t t = from; from = to; to = t; }
+    if (from >= _len) return String();
+    if (to > _len) to = _len;
+    return String(_buf + from, to - from);
+  }
+
+  // ---- Modify ----
+  void trim() {
+    size_t a = 0, b = _len;
+    while (a < b && _isSpace(_buf[a])) a++;
+    while (b > a && _isSpace(_buf[b - 1])) b--;
+    if (a) memmove(_buf, _buf + a, b - a);
+    _len = b - a;
+    if (_buf) _buf[_len] = '\0';
+  }
+  void remove(size_t index, size_t count = (size_t)-1) {
+    if (index >= _len) return;
+    if (count > _len - index) count = _len - index;
+    memmove(_buf + index, _buf + index + count, _len - index - count);
+    _len -= count;
+    _buf[_len] = '\0';
+  }
+
+  // ---- Convert ----
+  long toInt() const { return _buf ? ::strtol(_buf, nullptr, 10) : 0; }
+
+private:
+  char*  _buf = nullptr;
+  size_t _len = 0;
+  size_t _cap = 0;
+
+  static bool _isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v'; }
+
+  bool _grow(size_t n) {
+    if (_buf && n <= _cap) return true;
+    char* nb = new char[n + 1];
+    if (_buf) { memcpy(nb, _buf, _len + 1); delete[] _buf; }
+    else nb[0] = '\0';
+    _buf = nb;
+    _cap = n;
+    return true;
+  }
+  void _assign(const char* s, size_t n) {
+    if (!s) n = 0;
+    if (!_grow(n)) return;
+    if (n) memmove(_buf, s, n);
+    _len = n;
+    _buf[n] = '\0';
+  }
+  void _steal(String& o) {
+    _buf = o._buf; _len = o._len; _cap = o._cap;
+    o._buf = nullptr; o._len = o._cap = 0;
+  }
+  template<typename T> void _fromUnsigned(T v, unsigned char base) {
+    char tmp[66]; size_t i = sizeof(tmp);
+    tmp[--i] = '\0';
+    do { unsigned d = (unsigned)(v % base); tmp[--i] = (char)(d < 10 ? '0' + d : 'a' + d - 10); v /= base; } while (v);
+    _assign(tmp + i, sizeof(tmp) - 1 - i);
+  }
+  template<typename T> void _fromSigned(T v, unsigned char base) {
+    if (v >= 0 || base != 10) { _fromUnsigned((unsigned long long)v, base); return; }
+    _fromUnsigned((unsigned long long)(-(v + 1)) + 1, base);
+    String neg("-"); neg.concat(*this); *this = static_cast<String&&>(neg);
+  }
+  void _fromDouble(double v, unsigned int decimals) {
+    char tmp[48];
+    int n = snprintf(tmp, sizeof(tmp), "%.*f", (int)decimals, v);
+    _assign(tmp, n > 0 ? (size_t)n : 0);
+  }
+};
+
+// Arduino builds these through StringSumHelper; plain value returns are equivalent here.
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b)   { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b)   { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b)          { String r(a); r += b; return r; }
+inline String operator+(String&& a, const String& b)      { a += b; return static_cast<String&&>(a); }
+inline String operator+(String&& a, const char* b)        { a += b; return static_cast<String&&>(a); }
+inline String operator+(String&& a, char b)               { a += b; return static_cast<String&&>(a); }
+#define WSTRING_SUM_NUM(T) \
+  inline String operator+(const String& a, T b) { String r(a); r += String(b); return r; } \
+  inline String operator+(String&& a, T b)      { a += String(b); return static_cast<String&&>(a); }
+WSTRING_SUM_NUM(int)
+WSTRING_SUM_NUM(unsigned int)
+WSTRING_SUM_NUM(long)
+WSTRING_SUM_NUM(unsigned long)
+WSTRING_SUM_NUM(long long)
+WSTRING_SUM_NUM(unsigned long long)
+#undef WSTRING_SUM_NUM
+inline bool operator==(const char* a, const String& b) { return b == a; }
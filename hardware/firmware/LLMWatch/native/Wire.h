@@ -0,0 +1,16 @@
+#pragma once
+// Host shim: I2C bus. The U8g2 shim models the bus traffic itself.
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+  bool begin(int sda = -1, int scl = -1, uint32_t freq = 0) { (void)sda; (void)scl; if (freq) _clock = freq; return true; }
+  void setClock(uint32_t hz) { _clock = hz; }
+  uint32_t getClock() const  { return _clock; }
+
+private:
+  uint32_t _clock = 100000;
+};
+
+extern TwoWire Wire;
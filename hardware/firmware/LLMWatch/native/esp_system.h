@@ -0,0 +1,23 @@
+#pragma once
+// Host shim for the bits of esp_system.h the firmware reads.
+
+typedef enum {
+  ESP_RST_UNKNOWN,
+  ESP_RST_POWERON,
+  ESP_RST_EXT,
+  ESP_RST_SW,
+  ESP_RST_PANIC,
+  ESP_RST_INT_WDT,
+  ESP_RST_TASK_WDT,
+  ESP_RST_WDT,
+  ESP_RST_DEEPSLEEP,
+  ESP_RST_BROWNOUT,
+  ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+esp_reset_reason_t esp_reset_reason(void);
+
+namespace shim {
+  /// Pretend the last reset had this cause (default: power-on).
+  void setResetReason(esp_reset_reason_t r);
+}
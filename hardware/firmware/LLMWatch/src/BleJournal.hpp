@@ -3,7 +3,28 @@
 
 #include <Arduino.h>
 #include <NimBLEDevice.h>
+#include <atomic>
 #include <functional>
+#include "BleTxQueue.hpp"
+#include "LinkProfile.hpp"
+#include "SpscQueue.hpp"
+
+// ATT MTU we ask for; each link then uses whatever the central agrees to.
+#ifndef BLE_PREFERRED_MTU
+#define BLE_PREFERRED_MTU 517
+#endif
+// Inbound writes waiting for loop() (bytes, power of two).
+#ifndef BLE_RX_QUEUE_BYTES
+#define BLE_RX_QUEUE_BYTES 4096
+#endif
+// A write that finds the inbound queue full is dropped (and counted) at once:
+// CREDIT and the receive window keep the central from getting that far
+// ahead. Opt-in: let the NimBLE task wait up to this many µs for loop() to
+// make room first; kept well below the shortest connection interval (7.5 ms).
+#ifndef BLE_RX_FULL_WAIT_US
+#define BLE_RX_FULL_WAIT_US 0
+#endif
+static_assert(BLE_RX_FULL_WAIT_US <= 1000, "BLE_RX_FULL_WAIT_US must stay well below a connection interval");
 
 #define UUID_SVC  "0000A100-0000-1000-8000-00805F9B34FB"
 #define UUID_CMD  "0000A101-0000-1000-8000-00805F9B34FB"
@@ -14,6 +35,14 @@ class BleJournal {
 public:
   using OnCommand = std::function<void(const String&)>;
 
+  struct RxStats {
+    uint32_t depth;       // bytes waiting right now
+    uint32_t highWater;   // most bytes ever waiting
+    uint32_t queued;      // writes handed to loop()
+    uint32_t drops;       // writes lost to a full queue
+    uint32_t waits;       // writes that waited for room (BLE_RX_FULL_WAIT_US)
+  };
+
   bool begin(const char* deviceName, OnCommand onCommand) {
     _onCommand = onCommand;
 
@@ -24,6 +53,7 @@ public:
 
     _server = NimBLEDevice::createServer();
     _server->setCallbacks(&_serverCbs);
+    _serverCbs.setOwner(this);
 
     NimBLEService* svc = _server->createService(UUID_SVC);
 
@@ -34,6 +64,8 @@ public:
 
     _text = svc->createCharacteristic(UUID_TEXT,
               NIMBLE_PROPERTY::NOTIFY | NIMBLE_PROPERTY::READ);
+    _text->setCallbacks(&_textCbs);
+    _textCbs.setOwner(this);
 
     _mtu = svc->createCharacteristic(UUID_MTU, NIMBLE_PROPERTY::READ);
     _mtu->setValue(String(_preferredMTU).c_str());
@@ -48,37 +80,125 @@ public:
     return true;
   }
 
+  // Deliver queued writes to onCommand (here, on the loop() task, never in
+  // the BLE callback), then drain anything the stack had no room for last time.
   void loop() {
-    // no-op; place reconnect/backoff here later
+    size_t n;
+    while (_rx.pop(_rxMsg, sizeof(_rxMsg), n)) {
+      if (!_onCommand || !n) continue;
+      _rxLine = "";
+      _rxLine.concat((const char*)_rxMsg, n);   // keep embedded NULs (ProtoV2)
+      _onCommand(_rxLine);
+    }
+    _pump();
   }
 
-  void notifyText(const String& msg) {
-    if (!_text) return;
-    const size_t maxPayload = (_preferredMTU > 23) ? (_preferredMTU - 3) : 20;
-    size_t pos = 0;
-    while (pos < msg.length()) {
-      size_t len = std::min(maxPayload, msg.length() - pos);
-      std::string chunk = msg.substring(pos, pos + len).c_str();
-      _text->setValue(chunk);
-      _text->notify();
-      pos += len;
-      delay(5);
-    }
+  // Queue a message for notification and return immediately. Long messages
+  // are split into MTU-sized notifications; false if its class queue is full.
+  // `pack`: the peer can split messages itself (newline-terminated lines,
+  // ProtoV2 frames), so several may share one notification.
+  bool notifyText(const String& msg, TxPrio prio = TxPrio::Normal, bool pack = false) {
+    return notifyBytes((const uint8_t*)msg.c_str(), msg.length(), prio, pack);
+  }
+
+  // Binary-safe variant (ProtoV2 frames may contain NUL bytes).
+  bool notifyBytes(const uint8_t* data, size_t n, TxPrio prio = TxPrio::Normal, bool pack = false) {
+    if (!_text) return false;
+    if (!_tx.push(prio, data, n, pack)) return false;
+    _pump();
+    return true;
+  }
+
+  // Queue msg + '\n' as a packable message (line protocols: the peer splits on newlines).
+  bool notifyLine(const String& msg, TxPrio prio = TxPrio::Normal) {
+    if (!_text) return false;
+    static const uint8_t nl = '\n';
+    if (!_tx.push(prio, (const uint8_t*)msg.c_str(), msg.length(), &nl, 1, true)) return false;
+    _pump();
+    return true;
+  }
+
+  // Bytes one notification can carry right now: ATT MTU - 3 of the
+  // smallest connected peer (notify() goes to all of them).
+  size_t payloadSize() const { return _payload.load(); }
+
+  // Room left for one more message of this class.
+  size_t txFree(TxPrio prio) const { return _tx.free(prio); }
+
+  // Inbound bytes (writes plus framing) the handoff queue can still take.
+  size_t rxFree() const { return BLE_RX_QUEUE_BYTES - _rx.depth(); }
+
+  // Queue depth, high-water marks, drop and backpressure counters.
+  BleTxQueue::Stats txStats() const { return _tx.stats(); }
+
+  // Same for the inbound handoff.
+  RxStats rxStats() const {
+    const auto q = _rx.stats();
+    return RxStats{ (uint32_t)_rx.depth(), q.highWater, q.queued, q.drops, _rxWaits };
+  }
+
+  // Called from the NimBLE task when loop() has something new to do: a
+  // write arrived, a notification completed, a central came or went.
+  // Must be short and non-blocking (e.g. LoopRuntime::post).
+  void setWake(void (*wake)()) { _wake = wake; }
+
+  // Time until loop() has work without being woken (0 = now); UINT32_MAX
+  // when only the stack can bring more.
+  uint32_t msUntilDue(uint32_t nowMs) const {
+    if (_rx.depth()) return 0;
+    return _tx.msUntilDue(nowMs);
   }
 
   bool isConnected() const {
     return _server && _server->getConnectedCount() > 0;
   }
 
+  // Ask every connected central for these connection parameters, and for
+  // the 2M PHY (or back to 1M). Asynchronous and only a request: connInterval(),
+  // connLatency() and phy() report what the central granted.
+  bool requestParams(const LinkProfile::Params& p) {
+    if (!_server) return false;
+    bool ok = false;
+    const uint8_t phys = p.phy2M ? BLE_GAP_LE_PHY_2M_MASK : BLE_GAP_LE_PHY_1M_MASK;
+    for (uint16_t h : _server->getPeerDevices()) {
+      ok |= _server->updateConnParams(h, p.minItvl, p.maxItvl, p.latency, p.timeout);
+      if (p.phy2M != (_phy.load() == BLE_GAP_LE_PHY_2M)) _server->updatePhy(h, phys, phys, BLE_GAP_LE_PHY_CODED_ANY);
+    }
+    return ok;
+  }
+
+  // Last reported by the stack: interval (1.25 ms units), slave latency, PHY (1 = 1M, 2 = 2M).
+  uint16_t connInterval() const { return _itvl.load(); }
+  uint16_t connLatency() const  { return _latency.load(); }
+  uint8_t  phy() const          { return _phy.load(); }
+
 private:
   // ---- Callbacks ----
   class CmdCallbacks : public NimBLECharacteristicCallbacks {
   public:
     void setOwner(BleJournal* owner) { _owner = owner; }
+    // Runs on the NimBLE host task: only enqueue, loop() does the work.
     void onWrite(NimBLECharacteristic* ch) {             // no 'override' to satisfy all versions
-      if (!_owner || !_owner->_onCommand) return;
+      if (!_owner) return;
       std::string value = ch->getValue();
-      _owner->_onCommand(String(value.c_str()));
+      _owner->_enqueue((const uint8_t*)value.data(), value.length());
+    }
+    // NimBLE 2.x passes connection info; forward to the form above.
+    void onWrite(NimBLECharacteristic* ch, NimBLEConnInfo& info) { (void)info; onWrite(ch); }
+  private:
+    BleJournal* _owner = nullptr;
+  };
+
+  // Notify-complete: the stack freed a buffer, so hand it the next chunk.
+  class TextCallbacks : public NimBLECharacteristicCallbacks {
+  public:
+    void setOwner(BleJournal* owner) { _owner = owner; }
+    void onStatus(NimBLECharacteristic* ch, int code) {
+      (void)ch; (void)code;
+      if (!_owner) return;
+      _owner->_tx.onSent();
+      _owner->_pump();
+      _owner->_woke();
     }
   private:
     BleJournal* _owner = nullptr;
@@ -86,21 +206,63 @@ private:
 
   class ServerCallbacks : public NimBLEServerCallbacks {
   public:
+    void setOwner(BleJournal* owner) { _owner = owner; }
+
     // Some NimBLE versions call this overload:
     void onConnect(NimBLEServer* s) { (void)s; }
 
     // Some call this one with connection descriptor:
     void onConnect(NimBLEServer* s, ble_gap_conn_desc* desc) { (void)s; (void)desc; }
 
+    // NimBLE 2.x: every link starts at the default ATT MTU until exchanged.
+    void onConnect(NimBLEServer* s, NimBLEConnInfo& info) {
+      (void)s;
+      if (!_owner) return;
+      _owner->_peerUp(info.getConnHandle(), info.getMTU());
+      _owner->_phy = BLE_GAP_LE_PHY_1M;
+      onConnParamsUpdate(info);
+      _owner->_woke();
+    }
+
     void onDisconnect(NimBLEServer* s) {
       (void)s;
       NimBLEDevice::startAdvertising();
     }
 
+    void onDisconnect(NimBLEServer* s, NimBLEConnInfo& info, int reason) {
+      (void)s; (void)reason;
+      if (_owner) _owner->_peerDown(info.getConnHandle());
+      NimBLEDevice::startAdvertising();
+      if (_owner) _owner->_woke();
+    }
+
     // Optional in some versions:
     void onMTUChange(uint16_t mtu, ble_gap_conn_desc* desc) { (void)mtu; (void)desc; }
+
+    void onMTUChange(uint16_t mtu, NimBLEConnInfo& info) {
+      if (_owner) _owner->_peerUp(info.getConnHandle(), mtu);
+    }
+
+    void onConnParamsUpdate(NimBLEConnInfo& info) {
+      if (!_owner) return;
+      _owner->_itvl = info.getConnInterval();
+      _owner->_latency = info.getConnLatency();
+    }
+
+    void onPhyUpdate(NimBLEConnInfo& info, uint8_t txPhy, uint8_t rxPhy) {
+      (void)info; (void)rxPhy;
+      if (_owner) _owner->_phy = txPhy;
+    }
+  private:
+    BleJournal* _owner = nullptr;
   };
 
+  // Negotiated MTU per connection (written from the NimBLE task).
+  struct Peer { uint16_t handle; uint16_t mtu; };
+  static constexpr uint8_t MAX_PEERS = 4;
+  static constexpr uint16_t MIN_PAYLOAD = 20;    // default ATT MTU 23 - 3
+  static constexpr uint16_t MAX_PAYLOAD = 514;   // ATT MTU 517 - 3
+
   // ---- Members ----
   NimBLEServer* _server = nullptr;
   NimBLECharacteristic* _cmd  = nullptr;
@@ -109,8 +271,83 @@ private:
 
   ServerCallbacks _serverCbs;
   CmdCallbacks    _cmdCbs;
+  TextCallbacks   _textCbs;
+  BleTxQueue      _tx;
 
   bool _advertising = false;
-  uint16_t _preferredMTU = 185;
+  uint16_t _preferredMTU = BLE_PREFERRED_MTU;
   OnCommand _onCommand;
+
+  // Inbound: NimBLE task produces, loop() consumes.
+  SpscQueue<BLE_RX_QUEUE_BYTES> _rx;
+  uint8_t  _rxMsg[MAX_PAYLOAD];
+  String   _rxLine;             // reused for delivery
+  uint32_t _rxWaits = 0;        // producer-only
+  void   (*_wake)() = nullptr;
+
+  void _woke() { if (_wake) _wake(); }
+
+  // Full queue: drop rather than hold up the stack (see BLE_RX_FULL_WAIT_US).
+  void _enqueue(const uint8_t* p, size_t n) {
+    if (n > sizeof(_rxMsg)) { _rx.drop(); return; }   // longer than any ATT write
+    if (_rx.push(p, n)) { _woke(); return; }
+    _woke();                    // loop() may be asleep with a full queue to drain
+#if BLE_RX_FULL_WAIT_US > 0
+    _rxWaits++;
+    for (uint32_t waited = 0; waited < BLE_RX_FULL_WAIT_US; waited += 50) {
+      delayMicroseconds(50);
+      if (_rx.push(p, n)) return;
+    }
+#endif
+    _rx.drop();
+  }
+
+  Peer    _peers[MAX_PEERS];
+  uint8_t _peerCount = 0;
+  std::atomic<uint16_t> _payload{ MIN_PAYLOAD };
+
+  // Connection parameters as last reported (written from the NimBLE task).
+  std::atomic<uint16_t> _itvl{ 0 };
+  std::atomic<uint16_t> _latency{ 0 };
+  std::atomic<uint8_t>  _phy{ BLE_GAP_LE_PHY_1M };
+
+  // Add or update a connection's MTU.
+  void _peerUp(uint16_t handle, uint16_t mtu) {
+    uint8_t i = 0;
+    while (i < _peerCount && _peers[i].handle != handle) ++i;
+    if (i == _peerCount) {
+      if (_peerCount == MAX_PEERS) return;
+      _peerCount++;
+    }
+    _peers[i] = Peer{ handle, mtu };
+    _recalcPayload();
+  }
+
+  // Forget a connection; with nobody left, queued bytes have no recipient.
+  void _peerDown(uint16_t handle) {
+    for (uint8_t i = 0; i < _peerCount; ++i) {
+      if (_peers[i].handle != handle) continue;
+      _peers[i] = _peers[--_peerCount];
+      break;
+    }
+    _recalcPayload();
+    if (_peerCount == 0) _tx.clear();
+  }
+
+  void _recalcPayload() {
+    uint16_t p = _peerCount ? MAX_PAYLOAD : MIN_PAYLOAD;
+    for (uint8_t i = 0; i < _peerCount; ++i) {
+      const uint16_t mp = _peers[i].mtu > 3 ? _peers[i].mtu - 3 : 0;
+      if (mp < p) p = mp;
+    }
+    _payload = p < MIN_PAYLOAD ? MIN_PAYLOAD : p;
+  }
+
+  void _pump() {
+    if (!_text) return;
+    _tx.pump(_payload.load(), [this](const uint8_t* d, size_t n) {
+      _text->setValue(d, n);
+      return _text->notify();
+    });
+  }
 };
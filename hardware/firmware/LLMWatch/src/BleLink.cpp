@@ -11,29 +11,100 @@ bool BleLink::begin(const char* deviceName, LineHandler onLine) {
   _onLine = std::move(onLine);
 
   // BleJournal already knows how to start advertising and receive text.
-  // We pass it a callback that forwards each inbound line to _onLine.
-  _ble->begin(deviceName, [this](const String& line) {
-    if (_onLine) _onLine(line);
+  // We pass it a callback that splits each write into lines for _onLine.
+  _ble->begin(deviceName, [this](const String& chunk) {
+    _onWrite(chunk.c_str(), chunk.length());
   });
   return true;
 }
 
+/// <summary>
+/// Split one GATT write into lines. Checks the mode after every line: a line
+/// that switches to binary framing may be followed by frames in the same write.
+/// </summary>
+void BleLink::_onWrite(const char* p, size_t n) {
+  if (!_raw && _rx.empty() && !memchr(p, '\n', n) && n < _ble->payloadSize()) {
+    _deliver(p, n);   // legacy host: one unterminated line per write
+    return;
+  }
+  while (n) {
+    if (_raw) { _deliver(p, n); return; }
+    bool done;
+    const size_t used = _rx.push(p, n, done);
+    p += used;
+    n -= used;
+    if (done) {
+      _deliver(_rx.line(), _rx.length());
+      _rx.next();
+    }
+  }
+}
+
+/// <summary>Hand one line (or raw chunk) up without allocating once warm.</summary>
+void BleLink::_deliver(const char* p, size_t n) {
+  if (!_onLine) return;
+  _line = "";
+  _line.concat(p, n);
+  _onLine(_line);
+}
+
+/// <summary>Switch between line splitting and raw pass-through.</summary>
+void BleLink::setRaw(bool on) {
+  _raw = on;
+  _rx.reset();
+}
+
 /// <summary>Let BleJournal do background work each loop().</summary>
 void BleLink::loop() {
   _ble->loop();
 }
 
-/// <summary>Send one line out over BLE.</summary>
-void BleLink::sendLine(const String& line) {
-  _ble->notifyText(line);
+/// <summary>Queue one line out over BLE.</summary>
+bool BleLink::sendLine(const String& line, TxPrio prio) {
+  return _ble->notifyLine(line, prio);
 }
 
-/// <summary>
-/// If BleJournal has a real connectivity check, call it here.
-/// If not, return true so the UI doesn't get stuck.
-/// </summary>
+/// <summary>Queue raw bytes out over BLE.</summary>
+bool BleLink::sendBytes(const uint8_t* data, size_t len, TxPrio prio) {
+  return _ble->notifyBytes(data, len, prio, true);   // frames are self-delimiting
+}
+
+/// <summary>Live notification payload size from BleJournal.</summary>
+size_t BleLink::payloadSize() const {
+  return _ble->payloadSize();
+}
+
+/// <summary>Free space in one TX priority class.</summary>
+size_t BleLink::txFree(TxPrio prio) const {
+  return _ble->txFree(prio);
+}
+
+/// <summary>Free space in the inbound write queue.</summary>
+size_t BleLink::rxFree() const {
+  return _ble->rxFree();
+}
+
+/// <summary>Notified payload bytes, from the TX queue counters.</summary>
+uint32_t BleLink::txBytes() const {
+  return _ble->txStats().bytes;
+}
+
+/// <summary>Forward a connection parameter request to BleJournal.</summary>
+bool BleLink::requestParams(const LinkProfile::Params& p) {
+  return _ble->requestParams(p);
+}
+
+/// <summary>Connection interval the central granted.</summary>
+uint16_t BleLink::connInterval() const {
+  return _ble->connInterval();
+}
+
+/// <summary>Slave latency the central granted.</summary>
+uint16_t BleLink::connLatency() const {
+  return _ble->connLatency();
+}
+
+/// <summary>Ask BleJournal whether a central is connected.</summary>
 bool BleLink::isConnected() const {
-  // If you add BleJournal::isConnected(), switch to that:
-  // return _ble->isConnected();
-  return true;
+  return _ble->isConnected();
 }
@@ -1,6 +1,9 @@
 #pragma once
 #include <Arduino.h>
 #include <functional>
+#include "BleTxQueue.hpp"
+#include "LineAssembler.hpp"
+#include "LinkProfile.hpp"
 
 /// <summary>
 /// Simple "line in / line out" BLE adapter so the rest of your code
@@ -25,6 +28,9 @@ public:
 
   /// <summary>
   /// Starts BLE and sets the function that should receive lines from the phone/host.
+  /// Inbound writes are split on '\n': one write may carry many lines, and a
+  /// line may span writes (up to BLE_RX_LINE_MAX bytes). A short write with
+  /// no newline at all still counts as one line, for hosts that predate this.
   /// </summary>
   bool begin(const char* deviceName, LineHandler onLine);
 
@@ -34,16 +40,64 @@ public:
   void loop();
 
   /// <summary>
-  /// Sends one line to the phone/host. The phone can split on newlines.
+  /// Queues one line for the phone/host, newline-terminated. Lines (and
+  /// frames from sendBytes) are packed into shared notifications, so the
+  /// phone must split on newlines rather than on notification boundaries.
+  /// Never blocks; returns false if that priority class is full.
   /// </summary>
-  void sendLine(const String& line);
+  bool sendLine(const String& line, TxPrio prio = TxPrio::Normal);
+
+  /// <summary>
+  /// Queues raw bytes (binary protocol frames). Same path as sendLine, but
+  /// does not stop at NUL bytes.
+  /// </summary>
+  bool sendBytes(const uint8_t* data, size_t len, TxPrio prio = TxPrio::Normal);
+
+  /// <summary>
+  /// Bytes one notification carries on the current link (ATT MTU - 3).
+  /// </summary>
+  size_t payloadSize() const;
+
+  /// <summary>Bytes a message of this class can still queue (see BleTxQueue::free).</summary>
+  size_t txFree(TxPrio prio) const;
+
+  /// <summary>Bytes the inbound write queue can still take before writes wait or drop.</summary>
+  size_t rxFree() const;
+
+  /// <summary>Payload bytes handed to the stack so far (all classes).</summary>
+  uint32_t txBytes() const;
+
+  /// <summary>
+  /// Ask the central for these connection parameters (see LinkProfile).
+  /// Only a request; connInterval()/connLatency() show what it granted.
+  /// </summary>
+  bool requestParams(const LinkProfile::Params& p);
+
+  /// <summary>Granted connection interval (1.25 ms units) and slave latency.</summary>
+  uint16_t connInterval() const;
+  uint16_t connLatency() const;
 
   /// <summary>
   /// Returns true if we believe a central is connected (best effort).
   /// </summary>
   bool isConnected() const;
 
+  /// <summary>
+  /// Raw mode hands every write up as is (binary frames reassemble
+  /// themselves). Switching either way drops any partial line.
+  /// </summary>
+  void setRaw(bool on);
+
+  /// <summary>Inbound reassembly counters.</summary>
+  const LineAssembler::Stats& rxStats() const { return _rx.stats(); }
+
 private:
   BleJournal* _ble;        // pointer to your real BLE service (not owned)
   LineHandler _onLine;     // callback to deliver one complete line up to the app
+  LineAssembler _rx;       // partial line carried between writes
+  String _line;            // reused for delivery
+  bool _raw = false;
+
+  void _onWrite(const char* p, size_t n);
+  void _deliver(const char* p, size_t n);
 };
@@ -0,0 +1,311 @@
+#pragma once
+// Prioritized, non-blocking transmit queue for BLE notifications.
+// Messages are stored whole ([len:2][bytes]) in one byte ring per class and
+// drained in notification-sized pieces as the stack has room. A higher class
+// overtakes a lower one only between messages, never inside one, so text
+// lines and ProtoV2 frames that span notifications stay contiguous.
+// Messages pushed as packable (self-delimiting: newline-terminated lines,
+// ProtoV2 frames) share notifications; a partly filled one is held for at
+// most BLE_TX_FLUSH_MS in case more arrive.
+// C# tether: a Channel<T> per priority with a single reader.
+
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+
+// Ring sizes per class (bytes, including 2 bytes of framing per message).
+#ifndef BLE_TX_CONTROL_BYTES
+#define BLE_TX_CONTROL_BYTES 256
+#endif
+#ifndef BLE_TX_NORMAL_BYTES
+#define BLE_TX_NORMAL_BYTES 1024
+#endif
+#ifndef BLE_TX_BULK_BYTES
+#define BLE_TX_BULK_BYTES 4096
+#endif
+// Notifications handed to the stack but not yet reported sent (≈ host mbufs).
+#ifndef BLE_TX_INFLIGHT
+#define BLE_TX_INFLIGHT 6
+#endif
+// How long a partly filled notification of packable messages may wait (0 = never).
+#ifndef BLE_TX_FLUSH_MS
+#define BLE_TX_FLUSH_MS 4
+#endif
+
+/// Priority classes, highest first.
+enum class TxPrio : uint8_t {
+  Control = 0,   // ACK / NACK / PING / PONG: tiny and latency-sensitive
+  Normal  = 1,   // standalone commands and replies
+  Bulk    = 2,   // DATA and anything sequenced with it (PROMPT/BODY headers, BODY_END)
+};
+
+// Fixed-capacity byte FIFO (no heap).
+template <size_t N>
+class ByteRing {
+public:
+  size_t used() const { return _used; }
+  size_t free() const { return N - _used; }
+
+  void push(const uint8_t* p, size_t n) {
+    const size_t first = (n < N - _tail) ? n : N - _tail;
+    memcpy(_buf + _tail, p, first);
+    memcpy(_buf, p + first, n - first);
+    _tail = (_tail + n) % N;
+    _used += n;
+  }
+  // Copy n bytes starting `off` bytes past the head, without consuming.
+  void peek(size_t off, uint8_t* out, size_t n) const {
+    const size_t at = (_head + off) % N;
+    const size_t first = (n < N - at) ? n : N - at;
+    memcpy(out, _buf + at, first);
+    memcpy(out + first, _buf, n - first);
+  }
+  void pop(size_t n) { _head = (_head + n) % N; _used -= n; }
+
+private:
+  uint8_t _buf[N];
+  size_t _head = 0, _tail = 0, _used = 0;
+};
+
+class BleTxQueue {
+public:
+  static constexpr uint8_t CLASSES = 3;
+
+  struct Stats {
+    uint16_t depth[CLASSES];       // messages waiting per class
+    uint16_t depthBytes[CLASSES];  // bytes waiting per class
+    uint16_t highWater[CLASSES];   // max bytes ever waiting per class
+    uint32_t queued;               // messages accepted
+    uint32_t packed;               // messages that shared a notification with another
+    uint32_t notifies;             // notifications handed to the stack
+    uint32_t bytes;                // payload bytes handed to the stack
+    uint32_t drops;                // messages rejected: class ring full / too large
+    uint32_t backpressure;         // drain stopped: no credits or notify() refused
+  };
+
+  // Queue one message. Never blocks; false (and a drop) if the class is full.
+  // `pack`: the receiver can find message boundaries itself, so this message
+  // may share a notification with its neighbours.
+  bool push(TxPrio prio, const uint8_t* data, size_t n, bool pack = false) {
+    return push(prio, data, n, nullptr, 0, pack);
+  }
+
+  // Same, for a message gathered from two pieces (e.g. a line and its '\n').
+  bool push(TxPrio prio, const uint8_t* data, size_t dn, const uint8_t* tail, size_t tn, bool pack) {
+    std::lock_guard<std::mutex> lock(_mu);
+    const uint8_t c = (uint8_t)prio;
+    const size_t n = dn + tn;
+    if (n == 0) return true;
+    if (n > LEN_MASK || _free(c) < n + 2) { _drops++; return false; }
+    if (!_depth[0] && !_depth[1] && !_depth[2]) _holdSinceMs = millis();
+    const uint16_t w = (uint16_t)n | (pack ? PACK_BIT : 0);
+    const uint8_t hdr[2] = { (uint8_t)(w & 0xFF), (uint8_t)(w >> 8) };
+    _push(c, hdr, 2);
+    _push(c, data, dn);
+    if (tn) _push(c, tail, tn);
+    _depth[c]++;
+    _queued++;
+    const size_t used = _used(c);
+    if (used > _highWater[c]) _highWater[c] = (uint16_t)used;
+    return true;
+  }
+
+  // Drain as far as credits allow. send(data, n) hands one notification to
+  // the stack and returns false if it was refused (congestion). Safe to call
+  // from any context; a call made while another drain runs returns at once.
+  template <typename Send>
+  void pump(size_t maxChunk, Send&& send) {
+    if (_draining.test_and_set()) return;
+    _recoverCredits();
+    uint8_t chunk[MAX_CHUNK];
+    if (maxChunk > sizeof(chunk)) maxChunk = sizeof(chunk);
+
+    for (;;) {
+      if (_credits.load() <= 0) { if (_hasData()) _backpressure++; break; }
+
+      Plan plan;
+      uint32_t gen;
+      {
+        std::lock_guard<std::mutex> lock(_mu);
+        if (!_plan(maxChunk, chunk, plan)) break;
+        gen = _gen;
+      }
+
+      _credits--;
+      _lastSendMs = millis();
+      if (!send(chunk, plan.bytes)) { _credits++; _backpressure++; break; }
+      _notifies++;
+      _bytes += (uint32_t)plan.bytes;
+
+      std::lock_guard<std::mutex> lock(_mu);
+      if (gen != _gen) continue;  // cleared while we were sending
+      _commit(plan);
+    }
+    _draining.clear();
+  }
+
+  // Stack reported a notification as sent (or failed): return its credit.
+  void onSent() {
+    if (_credits.load() < BLE_TX_INFLIGHT) _credits++;
+  }
+
+  // Connection dropped: queued bytes would go to the next central, so discard.
+  void clear() {
+    std::lock_guard<std::mutex> lock(_mu);
+    for (uint8_t c = 0; c < CLASSES; ++c) { _pop(c, _used(c)); _depth[c] = 0; }
+    _curCls = NONE;
+    _curLen = _curOff = 0;   // the next message starts at its first byte
+    _curPack = false;
+    _credits = BLE_TX_INFLIGHT;
+    _gen++;
+  }
+
+  bool empty() const { return _depth[0] == 0 && _depth[1] == 0 && _depth[2] == 0; }
+
+  // Time until pump() has something to do on its own (0 = now): the end of
+  // a flush hold, or of CREDIT_TIMEOUT_MS when completions stopped. UINT32_MAX
+  // when empty, or when only a completion (onSent) can move things on.
+  uint32_t msUntilDue(uint32_t nowMs) const {
+    if (!_hasData()) return UINT32_MAX;
+    const bool starved = _credits.load() <= 0;
+    const uint32_t since = nowMs - (starved ? _lastSendMs : _holdSinceMs);
+    const uint32_t wait = starved ? CREDIT_TIMEOUT_MS : BLE_TX_FLUSH_MS;
+    return since >= wait ? 0 : wait - since;
+  }
+
+  // Bytes a message of class `prio` can still use (after framing).
+  size_t free(TxPrio prio) const {
+    std::lock_guard<std::mutex> lock(_mu);
+    const size_t f = _free((uint8_t)prio);
+    return f > 2 ? f - 2 : 0;
+  }
+
+  Stats stats() const {
+    std::lock_guard<std::mutex> lock(_mu);
+    Stats s{};
+    for (uint8_t c = 0; c < CLASSES; ++c) {
+      s.depth[c] = _depth[c];
+      s.depthBytes[c] = (uint16_t)_used(c);
+      s.highWater[c] = _highWater[c];
+    }
+    s.queued = _queued; s.packed = _packed; s.notifies = _notifies; s.bytes = _bytes;
+    s.drops = _drops; s.backpressure = _backpressure;
+    return s;
+  }
+
+private:
+  static constexpr uint8_t  NONE = 0xFF;
+  static constexpr uint16_t PACK_BIT = 0x8000;        // in the stored length word
+  static constexpr size_t   LEN_MASK = 0x7FFF;
+  static constexpr uint8_t  MAX_STEPS = 32;           // messages finished per notification
+  static constexpr size_t   MAX_CHUNK = 514;          // ATT MTU 517 - 3
+  static constexpr uint32_t CREDIT_TIMEOUT_MS = 200;  // no completion seen: assume they were lost
+
+  ByteRing<BLE_TX_CONTROL_BYTES> _ctl;
+  ByteRing<BLE_TX_NORMAL_BYTES>  _norm;
+  ByteRing<BLE_TX_BULK_BYTES>    _bulk;
+  mutable std::mutex _mu;
+  std::atomic_flag   _draining = ATOMIC_FLAG_INIT;
+  std::atomic<int>   _credits{ BLE_TX_INFLIGHT };
+  uint32_t _lastSendMs = 0;
+  uint32_t _holdSinceMs = 0;  // when the queue last went from empty to non-empty
+  uint32_t _gen = 0;   // bumped by clear()
+
+  // Message currently being sent (preemption only when none is).
+  uint8_t  _curCls = NONE;
+  size_t   _curLen = 0;
+  size_t   _curOff = 0;
+  bool     _curPack = false;
+
+  // What one notification will take off the queue; applied only once sent.
+  struct Plan {
+    size_t  bytes = 0;
+    uint8_t done = 0;             // whole messages finished (popped)
+    uint8_t doneCls[MAX_STEPS];
+    size_t  doneLen[MAX_STEPS];
+    uint8_t cls = NONE;           // message left partly sent, if any
+    size_t  len = 0, off = 0;
+    bool    pack = false;
+  };
+
+  uint16_t _depth[CLASSES] = { 0, 0, 0 };
+  uint16_t _highWater[CLASSES] = { 0, 0, 0 };
+  uint32_t _queued = 0, _packed = 0, _notifies = 0, _bytes = 0, _drops = 0, _backpressure = 0;
+
+  size_t _used(uint8_t c) const { return c == 0 ? _ctl.used() : c == 1 ? _norm.used() : _bulk.used(); }
+  size_t _free(uint8_t c) const { return c == 0 ? _ctl.free() : c == 1 ? _norm.free() : _bulk.free(); }
+  void _push(uint8_t c, const uint8_t* p, size_t n) { if (c == 0) _ctl.push(p, n); else if (c == 1) _norm.push(p, n); else _bulk.push(p, n); }
+  void _peek(uint8_t c, size_t off, uint8_t* o, size_t n) const { if (c == 0) _ctl.peek(off, o, n); else if (c == 1) _norm.peek(off, o, n); else _bulk.peek(off, o, n); }
+  void _pop(uint8_t c, size_t n) { if (c == 0) _ctl.pop(n); else if (c == 1) _norm.pop(n); else _bulk.pop(n); }
+
+  bool _hasData() const {
+    std::lock_guard<std::mutex> lock(_mu);
+    return _depth[0] || _depth[1] || _depth[2];
+  }
+
+  // Next message to send: the current one, else the head of the highest
+  // non-empty class. `skip[c]` bytes of class c are already in this plan.
+  bool _head(const size_t skip[CLASSES], uint8_t& c, size_t& len, bool& pack) const {
+    for (c = 0; c < CLASSES; ++c) {
+      if (_used(c) <= skip[c]) continue;
+      uint8_t hdr[2];
+      _peek(c, skip[c], hdr, 2);
+      const uint16_t w = (uint16_t)(hdr[0] | (hdr[1] << 8));
+      len = w & LEN_MASK;
+      pack = (w & PACK_BIT) != 0;
+      return true;
+    }
+    return false;
+  }
+
+  // Fill `out` with the next notification. Packable messages are appended
+  // back to back; anything else travels alone. Returns false if there is
+  // nothing to send yet (empty, or a partial notification still within its
+  // flush deadline).
+  bool _plan(size_t maxChunk, uint8_t* out, Plan& p) {
+    size_t skip[CLASSES] = { 0, 0, 0 };
+    uint8_t c = _curCls;
+    size_t len = _curLen, off = _curOff;
+    bool pack = _curPack;
+    if (c == NONE && !_head(skip, c, len, pack)) return false;
+
+    for (;;) {
+      const size_t left = len - off;
+      const size_t room = maxChunk - p.bytes;
+      const size_t k = left < room ? left : room;
+      _peek(c, skip[c] + 2 + off, out + p.bytes, k);
+      p.bytes += k;
+      if (k < left) {                       // notification full mid-message
+        p.cls = c; p.len = len; p.off = off + k; p.pack = pack;
+        return true;
+      }
+      p.doneCls[p.done] = c;
+      p.doneLen[p.done] = len;
+      p.done++;
+      skip[c] += 2 + len;
+      if (!pack || p.bytes == maxChunk || p.done == MAX_STEPS) return true;
+
+      // Room left: only another packable message may share it.
+      uint8_t nc; size_t nlen; bool npack;
+      if (!_head(skip, nc, nlen, npack)) break;
+      if (!npack) return true;
+      c = nc; len = nlen; off = 0; pack = npack;
+    }
+    // Queue drained into a partly filled notification: wait a little for more.
+    return !(BLE_TX_FLUSH_MS > 0 && millis() - _holdSinceMs < BLE_TX_FLUSH_MS);
+  }
+
+  void _commit(const Plan& p) {
+    for (uint8_t i = 0; i < p.done; ++i) {
+      _pop(p.doneCls[i], 2 + p.doneLen[i]);
+      _depth[p.doneCls[i]]--;
+    }
+    if (p.done > 1) _packed += p.done;
+    _curCls = p.cls; _curLen = p.len; _curOff = p.off; _curPack = p.pack;
+  }
+
+  // Completions can be lost (e.g. on disconnect); don't stall forever.
+  void _recoverCredits() {
+    if (_credits.load() <= 0 && millis() - _lastSendMs >= CREDIT_TIMEOUT_MS) _credits = BLE_TX_INFLIGHT;
+  }
+};
@@ -0,0 +1,56 @@
+#pragma once
+// When each boot stage finished, in µs since reset (or since the last
+// reset() call, which a bench uses to stand in for one), so the cost of a stage and the time to the first advertisement / frame
+// can be read off one line. One slot per stage, each written once by the
+// task that finished it (the FS mount runs on a task of its own).
+// C# tether: a Stopwatch with named laps, logged once at startup.
+
+#include <Arduino.h>
+#include <atomic>
+
+class BootTimeline {
+public:
+  enum Stage : uint8_t {
+    Setup = 0,   // setup() entered (ROM + bootloader + core init before it)
+    Ble,         // advertising
+    Oled,        // panel initialised
+    Fs,          // LittleFS mounted, journal scanned
+    Ready,       // setup() returned; loop() serves commands
+    Frame,       // first frame handed to the panel
+    STAGES
+  };
+
+  void mark(Stage s) {
+    if (s < STAGES && !_at[s].load(std::memory_order_relaxed)) _at[s].store(micros() | 1, std::memory_order_release);
+  }
+
+  void reset() {
+    for (auto& a : _at) a.store(0, std::memory_order_relaxed);
+    _origin = micros() & ~1u;   // even, like the stamps once their done bit is dropped
+  }
+
+  bool done(Stage s) const   { return s < STAGES && _at[s].load(std::memory_order_acquire); }
+  // µs from reset to the stage; 0 also when not reached (see done()).
+  uint32_t us(Stage s) const {
+    const uint32_t t = s < STAGES ? _at[s].load(std::memory_order_acquire) : 0;
+    return t ? (t & ~1u) - _origin : 0;
+  }
+
+  // "BOOT reason=<r> setup@<us> ble@<us>(+<since setup>) ... frame-" (- = not reached).
+  size_t format(char* out, size_t cap, int reason) const {
+    static const char* const names[STAGES] = { "setup", "ble", "oled", "fs", "ready", "frame" };
+    int n = snprintf(out, cap, "BOOT reason=%d", reason);
+    const uint32_t t0 = us(Setup);
+    for (uint8_t s = 0; s < STAGES && n > 0 && (size_t)n < cap; ++s) {
+      const uint32_t t = us((Stage)s);
+      n += !done((Stage)s) ? snprintf(out + n, cap - n, " %s-", names[s])
+         : s               ? snprintf(out + n, cap - n, " %s@%lu(+%lu)", names[s], (unsigned long)t, (unsigned long)(t - t0))
+                           : snprintf(out + n, cap - n, " %s@%lu", names[s], (unsigned long)t);
+    }
+    return n > 0 ? ((size_t)n < cap ? (size_t)n : cap - 1) : 0;
+  }
+
+private:
+  std::atomic<uint32_t> _at[STAGES] = {};   // micros(); low bit set so a stage at micros() == 0 still counts as done
+  uint32_t _origin = 0;                      // micros() at reset: 0 on the device
+};
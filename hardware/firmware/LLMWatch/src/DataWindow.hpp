@@ -0,0 +1,168 @@
+#pragma once
+// Sliding-window delivery for the DATA chunks of one PROMPT/BODY stream.
+// The sender numbers chunks from 0 and keeps up to PROTO_DATA_WINDOW of them
+// until the receiver's SACK covers them; the receiver delivers in order,
+// parks early chunks, and answers with (cum, mask): every seq below cum
+// arrived, and bit i of mask says cum + 1 + i arrived too. A hole below a
+// SACKed chunk is resent at most once per round trip; the oldest chunk is
+// also resent on a timeout (doubling per resend), so a lost SACK heals.
+// C# tether: TCP's send/receive buffers with SACK, shrunk to a few slots.
+
+#include <Arduino.h>
+
+#ifndef PROTO_DATA_WINDOW
+#define PROTO_DATA_WINDOW 8       // chunks in flight per stream (<= 32)
+#endif
+#ifndef PROTO_DATA_SLOT
+#define PROTO_DATA_SLOT 240       // largest sequenced chunk, bytes
+#endif
+static_assert(PROTO_DATA_WINDOW >= 1 && PROTO_DATA_WINDOW <= 32, "PROTO_DATA_WINDOW must be 1..32");
+
+namespace DataWindow {
+
+constexpr uint8_t WINDOW = PROTO_DATA_WINDOW;
+
+struct Chunk {
+  uint16_t len;
+  bool     nl;                    // v1: the chunk ended at a newline the line ending ate
+  uint8_t  data[PROTO_DATA_SLOT];
+};
+
+class Sender {
+public:
+  struct Stats {
+    uint32_t chunks;              // chunks pushed
+    uint32_t fastResends;         // holes a SACK revealed
+    uint32_t timeoutResends;
+    uint32_t sacks;
+    uint8_t  inFlight;
+  };
+
+  void reset() { _base = _next = 0; _sacked = 0; }
+
+  // Another chunk fits a window of win (<= WINDOW; the peer may offer less).
+  bool     room(uint8_t win = WINDOW) const { return _next - _base < win; }
+  bool     empty() const  { return _next == _base; }
+  uint32_t next() const   { return _next; }
+
+  // Keep a chunk and return its seq; the caller sends it. Needs room().
+  uint32_t push(const uint8_t* p, size_t n, bool nl, uint32_t nowMs) {
+    Slot& s = _slot[_next % WINDOW];
+    s.c.len = (uint16_t)n;
+    s.c.nl = nl;
+    memcpy(s.c.data, p, n);
+    s.sentMs = nowMs;
+    s.sends = 1;
+    _stats.chunks++;
+    return _next++;
+  }
+
+  // Apply a SACK. resend(seq, const Chunk&) for holes below the highest
+  // chunk it reports, unless that chunk went out less than gapMs ago.
+  template <typename Resend>
+  void sack(uint32_t cum, uint32_t mask, uint32_t nowMs, uint32_t gapMs, Resend&& resend) {
+    if ((int32_t)(cum - _base) < 0 || (int32_t)(cum - _next) > 0) return;   // stale, or from another stream
+    _stats.sacks++;
+    _sacked >>= (cum - _base) < 32 ? (cum - _base) : 31;
+    if (cum - _base >= 32) _sacked = 0;
+    _base = cum;
+    _sacked |= mask << 1;                 // bit k: _base + k arrived (bit 0 never, it is the hole)
+    uint32_t top = 0;
+    for (uint32_t k = 1; k < WINDOW && _base + k < _next; ++k) if (_sacked & (1u << k)) top = k;
+    for (uint32_t k = 0; k < top; ++k) {
+      if (_sacked & (1u << k)) continue;
+      Slot& s = _slot[(_base + k) % WINDOW];
+      if (nowMs - s.sentMs < gapMs) continue;
+      s.sentMs = nowMs;
+      s.sends++;
+      _stats.fastResends++;
+      resend(_base + k, s.c);
+    }
+  }
+
+  // Resend the oldest unacknowledged chunk once its timeout passed.
+  template <typename Resend>
+  void tick(uint32_t nowMs, uint32_t rtoMs, Resend&& resend) {
+    if (empty()) return;
+    Slot& s = _slot[_base % WINDOW];
+    const uint32_t wait = rtoMs << (s.sends - 1 < 4 ? s.sends - 1 : 4);
+    if (nowMs - s.sentMs < wait) return;
+    s.sentMs = nowMs;
+    if (s.sends < 0xFF) s.sends++;
+    _stats.timeoutResends++;
+    resend(_base, s.c);
+  }
+
+  Stats stats() const { Stats s = _stats; s.inFlight = (uint8_t)(_next - _base); return s; }
+
+private:
+  struct Slot { Chunk c; uint32_t sentMs; uint8_t sends; };
+  Slot     _slot[WINDOW];
+  uint32_t _base = 0, _next = 0;  // [base, next) in flight
+  uint32_t _sacked = 0;           // bit k: _base + k is known to have arrived
+  Stats    _stats{};
+};
+
+class Receiver {
+public:
+  struct Stats {
+    uint32_t chunks;              // accepted (delivered or parked)
+    uint32_t outOfOrder;          // parked ahead of a hole
+    uint32_t duplicates;
+    uint32_t beyondWindow;        // dropped: too far ahead
+  };
+
+  void reset() { _next = 0; _have = 0; _unacked = false; }
+
+  // Take chunk seq; deliver(const uint8_t*, size_t, bool nl) is called for
+  // every chunk that is now in order. Returns true when the sender should
+  // hear about it at once (a hole or a duplicate), not just eventually.
+  template <typename Deliver>
+  bool accept(uint32_t seq, const uint8_t* p, size_t n, bool nl, Deliver&& deliver) {
+    _unacked = true;
+    if ((int32_t)(seq - _next) < 0) { _stats.duplicates++; return true; }
+    const uint32_t k = seq - _next;
+    if (k >= WINDOW || n > PROTO_DATA_SLOT) { _stats.beyondWindow++; return true; }
+    if (k > 0) {
+      if (_have & (1u << k)) { _stats.duplicates++; return true; }
+      Chunk& c = _park[seq % WINDOW];
+      c.len = (uint16_t)n;
+      c.nl = nl;
+      memcpy(c.data, p, n);
+      _have |= 1u << k;
+      _stats.chunks++;
+      _stats.outOfOrder++;
+      return true;
+    }
+    _stats.chunks++;
+    deliver(p, n, nl);
+    _next++;
+    _have >>= 1;
+    while (_have & 1u) {
+      const Chunk& c = _park[_next % WINDOW];
+      deliver(c.data, (size_t)c.len, c.nl);
+      _next++;
+      _have >>= 1;
+    }
+    return _have != 0;
+  }
+
+  // SACK contents: all below cum() arrived; bit i of mask(): cum() + 1 + i did.
+  uint32_t cum() const  { return _next; }
+  uint32_t mask() const { return _have >> 1; }
+
+  // Chunks arrived since the last SACK went out.
+  bool unacked() const  { return _unacked; }
+  void acked()          { _unacked = false; }
+
+  const Stats& stats() const { return _stats; }
+
+private:
+  Chunk    _park[WINDOW];
+  uint32_t _next = 0;             // next in-order seq
+  uint32_t _have = 0;             // bit k: _next + k is parked (bit 0 never set)
+  bool     _unacked = false;
+  Stats    _stats{};
+};
+
+} // namespace DataWindow
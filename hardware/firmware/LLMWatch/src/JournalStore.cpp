@@ -1 +1,1216 @@
-// Header-only implementation for now; keep this file to satisfy build systems if needed.
+#include "JournalStore.hpp"
+#include <time.h>
+
+namespace {
+  const char* const LEGACY_PATH = "/journal.txt";
+  const char* const LEGACY_BAK = "/journal.txt.bak";   // kept when the log could not take all of it
+  const char* const DIR = "/j";
+  constexpr size_t IDX_ENTRY = 12;
+  constexpr size_t DIG_ENTRY = 12;   // .dig: firstTs, lastTs, key sum of one group (all ones: lost)
+  constexpr size_t LZ_TRAILER = 22;
+  const char LZ_MAGIC[4] = { 'J', 'L', 'Z', '1' };
+
+  // CRC-32 (IEEE, reflected), nibble table: small and fast enough for headers + short lines.
+  uint32_t crc32(const uint8_t* p, size_t n, uint32_t crc = 0xFFFFFFFFu) {
+    static const uint32_t T[16] = {
+      0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+      0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    for (size_t i = 0; i < n; ++i) {
+      crc ^= p[i];
+      crc = (crc >> 4) ^ T[crc & 15];
+      crc = (crc >> 4) ^ T[crc & 15];
+    }
+    return crc;
+  }
+
+  void put16(uint8_t* p, uint32_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+  void put32(uint8_t* p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+  uint32_t get16(const uint8_t* p)   { return (uint32_t)p[0] | ((uint32_t)p[1] << 8); }
+  uint32_t get32(const uint8_t* p)   { return get16(p) | (get16(p + 2) << 16); }
+
+  // Words for the search filters: runs of ASCII letters/digits (UTF-8 bytes
+  // count as letters), ASCII-lowercased, hashed with FNV-1a. Fed in pieces so
+  // a record can be indexed or matched as it streams past; onWord(hash, word,
+  // len) gets the first WORD_MAX bytes of each word and its full length.
+  constexpr size_t WORD_MAX = 32;
+  struct Words {
+    uint32_t h = 2166136261u;
+    size_t   len = 0;
+    char     w[WORD_MAX];
+
+    template <typename F>
+    void feed(const uint8_t* p, size_t n, F&& onWord) {
+      for (size_t i = 0; i < n; ++i) {
+        uint8_t c = p[i];
+        const bool letter = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+        if (letter) {
+          if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+          h = (h ^ c) * 16777619u;
+          if (len < WORD_MAX) w[len] = (char)c;
+          len++;
+        } else if (len) {
+          onWord(h, w, len);
+          h = 2166136261u;
+          len = 0;
+        }
+      }
+    }
+    template <typename F>
+    void end(F&& onWord) {
+      if (len) onWord(h, w, len);
+      h = 2166136261u;
+      len = 0;
+    }
+  };
+
+  // Three bits per word by double hashing.
+  constexpr uint32_t BLOOM_BITS = JOURNAL_BLOOM_BYTES * 8;
+  uint32_t bloomBit(uint32_t h, uint8_t k) {
+    const uint32_t h2 = ((h >> 17) | (h << 15)) | 1;
+    return (h + k * h2) % BLOOM_BITS;
+  }
+  void bloomAdd(uint8_t* f, uint32_t h) {
+    for (uint8_t k = 0; k < 3; ++k) { const uint32_t b = bloomBit(h, k); f[b >> 3] |= (uint8_t)(1u << (b & 7)); }
+  }
+  bool bloomHas(const uint8_t* f, uint32_t h) {
+    for (uint8_t k = 0; k < 3; ++k) { const uint32_t b = bloomBit(h, k); if (!(f[b >> 3] & (1u << (b & 7)))) return false; }
+    return true;
+  }
+
+  // "<8 hex>.<ext>" -> base; ext points at the extension.
+  bool parseBase(const char* name, uint32_t& base, const char*& ext) {
+    const char* slash = strrchr(name, '/');
+    if (slash) name = slash + 1;
+    if (strlen(name) < 10 || name[8] != '.') return false;
+    char* end = nullptr;
+    base = (uint32_t)strtoul(name, &end, 16);
+    ext = name + 9;
+    return end == name + 8;
+  }
+}
+
+uint32_t JournalStore::now() { return (uint32_t)time(nullptr); }
+
+void JournalStore::_segPath(char* out, uint32_t base, const char* ext) {
+  snprintf(out, 24, "%s/%08lx.%s", DIR, (unsigned long)base, ext);
+}
+
+uint32_t JournalStore::indexWords(uint8_t* filter, const char* s, size_t n) {
+  uint32_t words = 0;
+  auto add = [&](uint32_t h, const char*, size_t) { bloomAdd(filter, h); words++; };
+  Words w;
+  w.feed((const uint8_t*)s, n, add);
+  w.end(add);
+  return words;
+}
+
+size_t JournalStore::packEntry(uint8_t* out, uint32_t ts, const char* s, size_t n) {
+  put32(out, ts);
+  put16(out + 4, (uint32_t)n);
+  memcpy(out + BATCH_HDR, s, n);
+  return BATCH_HDR + n;
+}
+
+// ---------------- Mount ----------------
+
+bool JournalStore::begin() {
+  // true = format if mount fails (dev-friendly). For production, handle errors differently.
+  if (!LittleFS.begin(true)) return false;
+  if (!LittleFS.exists(DIR)) LittleFS.mkdir(DIR);
+
+  // Segment bases from the directory, oldest first; extras beyond retention go.
+  // An unfinished compaction (.lzt) is thrown away; its .seg is still there.
+  _compactAbort();
+  _cacheBlk = SIZE_MAX;
+  uint32_t bases[JOURNAL_MAX_SEGS * 2];
+  size_t nb = 0;
+  String stale;
+  File dir = LittleFS.open(DIR);
+  for (File f = dir.openNextFile(); f; f = dir.openNextFile()) {
+    uint32_t b;
+    const char* ext;
+    if (parseBase(f.name(), b, ext)) {
+      if (!strcmp(ext, "lzt")) stale = String(DIR) + "/" + f.name();
+      bool seen = false;
+      for (size_t i = 0; i < nb; ++i) seen |= bases[i] == b;
+      if (!seen && (!strcmp(ext, "seg") || !strcmp(ext, "lz")) && nb < sizeof(bases) / sizeof(bases[0])) bases[nb++] = b;
+    }
+    f.close();
+  }
+  dir.close();
+  if (stale.length()) LittleFS.remove(stale.c_str());
+  for (size_t i = 1; i < nb; ++i)
+    for (size_t j = i; j > 0 && bases[j - 1] > bases[j]; --j) std::swap(bases[j - 1], bases[j]);
+
+  _n = 0;
+  _mountScanned = 0;
+  _tornBytes = 0;
+  for (size_t i = 0; i < nb; ++i) {
+    char path[24];
+    if (nb - i > JOURNAL_MAX_SEGS) { _removeSegFiles(bases[i]); continue; }
+    Seg s;
+    if (_loadLz(bases[i], s)) {
+      _segPath(path, bases[i], "seg");
+      if (LittleFS.exists(path)) LittleFS.remove(path);   // compaction finished but for this
+      _segs[_n++] = s;
+    } else if (_loadSegment(bases[i], s)) {
+      _segs[_n++] = s;
+    }
+  }
+  for (uint8_t i = 0; i + 1 < _n; ++i) _segs[i].sealed = true;
+  if (_n && _segs[_n - 1].count == 0 && _segs[_n - 1].sealed) {   // nothing valid in it: reuse its base
+    _n--;
+    _nextSeq = _segs[_n].base;
+    _removeSegFiles(_segs[_n].base);
+  }
+  if (_n) _nextSeq = _segs[_n - 1].base + _segs[_n - 1].count;
+  _bloomOk = _n && _bloomBase == _segs[_n - 1].base && !_segs[_n - 1].table;
+  // A sealed tail gets its successor on the next append, so mounting never
+  // costs a retention drop.
+  if (!_n) _newSegment();
+
+  // One-time move of the flat file into the log (ts 0: unknown). It is
+  // removed only once every line is in the log; if retention cannot keep
+  // them all, or an append fails, it stays as LEGACY_BAK and legacyLost
+  // counts what is missing.
+  _legacyLost = 0;
+  if (LittleFS.exists(LEGACY_PATH)) {
+    const uint32_t from = _nextSeq;
+    uint32_t lines = 0;
+    bool ok = true;
+    File f = LittleFS.open(LEGACY_PATH, FILE_READ);
+    uint8_t batch[512];
+    size_t bn = 0;
+    String line;
+    auto flushLine = [&]() {
+      if (line.length() && line[line.length() - 1] == '\r') line.remove(line.length() - 1);
+      lines++;
+      if (BATCH_HDR + line.length() > sizeof(batch)) {
+        ok &= append(batch, bn); bn = 0;
+        ok &= appendLine(line.c_str(), line.length(), 0);
+      } else {
+        if (bn + BATCH_HDR + line.length() > sizeof(batch)) { ok &= append(batch, bn); bn = 0; }
+        bn += packEntry(batch + bn, 0, line.c_str(), line.length());
+      }
+      line = "";
+    };
+    uint8_t buf[256];
+    for (size_t n; (n = f.read(buf, sizeof(buf))) > 0; )
+      for (size_t i = 0; i < n; ++i) {
+        if (buf[i] == '\n') flushLine();
+        else line += (char)buf[i];
+      }
+    if (line.length()) flushLine();
+    if (bn) ok &= append(batch, bn);
+    f.close();
+    // Lines that never made it in, and ones retention already dropped again.
+    const uint32_t first = _firstSeq();
+    _legacyLost = lines - (_nextSeq - from) + (first > from ? std::min(first, _nextSeq) - from : 0);
+    if (ok && !_legacyLost) {
+      LittleFS.remove(LEGACY_PATH);
+    } else {
+      if (!_legacyLost) _legacyLost = 1;
+      if (LittleFS.exists(LEGACY_BAK)) LittleFS.remove(LEGACY_BAK);
+      LittleFS.rename(LEGACY_PATH, LEGACY_BAK);
+    }
+  }
+  return true;
+}
+
+// Find where a segment's valid records end: start at its last index entry
+// and walk (verifying CRCs) until a header does not check out.
+bool JournalStore::_loadSegment(uint32_t base, Seg& s) {
+  char path[24];
+  _segPath(path, base, "seg");
+  File probe = LittleFS.open(path, FILE_READ);
+  if (!probe) return false;
+  const size_t size = probe.size();
+  probe.close();
+  s = Seg{ base, 0, 0, 0, 0, false, 0, 0, 0, 0 };
+  SegIn f;
+  if (!f.open(*this, s)) return false;
+
+  IdxEntry from{ base, 0, 0 };
+  IdxEntry last;
+  uint32_t len, seq, ts;
+  if (_idxFloor(base, UINT32_MAX, false, last) && last.off < size &&
+      _readHdr(f, last.off, size, len, seq, ts, true) && seq == last.seq) from = last;
+  if (_readHdr(f, 0, size, len, seq, ts, false)) s.firstTs = ts;
+
+  // The walk starts at a group start, so it also rebuilds the open group's filter and digest.
+  size_t pos = from.off;
+  uint32_t next = from.seq;
+  _bloomBase = base;
+  for (;;) {
+    if ((next - base) % JOURNAL_INDEX_EVERY == 0) { memset(_bloom, 0, sizeof(_bloom)); _dig = JournalSync::Digest{}; }
+    uint32_t key;
+    if (!_readHdr(f, pos, size, len, seq, ts, true, _bloom, &key) || seq != next) break;
+    if (!_dig.count) _digFirstTs = ts;
+    _dig.add(key);
+    _digLastTs = ts;
+    _mountScanned++;
+    s.lastTs = ts;
+    pos += REC_HDR + len;
+    next++;
+  }
+  s.count = next - base;
+  s.bytes = (uint32_t)pos;
+  s.blooms = _bloomCount(base);
+  s.digests = _digestCount(base);
+  if (pos < size) { s.sealed = true; _tornBytes += (uint32_t)(size - pos); }
+  f.close();
+  return true;
+}
+
+// A compacted segment describes itself in its trailer; nothing to scan.
+bool JournalStore::_loadLz(uint32_t base, Seg& s) {
+  char path[24];
+  _segPath(path, base, "lz");
+  if (!LittleFS.exists(path)) return false;
+  File f = LittleFS.open(path, FILE_READ);
+  if (!f) return false;
+  const size_t size = f.size();
+  uint8_t t[LZ_TRAILER];
+  const bool ok = size >= LZ_TRAILER && f.seek(size - LZ_TRAILER) && f.read(t, LZ_TRAILER) == LZ_TRAILER &&
+                  !memcmp(t + 18, LZ_MAGIC, 4);
+  f.close();
+  const uint32_t blocks = ok ? get16(t + 16) : 0;
+  if (!ok || size < LZ_TRAILER + 4 * blocks) {    // torn while being finished: the .seg is authoritative
+    char seg[24];
+    _segPath(seg, base, "seg");
+    if (LittleFS.exists(seg)) LittleFS.remove(path);
+    return false;
+  }
+  s = Seg{ base, get32(t + 4), get32(t), get32(t + 8), get32(t + 12), true,
+           (uint32_t)(size - LZ_TRAILER - 4 * blocks), (uint32_t)size, _bloomCount(base), _digestCount(base) };
+  return true;
+}
+
+// ---------------- Append ----------------
+
+bool JournalStore::_newSegment() {
+  if (_n == JOURNAL_MAX_SEGS) _dropOldest();
+  char path[24];
+  _segPath(path, _nextSeq, "idx");
+  if (LittleFS.exists(path)) LittleFS.remove(path);     // left by a segment that held nothing valid
+  _segPath(path, _nextSeq, "seg");
+  File f = LittleFS.open(path, FILE_WRITE);
+  if (!f) return false;
+  f.close();
+  _segs[_n++] = Seg{ _nextSeq, 0, 0, 0, 0, false, 0, 0, 0, 0 };
+  memset(_bloom, 0, sizeof(_bloom));
+  _dig = JournalSync::Digest{};
+  _bloomBase = _nextSeq;
+  _bloomOk = true;
+  return true;
+}
+
+void JournalStore::_removeSegFiles(uint32_t base) {
+  static const char* const EXT[] = { "seg", "idx", "lz", "blm", "dig" };
+  char path[24];
+  for (const char* e : EXT) {
+    _segPath(path, base, e);
+    if (LittleFS.exists(path)) LittleFS.remove(path);
+  }
+}
+
+void JournalStore::_dropOldest() {
+  if (!_n) return;
+  if (_cz.active && _cz.base == _segs[0].base) _compactAbort();
+  if (_cacheBase == _segs[0].base) _cacheBlk = SIZE_MAX;
+  _removeSegFiles(_segs[0].base);
+  for (uint8_t i = 1; i < _n; ++i) _segs[i - 1] = _segs[i];
+  _n--;
+  _dropped++;
+}
+
+// Index entries collected during one append, written after the data is closed
+// so an entry never points at bytes that are not committed yet.
+struct JournalStore::Commit {
+  JournalStore& js;
+  File     f;
+  IdxEntry pend[8];
+  uint8_t  np = 0;
+  struct Group { uint32_t base, group, firstTs, lastTs, sum; uint8_t bits[JOURNAL_BLOOM_BYTES]; };
+  Group    groups[2];             // finished group filters + digests (a seal and a full group at most per put)
+  uint8_t  nb = 0;
+
+  explicit Commit(JournalStore& s) : js(s) {}
+  ~Commit() { close(); }
+
+  void close() {
+    if (f) f.close();
+    f = File();
+    for (uint8_t i = 0; i < nb; ++i) {
+      const Group& g = groups[i];
+      js._writeBloom(g.base, g.group, g.bits);
+      js._writeDigest(g.base, g.group, g.firstTs, g.lastTs, g.sum);
+    }
+    nb = 0;
+    if (!np) return;
+    char path[24];
+    _segPath(path, js._segs[js._n - 1].base, "idx");
+    File ix = LittleFS.open(path, FILE_APPEND);
+    if (ix) {
+      uint8_t e[IDX_ENTRY];
+      for (uint8_t i = 0; i < np; ++i) {
+        put32(e, pend[i].seq); put32(e + 4, pend[i].ts); put32(e + 8, pend[i].off);
+        ix.write(e, IDX_ENTRY);
+      }
+      ix.close();
+    }
+    np = 0;
+  }
+
+  void queueGroup(uint32_t base, uint32_t group) {
+    Group& g = groups[nb++];
+    g.base = base;
+    g.group = group;
+    g.firstTs = js._digFirstTs;
+    g.lastTs = js._digLastTs;
+    g.sum = js._dig.sum;
+    memcpy(g.bits, js._bloom, sizeof(js._bloom));
+  }
+
+  bool put(uint32_t ts, const char* s, size_t n) {
+    Seg* seg = &js._segs[js._n - 1];
+    if (nb == 2) close();
+    if (seg->sealed || (seg->count && seg->bytes + REC_HDR + n > JOURNAL_SEG_BYTES)) {
+      seg->sealed = true;
+      close();
+      // The open group's filter and digest go with the segment (if RAM still has them).
+      if (seg->count % JOURNAL_INDEX_EVERY && js._bloomOk && js._bloomBase == seg->base)
+        queueGroup(seg->base, (seg->count - 1) / JOURNAL_INDEX_EVERY);
+      if (!js._newSegment()) return false;
+      seg = &js._segs[js._n - 1];
+    }
+    if (np == sizeof(pend) / sizeof(pend[0])) close();
+    if (!f) {
+      char path[24];
+      _segPath(path, seg->base, "seg");
+      f = LittleFS.open(path, FILE_APPEND);
+      if (!f) return false;
+    }
+    uint8_t h[REC_HDR];
+    put16(h, (uint32_t)n);
+    put32(h + 2, js._nextSeq);
+    put32(h + 6, ts);
+    put32(h + 10, ~crc32((const uint8_t*)s, n, crc32(h, 10)));
+    if (f.write(h, REC_HDR) != REC_HDR || f.write((const uint8_t*)s, n) != n) {
+      // Short write (flash full): part of a record now follows seg->bytes.
+      // Nothing counts it, and the segment is sealed so the next record
+      // starts a new one, the same end a mount would find (tornBytes). An
+      // empty segment is truncated instead: its base is still the next seq.
+      close();
+      if (seg->count) {
+        seg->sealed = true;
+      } else {
+        char path[24];
+        _segPath(path, seg->base, "seg");
+        File t = LittleFS.open(path, FILE_WRITE);
+        if (t) t.close();
+      }
+      return false;
+    }
+    if ((js._nextSeq - seg->base) % JOURNAL_INDEX_EVERY == 0) pend[np++] = IdxEntry{ js._nextSeq, ts, seg->bytes };
+    if (!seg->count) seg->firstTs = ts;
+    seg->lastTs = ts;
+    seg->count++;
+    seg->bytes += (uint32_t)(REC_HDR + n);
+    js._nextSeq++;
+    if (js._bloomOk) {
+      indexWords(js._bloom, s, n);
+      if (!js._dig.count) js._digFirstTs = ts;
+      js._dig.add(JournalSync::key(ts, s, n));
+      js._digLastTs = ts;
+      if (seg->count % JOURNAL_INDEX_EVERY == 0) {
+        queueGroup(seg->base, (seg->count - 1) / JOURNAL_INDEX_EVERY);
+        memset(js._bloom, 0, sizeof(js._bloom));
+        js._dig = JournalSync::Digest{};
+      }
+    }
+    return true;
+  }
+};
+
+bool JournalStore::appendLine(const char* s, size_t n, uint32_t ts) {
+  if (n > MAX_LINE) return false;
+  Commit c(*this);
+  return c.put(ts, s, n);
+}
+
+bool JournalStore::append(const uint8_t* batch, size_t n) {
+  Commit c(*this);
+  for (size_t i = 0; i + BATCH_HDR <= n; ) {
+    const uint32_t ts = get32(batch + i);
+    const size_t len = get16(batch + i + 4);
+    if (i + BATCH_HDR + len > n) return false;
+    if (!c.put(ts, (const char*)batch + i + BATCH_HDR, len)) return false;
+    i += BATCH_HDR + len;
+  }
+  return true;
+}
+
+bool JournalStore::clear() {
+  _compactAbort();
+  while (_n) _dropOldest();
+  _dropped = 0;
+  return _newSegment();
+}
+
+// ---------------- Segment bytes (plain or compressed) ----------------
+
+bool JournalStore::SegIn::open(JournalStore& js, const Seg& s) {
+  close();
+  char path[24];
+  _segPath(path, s.base, s.table ? "lz" : "seg");
+  _f = LittleFS.open(path, FILE_READ);
+  _js = &js;
+  _base = s.base;
+  _table = s.table;
+  _fpos = SIZE_MAX;
+  return (bool)_f;
+}
+
+size_t JournalStore::SegIn::read(size_t pos, uint8_t* buf, size_t n) {
+  if (!_f) return 0;
+  if (!_table) {
+    if (pos != _fpos && !_f.seek(pos)) return 0;
+    const size_t got = _f.read(buf, n);
+    _fpos = pos + got;
+    return got;
+  }
+  size_t done = 0;
+  while (done < n) {
+    const size_t k = (pos + done) / JOURNAL_LZ_BLOCK;
+    if (!_block(k)) break;
+    const size_t at = (pos + done) % JOURNAL_LZ_BLOCK;
+    if (at >= _js->_cacheLen) break;
+    const size_t take = std::min(n - done, _js->_cacheLen - at);
+    memcpy(buf + done, _js->_cache + at, take);
+    done += take;
+  }
+  return done;
+}
+
+// Decode block k of this .lz into the store's cache (no-op if it is there).
+bool JournalStore::SegIn::_block(size_t k) {
+  JournalStore& js = *_js;
+  if (js._cacheBlk == k && js._cacheBase == _base) return true;
+  js._cacheBlk = SIZE_MAX;
+  uint8_t h[4];
+  if (!_f.seek(_table + 4 * k) || _f.read(h, 4) != 4) return false;
+  if (get32(h) >= _table || !_f.seek(get32(h)) || _f.read(h, 4) != 4) return false;
+  const size_t raw = get16(h), stored = get16(h + 2);
+  if (raw > JOURNAL_LZ_BLOCK) return false;
+  if (stored == raw) {
+    if (_f.read(js._cache, raw) != raw) return false;
+  } else {
+    uint8_t in[64];
+    size_t left = stored, have = 0, at = 0;
+    auto next = [&]() -> int {
+      if (at == have) {
+        if (!left) return -1;
+        have = _f.read(in, std::min(sizeof(in), left));
+        if (!have) { left = 0; return -1; }
+        left -= have;
+        at = 0;
+      }
+      return in[at++];
+    };
+    if (Lz::decode(next, js._cache, raw) != raw) return false;
+  }
+  js._cacheBase = _base;
+  js._cacheBlk = k;
+  js._cacheLen = raw;
+  _fpos = SIZE_MAX;
+  return true;
+}
+
+size_t JournalStore::SegIn::frame(size_t pos, size_t to, uint8_t* out, size_t& next) {
+  JournalStore& js = *_js;
+  uint8_t* data = out + WIRE_HDR;
+  size_t raw, stored, skip = 0;
+  if (_table) {                                  // forward the stored block
+    const size_t k = pos / JOURNAL_LZ_BLOCK;
+    uint8_t h[4];
+    if (!_f.seek(_table + 4 * k) || _f.read(h, 4) != 4) return 0;
+    if (!_f.seek(get32(h)) || _f.read(h, 4) != 4) return 0;
+    raw = get16(h);
+    stored = get16(h + 2);
+    if (raw > JOURNAL_LZ_BLOCK || stored > raw || _f.read(data, stored) != stored) return 0;
+    skip = pos - k * JOURNAL_LZ_BLOCK;
+    next = k * JOURNAL_LZ_BLOCK + raw;
+    _fpos = SIZE_MAX;
+  } else {                                       // compress .seg bytes now
+    raw = std::min((size_t)JOURNAL_LZ_BLOCK, to - pos);
+    js._cacheBlk = SIZE_MAX;                     // the cache holds the raw input for a moment
+    if (read(pos, js._cache, raw) != raw) return 0;
+    stored = js._enc.encode(js._cache, raw, data, raw);
+    if (!stored) { memcpy(data, js._cache, raw); stored = raw; }
+    next = pos + raw;
+  }
+  put16(out, (uint32_t)raw);
+  put16(out + 2, (uint32_t)stored);
+  put16(out + 4, (uint32_t)skip);
+  return WIRE_HDR + stored;
+}
+
+// ---------------- Search ----------------
+
+uint16_t JournalStore::_bloomCount(uint32_t base) {
+  char path[24];
+  _segPath(path, base, "blm");
+  if (!LittleFS.exists(path)) return 0;
+  File f = LittleFS.open(path, FILE_READ);
+  const size_t n = f ? f.size() / JOURNAL_BLOOM_BYTES : 0;
+  f.close();
+  return (uint16_t)n;
+}
+
+// Filters sit at group * JOURNAL_BLOOM_BYTES. A gap (a filter lost to a
+// crash) is padded with all-ones filters, which match anything; a torn tail
+// is topped up with ones too, so it can only over-match.
+bool JournalStore::_writeBloom(uint32_t base, uint32_t group, const uint8_t* filter) {
+  char path[24];
+  _segPath(path, base, "blm");
+  File f = LittleFS.open(path, FILE_APPEND);
+  if (!f) return false;
+  size_t size = f.size();
+  const size_t at = (size_t)group * JOURNAL_BLOOM_BYTES;
+  uint8_t ones[16];
+  memset(ones, 0xFF, sizeof(ones));
+  while (size < at) {
+    const size_t k = std::min(sizeof(ones), at - size);
+    if (f.write(ones, k) != k) break;
+    size += k;
+  }
+  const bool ok = size == at && f.write(filter, JOURNAL_BLOOM_BYTES) == JOURNAL_BLOOM_BYTES;
+  f.close();
+  if (ok) {
+    for (uint8_t i = 0; i < _n; ++i)
+      if (_segs[i].base == base) _segs[i].blooms = (uint16_t)(group + 1);
+  }
+  return ok;
+}
+
+size_t JournalStore::find(const char* terms, uint32_t* seqs, size_t max, FindStats* st) {
+  // Distinct query words (up to 8): hash, and the word for the exact check.
+  struct Term { uint32_t h; size_t len; char w[WORD_MAX]; };
+  Term want[8];
+  uint8_t nt = 0;
+  Words qw;
+  auto addTerm = [&](uint32_t h, const char* w, size_t len) {
+    for (uint8_t i = 0; i < nt; ++i) if (want[i].h == h && want[i].len == len) return;
+    if (nt == 8) return;
+    want[nt].h = h;
+    want[nt].len = len;
+    memcpy(want[nt].w, w, std::min(len, WORD_MAX));
+    nt++;
+  };
+  qw.feed((const uint8_t*)terms, strlen(terms), addTerm);
+  qw.end(addTerm);
+
+  FindStats fs{};
+  size_t hits = 0;
+  for (int i = (int)_n - 1; nt && i >= 0 && hits < max; --i) {
+    const Seg& s = _segs[i];
+    if (!s.count) continue;
+    char path[24];
+    _segPath(path, s.base, "blm");
+    File blm = s.blooms ? LittleFS.open(path, FILE_READ) : File();
+    SegIn in;
+    const uint32_t groups = (s.count + JOURNAL_INDEX_EVERY - 1) / JOURNAL_INDEX_EVERY;
+    for (uint32_t g = groups; g-- > 0 && hits < max; ) {
+      fs.groups++;
+      uint8_t bits[JOURNAL_BLOOM_BYTES];
+      const uint8_t* f = nullptr;
+      if (i == _n - 1 && _bloomOk && _bloomBase == s.base && g == s.count / JOURNAL_INDEX_EVERY) f = _bloom;
+      else if (g < s.blooms && blm.seek(g * JOURNAL_BLOOM_BYTES) && blm.read(bits, sizeof(bits)) == sizeof(bits)) f = bits;
+      bool maybe = true;
+      for (uint8_t t = 0; f && maybe && t < nt; ++t) maybe = bloomHas(f, want[t].h);
+      if (!maybe) continue;
+      fs.candidates++;
+
+      // Check the group's records; hits come out newest first.
+      const uint32_t a = s.base + g * JOURNAL_INDEX_EVERY;
+      const uint32_t b = std::min(a + JOURNAL_INDEX_EVERY, s.base + s.count);
+      uint8_t seg;
+      size_t pos;
+      if (!_locate(a, seg, pos) || (!in && !in.open(*this, s))) continue;
+      uint32_t found[JOURNAL_INDEX_EVERY];
+      uint8_t nf = 0;
+      for (uint32_t q = a; q < b; ++q) {
+        uint32_t len, rseq, ts;
+        if (!_readHdr(in, pos, s.bytes, len, rseq, ts, false) || rseq != q) break;
+        fs.records++;
+        uint8_t seen = 0;
+        auto match = [&](uint32_t h, const char* w, size_t n) {
+          for (uint8_t t = 0; t < nt; ++t)
+            if (want[t].h == h && want[t].len == n && !memcmp(want[t].w, w, std::min(n, WORD_MAX))) seen |= (uint8_t)(1u << t);
+        };
+        Words rw;
+        uint8_t buf[64];
+        for (size_t at = pos + REC_HDR, left = len; left; ) {
+          const size_t k = in.read(at, buf, std::min(left, sizeof(buf)));
+          if (!k) break;
+          rw.feed(buf, k, match);
+          at += k;
+          left -= k;
+        }
+        rw.end(match);
+        if (seen == (uint8_t)((1u << nt) - 1)) found[nf++] = q;
+        pos += REC_HDR + len;
+      }
+      while (nf && hits < max) seqs[hits++] = found[--nf];
+    }
+    in.close();
+    blm.close();
+  }
+  fs.hits = (uint32_t)hits;
+  if (st) *st = fs;
+  return hits;
+}
+
+JournalStore::Reader JournalStore::openSeqs(const uint32_t* seqs, size_t n) {
+  Reader r;
+  r._js = this;
+  r._open = true;
+  r._list = seqs;
+  r._listN = (uint16_t)std::min(n, (size_t)UINT16_MAX);
+  r._first = n ? seqs[0] : _nextSeq;
+  for (uint16_t i = 0; i < r._listN; ++i) {
+    uint8_t seg;
+    size_t off;
+    SegIn in;
+    uint32_t len, seq, ts;
+    if (!_locate(seqs[i], seg, off) || seqs[i] == _nextSeq || !in.open(*this, _segs[seg]) ||
+        !_readHdr(in, off, _segs[seg].bytes, len, seq, ts, false)) continue;
+    char pre[24];
+    r._size += (size_t)snprintf(pre, sizeof(pre), "%lu %lu ", (unsigned long)seq, (unsigned long)ts) + len + 2;
+  }
+  return r;
+}
+
+// ---------------- Sync ----------------
+
+uint16_t JournalStore::_digestCount(uint32_t base) {
+  char path[24];
+  _segPath(path, base, "dig");
+  if (!LittleFS.exists(path)) return 0;
+  File f = LittleFS.open(path, FILE_READ);
+  const size_t n = f ? f.size() / DIG_ENTRY : 0;
+  f.close();
+  return (uint16_t)n;
+}
+
+// Entries sit at group * DIG_ENTRY; gaps and a torn tail are filled with
+// all-ones entries, which digest() does not trust (it reads those groups).
+bool JournalStore::_writeDigest(uint32_t base, uint32_t group, uint32_t firstTs, uint32_t lastTs, uint32_t sum) {
+  char path[24];
+  _segPath(path, base, "dig");
+  File f = LittleFS.open(path, FILE_APPEND);
+  if (!f) return false;
+  size_t size = f.size();
+  const size_t at = (size_t)group * DIG_ENTRY;
+  uint8_t e[DIG_ENTRY];
+  memset(e, 0xFF, sizeof(e));
+  while (size < at) {
+    const size_t k = std::min(sizeof(e), at - size);
+    if (f.write(e, k) != k) break;
+    size += k;
+  }
+  put32(e, firstTs); put32(e + 4, lastTs); put32(e + 8, sum);
+  const bool ok = size == at && f.write(e, DIG_ENTRY) == DIG_ENTRY;
+  f.close();
+  if (ok) {
+    for (uint8_t i = 0; i < _n; ++i)
+      if (_segs[i].base == base) _segs[i].digests = (uint16_t)(group + 1);
+  }
+  return ok;
+}
+
+// Groups that fall inside one child count whole from their stored digest;
+// the rest (straddling a boundary, or without a digest) are read record by record.
+void JournalStore::digest(uint32_t t0, uint32_t t1, JournalSync::Digest* out) {
+  using JournalSync::FANOUT;
+  for (uint8_t k = 0; k < FANOUT; ++k) out[k] = JournalSync::Digest{};
+  if (t1 <= t0) return;
+  for (uint8_t i = 0; i < _n; ++i) {
+    const Seg& s = _segs[i];
+    if (!s.count || s.lastTs < t0 || s.firstTs >= t1) continue;
+    char path[24];
+    _segPath(path, s.base, "dig");
+    File dig = s.digests ? LittleFS.open(path, FILE_READ) : File();
+    SegIn in;
+    uint8_t buf[DIG_ENTRY * 16];
+    size_t have = 0;                    // entries in buf, from group bufAt
+    uint32_t bufAt = 0;
+    const uint32_t groups = (s.count + JOURNAL_INDEX_EVERY - 1) / JOURNAL_INDEX_EVERY;
+    for (uint32_t g = 0; g < groups; ++g) {
+      const uint32_t a = s.base + g * JOURNAL_INDEX_EVERY;
+      const uint32_t b = std::min(a + JOURNAL_INDEX_EVERY, s.base + s.count);
+      bool known = false;
+      uint32_t first = 0, last = 0, sum = 0;
+      if (i == _n - 1 && _bloomOk && _bloomBase == s.base && g == groups - 1 && _dig.count == b - a) {
+        known = true;
+        first = _digFirstTs; last = _digLastTs; sum = _dig.sum;
+      } else if (g < s.digests && dig) {
+        if (g >= bufAt + have) {
+          bufAt = g;
+          have = dig.seek(g * DIG_ENTRY) ? dig.read(buf, sizeof(buf)) / DIG_ENTRY : 0;
+        }
+        if (g < bufAt + have) {
+          const uint8_t* e = buf + (g - bufAt) * DIG_ENTRY;
+          first = get32(e); last = get32(e + 4); sum = get32(e + 8);
+          known = !(first == 0xFFFFFFFFu && last == 0xFFFFFFFFu && sum == 0xFFFFFFFFu);
+        }
+      }
+      if (known) {
+        if (last < t0 || first >= t1) continue;
+        if (first >= t0 && last < t1) {
+          const uint8_t c = JournalSync::child(t0, t1, first);
+          if (c == JournalSync::child(t0, t1, last)) {
+            out[c].count += b - a;
+            out[c].sum += sum;
+            continue;
+          }
+        }
+      }
+      uint8_t seg;
+      size_t pos;
+      if (!_locate(a, seg, pos) || (!in && !in.open(*this, s))) continue;
+      for (uint32_t q = a; q < b; ++q) {
+        uint32_t len, rseq, ts, key;
+        if (!_readHdr(in, pos, s.bytes, len, rseq, ts, true, nullptr, &key) || rseq != q) break;
+        if (ts >= t0 && ts < t1) out[JournalSync::child(t0, t1, ts)].add(key);
+        pos += REC_HDR + len;
+      }
+    }
+    in.close();
+    dig.close();
+  }
+}
+
+size_t JournalStore::keys(uint32_t t0, uint32_t t1, uint32_t* keys, uint32_t* seqs, size_t max) {
+  if (t1 <= t0) return 0;
+  const uint32_t b = _seqAtTime(t1);
+  size_t n = 0;
+  SegIn in;
+  int cur = -1;
+  size_t pos = 0;
+  for (uint32_t q = _seqAtTime(t0); q < b; ++q) {
+    if (cur < 0 || q >= _segs[cur].base + _segs[cur].count) {
+      uint8_t seg;
+      in.close();
+      if (!_locate(q, seg, pos) || !in.open(*this, _segs[seg])) break;
+      cur = seg;
+    }
+    uint32_t len, rseq, ts, key;
+    if (!_readHdr(in, pos, _segs[cur].bytes, len, rseq, ts, true, nullptr, &key) || rseq != q) break;
+    if (n < max) {
+      keys[n] = key;
+      if (seqs) seqs[n] = q;
+    }
+    n++;
+    pos += REC_HDR + len;
+  }
+  in.close();
+  return n;
+}
+
+JournalStore::Reader JournalStore::openSync(uint32_t t0, uint32_t t1) {
+  Reader r = _reader(_seqAtTime(t0), t1 > t0 ? _seqAtTime(t1) : 0);
+  r._sync = true;
+  _sizeSync(r);
+  return r;
+}
+
+JournalStore::Reader JournalStore::openSync(const uint32_t* seqs, size_t n) {
+  Reader r = openSeqs(seqs, n);
+  r._sync = true;
+  _sizeSync(r);
+  return r;
+}
+
+// The sync form puts "<ts> <len> " before each record instead of the text
+// forms' prefix, and one '\n' after it: the headers are read once more for that.
+void JournalStore::_sizeSync(Reader& r) {
+  r._size = 0;
+  SegIn in;
+  int cur = -1;
+  size_t pos = 0;
+  const uint32_t n = r.count();
+  for (uint32_t i = 0; i < n; ++i) {
+    const uint32_t q = r._list ? r._list[i] : r._first + i;
+    if (r._list || cur < 0 || q >= _segs[cur].base + _segs[cur].count) {   // listed records are looked up one by one
+      uint8_t seg;
+      if (q == _nextSeq || !_locate(q, seg, pos)) continue;
+      if (cur != seg) {
+        in.close();
+        if (!in.open(*this, _segs[seg])) { cur = -1; continue; }
+        cur = seg;
+      }
+    }
+    uint32_t len, seq, ts;
+    if (!_readHdr(in, pos, _segs[cur].bytes, len, seq, ts, false) || seq != q) continue;
+    char pre[24];
+    r._size += (size_t)snprintf(pre, sizeof(pre), "%lu %lu ", (unsigned long)ts, (unsigned long)len) + len + 1;
+    pos += REC_HDR + len;
+  }
+  in.close();
+}
+
+// ---------------- Compaction ----------------
+
+void JournalStore::_compactAbort() {
+  if (!_cz.active) return;
+  _cz.out.close();
+  char path[24];
+  _segPath(path, _cz.base, "lzt");
+  LittleFS.remove(path);
+  _cz.active = false;
+}
+
+bool JournalStore::compactStep() {
+#if JOURNAL_COMPACT
+  if (!_cz.active) {
+    int pick = -1;
+    for (uint8_t i = 0; i < _n && pick < 0; ++i)
+      if (_segs[i].sealed && !_segs[i].table && _segs[i].count) pick = i;
+    if (pick < 0) return false;
+    char path[24];
+    _segPath(path, _segs[pick].base, "lzt");
+    _cz.out = LittleFS.open(path, FILE_WRITE);
+    if (!_cz.out) return false;
+    _cz.active = true;
+    _cz.base = _segs[pick].base;
+    _cz.pos = 0;
+    _cz.outLen = 0;
+    _cz.blocks = 0;
+  }
+  int i = -1;
+  for (uint8_t k = 0; k < _n; ++k) if (_segs[k].base == _cz.base) i = k;
+  if (i < 0) { _compactAbort(); return true; }
+  Seg& s = _segs[i];
+
+  if (_cz.pos < s.bytes) {                       // one block
+    SegIn in;
+    size_t next;
+    if (!in.open(*this, s) || _cz.blocks == MAX_BLOCKS) { _compactAbort(); return false; }
+    const size_t n = in.frame(_cz.pos, s.bytes, _wire, next);
+    in.close();
+    if (!n) { _compactAbort(); return false; }
+    // Stored form drops the wire's skip field.
+    memmove(_wire + 4, _wire + WIRE_HDR, n - WIRE_HDR);
+    if (_cz.out.write(_wire, n - 2) != n - 2) { _compactAbort(); return false; }
+    _cz.offs[_cz.blocks++] = _cz.outLen;
+    _cz.outLen += (uint32_t)(n - 2);
+    _cz.pos = next;
+    return true;
+  }
+
+  // Block table + trailer, then swap files. A crash before the rename leaves
+  // the .seg in charge; after it, mount prefers the .lz and drops the .seg.
+  uint8_t t[LZ_TRAILER];
+  for (uint16_t k = 0; k < _cz.blocks; ++k) {
+    put32(t, _cz.offs[k]);
+    _cz.out.write(t, 4);
+  }
+  put32(t, s.bytes); put32(t + 4, s.count); put32(t + 8, s.firstTs); put32(t + 12, s.lastTs);
+  put16(t + 16, _cz.blocks);
+  memcpy(t + 18, LZ_MAGIC, 4);
+  const bool ok = _cz.out.write(t, LZ_TRAILER) == LZ_TRAILER;
+  _cz.out.close();
+  char from[24], to[24];
+  _segPath(from, s.base, "lzt");
+  _segPath(to, s.base, "lz");
+  _cz.active = false;
+  if (!ok || !LittleFS.rename(from, to)) { LittleFS.remove(from); return false; }
+  _segPath(from, s.base, "seg");
+  LittleFS.remove(from);
+  s.table = _cz.outLen;
+  s.disk = _cz.outLen + 4 * _cz.blocks + LZ_TRAILER;
+  if (_cacheBase == s.base) _cacheBlk = SIZE_MAX;
+  return true;
+#else
+  return false;
+#endif
+}
+
+// ---------------- Lookup ----------------
+
+bool JournalStore::_readHdr(SegIn& in, size_t pos, size_t end, uint32_t& len, uint32_t& seq, uint32_t& ts, bool verify,
+                            uint8_t* bloom, uint32_t* key) {
+  uint8_t h[REC_HDR];
+  if (pos + REC_HDR > end || in.read(pos, h, REC_HDR) != REC_HDR) return false;
+  len = get16(h);
+  seq = get32(h + 2);
+  ts  = get32(h + 6);
+  if (pos + REC_HDR + len > end) return false;
+  if (!verify) return true;
+  uint32_t crc = crc32(h, 10);
+  uint8_t buf[64];
+  Words w;
+  JournalSync::TextHash th;
+  auto add = [&](uint32_t hw, const char*, size_t) { bloomAdd(bloom, hw); };
+  pos += REC_HDR;
+  for (size_t left = len; left; ) {
+    const size_t k = left < sizeof(buf) ? left : sizeof(buf);
+    if (in.read(pos, buf, k) != k) return false;
+    crc = crc32(buf, k, crc);
+    if (bloom) w.feed(buf, k, add);
+    if (key) th.feed(buf, k);
+    pos += k;
+    left -= k;
+  }
+  if (~crc != get32(h + 10)) return false;
+  if (bloom) w.end(add);
+  if (key) *key = JournalSync::key(ts, th.h);
+  return true;
+}
+
+// Last index entry at or before key (by seq, or with ts < key when byTs).
+bool JournalStore::_idxFloor(uint32_t base, uint32_t key, bool byTs, IdxEntry& out) {
+  char path[24];
+  _segPath(path, base, "idx");
+  if (!LittleFS.exists(path)) return false;
+  File ix = LittleFS.open(path, FILE_READ);
+  if (!ix) return false;
+  bool found = false;
+  uint8_t buf[IDX_ENTRY * 16];
+  const size_t whole = ix.size() / IDX_ENTRY * IDX_ENTRY;   // a torn last entry is ignored
+  for (size_t at = 0; at < whole; ) {
+    size_t k = ix.read(buf, std::min(sizeof(buf), whole - at));
+    k -= k % IDX_ENTRY;
+    if (!k) break;
+    for (size_t i = 0; i < k; i += IDX_ENTRY) {
+      const IdxEntry e{ get32(buf + i), get32(buf + i + 4), get32(buf + i + 8) };
+      if (byTs ? e.ts >= key : e.seq > key) { ix.close(); return found; }
+      out = e;
+      found = true;
+    }
+    at += k;
+  }
+  ix.close();
+  return found;
+}
+
+int JournalStore::_segIndex(uint32_t seq) const {
+  for (int i = _n - 1; i >= 0; --i)
+    if (seq >= _segs[i].base) return seq < _segs[i].base + _segs[i].count ? i : -1;
+  return -1;
+}
+
+// Offset of record seq in its segment; seq == _nextSeq gives the end of the log.
+bool JournalStore::_locate(uint32_t seq, uint8_t& seg, size_t& off) {
+  if (seq == _nextSeq && _n) { seg = _n - 1; off = _segs[seg].bytes; return true; }
+  const int i = _segIndex(seq);
+  if (i < 0) return false;
+  seg = (uint8_t)i;
+  const Seg& s = _segs[i];
+  if (seq == s.base) { off = 0; return true; }
+  IdxEntry e{ s.base, 0, 0 };
+  IdxEntry ie;
+  if (_idxFloor(s.base, seq, false, ie) && ie.off < s.bytes) e = ie;
+  SegIn f;
+  if (!f.open(*this, s)) return false;
+  size_t pos = e.off;
+  uint32_t len, rseq, ts;
+  while (_readHdr(f, pos, s.bytes, len, rseq, ts, false) && rseq < seq) pos += REC_HDR + len;
+  f.close();
+  off = pos;
+  return true;
+}
+
+uint32_t JournalStore::_seqAtTime(uint32_t t) {
+  for (uint8_t i = 0; i < _n; ++i) {
+    const Seg& s = _segs[i];
+    if (!s.count || s.lastTs < t) continue;
+    if (s.firstTs >= t) return s.base;
+    IdxEntry e{ s.base, s.firstTs, 0 };
+    IdxEntry ie;
+    if (_idxFloor(s.base, t, true, ie) && ie.off < s.bytes) e = ie;
+    SegIn f;
+    f.open(*this, s);
+    size_t pos = e.off;
+    uint32_t len, seq = e.seq, ts;
+    while (_readHdr(f, pos, s.bytes, len, seq, ts, false) && ts < t) pos += REC_HDR + len;
+    f.close();
+    return pos < s.bytes ? seq : s.base + s.count;
+  }
+  return _nextSeq;
+}
+
+size_t JournalStore::_textBytes(uint32_t a, uint32_t b) {
+  if (a >= b) return 0;
+  uint8_t sa, sb;
+  size_t oa, ob;
+  if (!_locate(a, sa, oa) || !_locate(b, sb, ob)) return 0;
+  size_t raw = 0;
+  for (uint8_t i = sa; i < sb; ++i) raw += _segs[i].bytes;
+  raw = raw - oa + ob;
+  return raw - (size_t)(b - a) * REC_HDR + (size_t)(b - a) * 2;
+}
+
+JournalStore::Reader JournalStore::_reader(uint32_t a, uint32_t b) {
+  Reader r;
+  if (a < _firstSeq()) a = _firstSeq();
+  if (b > _nextSeq) b = _nextSeq;
+  if (a > b) a = b;
+  r._js = this;
+  r._open = true;
+  r._first = r._seq = a;
+  r._end = b;
+  r._size = _textBytes(a, b);
+  return r;
+}
+
+JournalStore::Reader JournalStore::openLast(uint32_t n) {
+  const uint32_t first = _firstSeq();
+  const uint32_t a = (_nextSeq - first > n) ? _nextSeq - n : first;
+  return _reader(a, _nextSeq);
+}
+
+JournalStore::Reader JournalStore::openTime(uint32_t t0, uint32_t t1) {
+  const uint32_t a = _seqAtTime(t0);
+  const uint32_t b = t1 == UINT32_MAX ? _nextSeq : _seqAtTime(t1 + 1);
+  return _reader(a, b);
+}
+
+size_t JournalStore::Reader::read(uint8_t* buf, size_t cap) {
+  if (_lz) return _readFrames(buf, cap);
+  size_t n = 0;
+  while (n < cap) {
+    if (_preOff < _preLen) { buf[n++] = (uint8_t)_pre[_preOff++]; continue; }
+    if (_recLeft) {
+      const size_t want = std::min(cap - n, _recLeft);
+      const size_t got = _in.read(_pos, buf + n, want);
+      n += got;
+      _pos += got;
+      _recLeft -= got;
+      if (got != want) { _recLeft = 0; _seq = _end; _size = _off + n; break; }
+      continue;
+    }
+    if (_tail) { buf[n++] = (_tail-- == 2) ? '\r' : '\n'; continue; }
+    if (_list) {                                  // the next listed record that still exists
+      uint8_t seg;
+      size_t off;
+      bool found = false;
+      while (!found && _listI < _listN) {
+        _seq = _list[_listI++];
+        found = _seq != _js->_nextSeq && _js->_locate(_seq, seg, off);
+      }
+      if (!found) { _size = _off + n; break; }
+      if (!_in || _segBase != _js->_segs[seg].base) {
+        _in.close();
+        if (!_in.open(*_js, _js->_segs[seg])) { _size = _off + n; break; }
+      }
+      _segBase = _js->_segs[seg].base;
+      _segEnd = _js->_segs[seg].bytes;
+      _pos = off;
+    } else {
+      if (_seq >= _end) break;
+      if (!_in || _pos >= _segEnd) {              // first record, or the next segment
+        uint8_t seg;
+        size_t off;
+        _in.close();
+        if (!_js->_locate(_seq, seg, off) || !_in.open(*_js, _js->_segs[seg])) { _seq = _end; _size = _off + n; break; }
+        _segBase = _js->_segs[seg].base;
+        _segEnd = _js->_segs[seg].bytes;
+        _pos = off;
+      }
+    }
+    uint32_t len, seq, ts;
+    if (!_js->_readHdr(_in, _pos, _segEnd, len, seq, ts, false) || seq != _seq) { _seq = _end; _listI = _listN; _size = _off + n; break; }
+    _pos += REC_HDR;
+    _recLeft = len;
+    _tail = _sync ? 1 : 2;
+    _seq++;
+    if (_sync || _list) {
+      _preLen = (uint8_t)snprintf(_pre, sizeof(_pre), "%lu %lu ", (unsigned long)(_sync ? ts : seq),
+                                  (unsigned long)(_sync ? len : ts));
+      _preOff = 0;
+    }
+  }
+  _off += n;
+  return n;
+}
+
+// Compressed output: the staged frame first, then the next one; a zero
+// frame once the range is exhausted.
+size_t JournalStore::Reader::_readFrames(uint8_t* buf, size_t cap) {
+  size_t n = 0;
+  while (n < cap) {
+    if (_stOff < _stLen) {
+      const size_t k = std::min(cap - n, _stLen - _stOff);
+      memcpy(buf + n, _js->_wire + _stOff, k);
+      _stOff += k;
+      n += k;
+      continue;
+    }
+    if (_fin) break;
+    _stOff = 0;
+    if (!_nextFrame()) {
+      memset(_js->_wire, 0, WIRE_HDR);
+      _stLen = WIRE_HDR;
+      _fin = true;
+      _in.close();
+    }
+  }
+  _off += n;
+  return n;
+}
+
+// Stage the block holding _pos; at the end of a segment's part of the range
+// move on to the segment holding _seq.
+bool JournalStore::Reader::_nextFrame() {
+  if (!_in || _pos >= _segTo) {
+    _in.close();
+    if (_seq >= _end) return false;
+    uint8_t seg;
+    size_t off;
+    if (!_js->_locate(_seq, seg, off)) return false;
+    const Seg s = _js->_segs[seg];
+    const uint32_t last = s.base + s.count;
+    _segTo = s.bytes;
+    if (_end < last) {
+      uint8_t es;
+      size_t eo;
+      if (!_js->_locate(_end, es, eo)) return false;
+      _segTo = eo;
+    }
+    if (!_in.open(*_js, s)) return false;
+    _pos = off;
+    _seq = _end < last ? _end : last;
+  }
+  size_t next;
+  _stLen = _in.frame(_pos, _segTo, _js->_wire, next);
+  _pos = next;
+  return _stLen != 0;
+}
+
+String JournalStore::readAll() {
+  Reader r = openReader();
+  String out;
+  out.reserve(r.size());
+  uint8_t buf[256];
+  for (size_t n; (n = r.read(buf, sizeof(buf))) > 0; ) out.concat((const char*)buf, n);
+  r.close();
+  return out;
+}
+
+JournalStore::Stats JournalStore::stats() const {
+  uint32_t records = 0, lz = 0, raw = 0, disk = 0, idx = 0, dig = 0;
+  for (uint8_t i = 0; i < _n; ++i) {
+    records += _segs[i].count;
+    idx += _segs[i].blooms * JOURNAL_BLOOM_BYTES;
+    dig += _segs[i].digests * (uint32_t)DIG_ENTRY;
+    raw += _segs[i].bytes;
+    disk += _segs[i].table ? _segs[i].disk : _segs[i].bytes;
+    lz += _segs[i].table != 0;
+  }
+  return Stats{ _n, records, _firstSeq(), _nextSeq, _dropped, _mountScanned, _tornBytes, lz, raw, disk, idx, dig,
+                _legacyLost };
+}
@@ -1,51 +1,307 @@
 #pragma once
-// Simple append-only journaling to LittleFS (flash).
-// C# tether: think StreamWriter.AppendLine + File.ReadAllText in a small service.
+// Append-only journal on LittleFS (flash) as a segmented, indexed log.
+//
+// Entries are binary records in rotating segment files under /j:
+//   /j/<base seq, 8 hex>.seg   records [len:2][seq:4][ts:4][crc32:4][text:len]
+//   /j/<base seq, 8 hex>.idx   sparse index: (seq, ts, offset) of every
+//                              JOURNAL_INDEX_EVERY-th record of the segment
+// Sequence numbers run on across segments (and across clear()), so a record
+// is found by picking its segment from the RAM table, jumping to the nearest
+// index entry, and walking at most JOURNAL_INDEX_EVERY headers.
+// Retention and clear() delete whole segment files. Mounting reads each
+// segment's index and walks forward from its last valid entry, so recovery
+// is bounded by segments x JOURNAL_INDEX_EVERY records, not by journal size;
+// a torn tail is left behind and the next append starts a fresh segment.
+// Timestamps are expected to be non-decreasing (time-range reads rely on it).
+//
+// Sealed segments are compacted (compactStep(), a block per call) into
+//   /j/<base>.lz   the same record bytes in independent JOURNAL_LZ_BLOCK
+//                  blocks [raw:2][stored:2][data] (stored == raw: not
+//                  compressed), then the block offsets and a trailer
+//                  [bytes:4][count:4][firstTs:4][lastTs:4][blocks:2]["JLZ1"]
+// Index offsets stay raw offsets; reads decode the block holding them (one
+// block is cached). A compressed segment needs no scan at mount.
+//
+// Search: /j/<base>.blm holds one JOURNAL_BLOOM_BYTES bloom filter of word
+// hashes per index group (the JOURNAL_INDEX_EVERY records an .idx entry
+// starts), written with the group's last record; the open group's filter is
+// in RAM (rebuilt by the mount walk, which starts at that group). find()
+// reads only the records of groups whose filter has every term.
+//
+// Sync: /j/<base>.dig holds each index group's [firstTs:4][lastTs:4][sum:4]
+// (the JournalSync key sum of its records), written alongside its filter;
+// the open group's is in RAM like its filter. digest() sums a time range
+// from those and reads only the records of groups that straddle a child
+// boundary, so answering a sync query does not read the whole journal.
+// C# tether: think a tiny Kafka partition: segment files + sparse .index.
 
 #include <Arduino.h>
 #include <LittleFS.h>
+#include "Lz.hpp"
+#include "JournalSync.hpp"
+
+#ifndef JOURNAL_SEG_BYTES
+#define JOURNAL_SEG_BYTES 16384   // a segment is sealed once it reaches this size
+#endif
+#ifndef JOURNAL_MAX_SEGS
+#define JOURNAL_MAX_SEGS 8        // retention: the oldest segment goes when a new one would exceed this
+#endif
+#ifndef JOURNAL_INDEX_EVERY
+#define JOURNAL_INDEX_EVERY 16    // records between sparse index entries
+#endif
+#ifndef JOURNAL_COMPACT
+#define JOURNAL_COMPACT 1         // compress sealed segments from compactStep()
+#endif
+#ifndef JOURNAL_LZ_BLOCK
+#define JOURNAL_LZ_BLOCK 2048     // raw bytes per compressed block (<= Lz::WINDOW)
+#endif
+#ifndef JOURNAL_BLOOM_BYTES
+#define JOURNAL_BLOOM_BYTES 128   // filter per index group (~4% false groups at 150 distinct words)
+#endif
 
 class JournalStore {
 public:
-  // Mount the FS; format if missing (safe for dev).
-  bool begin() {
-    // true = format if mount fails (dev-friendly). For production, handle errors differently.
-    if (!LittleFS.begin(true)) return false;
-    return true;
-  }
-
-  // Append one line (a newline is added).
-  bool appendLine(const String& line) {
-    File f = LittleFS.open(_path, FILE_APPEND);
-    if (!f) return false;
-    f.println(line);
-    f.close();
-    return true;
-  }
-
-  // Read entire journal as a single string (for debugging).
-  String readAll() {
-    if (!LittleFS.exists(_path)) return String();
-    File f = LittleFS.open(_path, FILE_READ);
-    if (!f) return String();
-
-    String out;
-    out.reserve(f.size());
-    while (f.available()) {
-      out += (char)f.read();
-    }
-    f.close();
-    return out;
-  }
-
-  // Optional: truncate file (start fresh)
-  bool clear() {
-    if (LittleFS.exists(_path)) {
-      return LittleFS.remove(_path);
-    }
-    return true;
-  }
+  static constexpr size_t REC_HDR = 14;     // len + seq + ts + crc32
+  static constexpr size_t BATCH_HDR = 6;    // packEntry(): ts + len
+  static constexpr size_t MAX_LINE = 0xFFFF;
+  static constexpr size_t WIRE_HDR = 6;     // block frame on the wire: raw + stored + skip
+  static_assert(JOURNAL_LZ_BLOCK <= Lz::WINDOW, "JOURNAL_LZ_BLOCK exceeds the LZ window");
+
+  struct Stats {
+    uint32_t segments;      // segment files live
+    uint32_t records;       // records across them
+    uint32_t firstSeq;      // oldest record kept (== nextSeq when empty)
+    uint32_t nextSeq;       // seq the next append gets
+    uint32_t dropped;       // segments removed by retention
+    uint32_t mountScanned;  // record headers read by the last begin()
+    uint32_t tornBytes;     // invalid bytes found past the last good record at mount
+    uint32_t compressed;    // segments stored as .lz
+    uint32_t rawBytes;      // record bytes across all segments
+    uint32_t diskBytes;     // ... as stored (.seg + .lz)
+    uint32_t indexBytes;    // search filters on flash (.blm)
+    uint32_t syncBytes;     // group digests on flash (.dig)
+    uint32_t legacyLost;    // /journal.txt lines the last begin() could not keep (file left as /journal.txt.bak)
+  };
+
+  // What one find() touched.
+  struct FindStats {
+    uint32_t groups;        // filters checked
+    uint32_t candidates;    // ... that had every term (or no filter)
+    uint32_t records;       // records whose text was checked
+    uint32_t hits;
+  };
 
 private:
-  const char* _path = "/journal.txt";
+  struct Seg {
+    uint32_t base;      // seq of its first record
+    uint32_t count;     // records
+    uint32_t bytes;     // valid record bytes
+    uint32_t firstTs, lastTs;
+    bool     sealed;    // no more appends (full, or torn at mount)
+    uint32_t table;     // .lz: offset of its block table; 0 = plain .seg
+    uint32_t disk;      // .lz: file size
+    uint16_t blooms;    // group filters in .blm
+    uint16_t digests;   // group digests in .dig
+  };
+
+  // Record bytes of one segment by raw offset, read from the .seg file or
+  // decoded from the .lz block that holds them.
+  class SegIn {
+  public:
+    bool open(JournalStore& js, const Seg& s);
+    size_t read(size_t pos, uint8_t* buf, size_t n);
+    // Block holding pos (up to `to`) as a wire frame in out: stored blocks as
+    // they are, .seg bytes compressed now. Returns its size; next = raw offset after it.
+    size_t frame(size_t pos, size_t to, uint8_t* out, size_t& next);
+    void close() { if (_f) _f.close(); _f = File(); }
+    explicit operator bool() const { return (bool)_f; }
+
+  private:
+    JournalStore* _js = nullptr;
+    File     _f;
+    uint32_t _base = 0;
+    uint32_t _table = 0;      // .lz: offset of the block table; 0 = plain .seg
+    size_t   _fpos = SIZE_MAX;
+    bool _block(size_t k);    // decode block k into the store's cache
+  };
+
+public:
+
+  // Sequential block reader over a range of records, as text: each record
+  // comes out as its line plus "\r\n" (what the flat file used to hold).
+  // read() fills the caller's buffer, so memory use does not depend on the
+  // journal size. The range is fixed when opened; if retention drops a
+  // segment before it is reached, the reader ends early.
+  //
+  // setCompressed() switches the output to block frames for a host that
+  // decodes them: [raw:2][stored:2][skip:2][data] per block, a zero frame at
+  // the end. Decoded blocks concatenate to the records themselves (header +
+  // text); drop `skip` bytes of a block first and stop after count()
+  // records. Compressed segments go out exactly as stored.
+  // Only one compressed reader at a time (it stages in the store), and no
+  // compactStep() while any reader is open.
+  class Reader {
+  public:
+    Reader() = default;
+    explicit operator bool() const { return _open; }
+
+    // Next bytes into buf (at most cap). 0 at the end.
+    size_t read(uint8_t* buf, size_t cap);
+
+    void setCompressed(bool on) { _lz = on && !_list && !_sync; }   // openSeqs()/openSync() readers stay text
+    bool compressed() const     { return _lz; }
+
+    size_t size() const       { return _size; }      // text bytes in the range
+    size_t offset() const     { return _off; }       // bytes handed out so far
+    bool done() const         { return _lz ? _fin && _stOff >= _stLen : _off >= _size; }
+    uint32_t first() const    { return _first; }     // seq of the first record
+    uint32_t count() const    { return _list ? _listN : _end - _first; }
+    void close()              { _in.close(); _open = false; }
+
+  private:
+    friend class JournalStore;
+    JournalStore* _js = nullptr;
+    SegIn    _in;
+    bool     _open = false;
+    uint32_t _first = 0, _seq = 0, _end = 0;   // [first, end); _seq = next header to read
+    uint32_t _segBase = 0;                     // segment _in is on
+    size_t   _segEnd = 0;                      // its valid length
+    size_t   _pos = 0;                         // position in it
+    size_t   _recLeft = 0;                     // text bytes of the current record still to copy
+    uint8_t  _tail = 0;                        // "\r\n" bytes still to emit
+    size_t   _size = 0, _off = 0;
+    bool     _lz = false, _fin = false;         // compressed output; end frame staged
+    bool     _sync = false;                     // openSync(): "<ts> <len> " before each record, '\n' after
+    size_t   _segTo = 0;                        // compressed: end of the range in this segment
+    size_t   _stLen = 0, _stOff = 0;            // compressed: frame staged in the store
+    const uint32_t* _list = nullptr;            // openSeqs(): the records, in order
+    uint16_t _listN = 0, _listI = 0;
+    char     _pre[24];                          // openSeqs()/openSync(): prefix of the current record
+    uint8_t  _preLen = 0, _preOff = 0;
+
+    size_t _readFrames(uint8_t* buf, size_t cap);
+    bool   _nextFrame();
+  };
+
+  // Mount the FS; format if missing (safe for dev). Loads the segment table,
+  // and moves a pre-segment /journal.txt into the log (kept as .bak if the
+  // log cannot hold all of it).
+  bool begin();
+
+  // Append one record (one open/write/close). ts defaults to now().
+  bool appendLine(const String& line) { return appendLine(line.c_str(), line.length(), now()); }
+  bool appendLine(const char* s, size_t n, uint32_t ts);
+
+  // Append entries packed with packEntry() in one write per segment touched.
+  bool append(const uint8_t* batch, size_t n);
+  static size_t packEntry(uint8_t* out, uint32_t ts, const char* s, size_t n);
+
+  // Readers: everything, the last n records, records from seq on, or records
+  // with t0 <= ts <= t1.
+  Reader openReader()                          { return _reader(_firstSeq(), _nextSeq); }
+  Reader openLast(uint32_t n);
+  Reader openFrom(uint32_t seq)                { return _reader(seq, _nextSeq); }
+  Reader openTime(uint32_t t0, uint32_t t1);
+
+  // Records whose text contains every word of `terms` (whole words, ASCII
+  // case-insensitive), newest first, at most max; returns how many.
+  size_t find(const char* terms, uint32_t* seqs, size_t max, FindStats* st = nullptr);
+
+  // The given records (e.g. find() hits), each as "<seq> <ts> <text>\r\n".
+  // seqs must outlive the reader; text mode only.
+  Reader openSeqs(const uint32_t* seqs, size_t n);
+
+  // Sync (see JournalSync): digests of the FANOUT children of [t0, t1) into out.
+  void digest(uint32_t t0, uint32_t t1, JournalSync::Digest* out);
+
+  // Keys (and seqs, if not null) of the records with t0 <= ts < t1, oldest
+  // first, at most max; returns how many there are in all.
+  size_t keys(uint32_t t0, uint32_t t1, uint32_t* keys, uint32_t* seqs, size_t max);
+
+  // Records for a sync fetch, as JournalSync "<ts> <len> <text>\n": all of
+  // [t0, t1), or the given ones (seqs must outlive the reader). Text mode only.
+  Reader openSync(uint32_t t0, uint32_t t1);
+  Reader openSync(const uint32_t* seqs, size_t n);
+
+  // Add the words of s to a filter; returns how many there were.
+  static uint32_t indexWords(uint8_t* filter, const char* s, size_t n);
+
+  // Read entire journal as a single string (for debugging; holds it all in RAM).
+  String readAll();
+
+  // Drop every segment (sequence numbers carry on).
+  bool clear();
+
+  // Compress one block of the oldest sealed .seg; the .lz replaces it once
+  // complete. False when there is nothing left to do. Call when idle and
+  // with no Reader open.
+  bool compactStep();
+
+  Stats stats() const;
+
+  // Record timestamp: time(), i.e. Unix seconds once the clock is set, else seconds since boot.
+  static uint32_t now();
+
+private:
+  struct IdxEntry { uint32_t seq, ts, off; };
+
+  Seg      _segs[JOURNAL_MAX_SEGS];
+  uint8_t  _n = 0;
+  uint32_t _nextSeq = 1;
+  uint32_t _dropped = 0, _mountScanned = 0, _tornBytes = 0, _legacyLost = 0;
+
+  // One decoded block (keyed by segment base + block number), also the raw
+  // input of a block being compressed; the staged wire frame; the compressor.
+  uint8_t  _cache[JOURNAL_LZ_BLOCK];
+  uint32_t _cacheBase = 0;
+  size_t   _cacheBlk = SIZE_MAX;
+  size_t   _cacheLen = 0;
+  uint8_t  _wire[WIRE_HDR + JOURNAL_LZ_BLOCK];
+  Lz::Encoder _enc;
+
+  // Filter and digest of the active segment's open group (group = (seq - base) / JOURNAL_INDEX_EVERY).
+  uint8_t  _bloom[JOURNAL_BLOOM_BYTES];
+  JournalSync::Digest _dig;
+  uint32_t _digFirstTs = 0, _digLastTs = 0;
+  uint32_t _bloomBase = 0;          // segment they belong to
+  bool     _bloomOk = false;        // they hold every record of that group (false after a remount onto an .lz tail)
+
+  // compactStep() progress on one segment.
+  static constexpr size_t MAX_BLOCKS =
+    ((JOURNAL_SEG_BYTES > REC_HDR + MAX_LINE ? JOURNAL_SEG_BYTES : REC_HDR + MAX_LINE) + JOURNAL_LZ_BLOCK - 1) / JOURNAL_LZ_BLOCK;
+  struct Compaction {
+    bool     active = false;
+    uint32_t base = 0;
+    size_t   pos = 0;                 // raw bytes done
+    File     out;                     // .lzt being written
+    uint32_t outLen = 0;
+    uint16_t blocks = 0;
+    uint32_t offs[MAX_BLOCKS];
+  } _cz;
+
+  uint32_t _firstSeq() const { return _n ? _segs[0].base : _nextSeq; }
+
+  static void _segPath(char* out, uint32_t base, const char* ext);
+  bool _newSegment();                              // start an empty active segment at _nextSeq
+  void _dropOldest();
+  bool _loadSegment(uint32_t base, Seg& s);        // bounded recovery of one segment
+  bool _loadLz(uint32_t base, Seg& s);             // trailer of a compacted segment
+  void _compactAbort();
+  void _removeSegFiles(uint32_t base);
+  bool _writeBloom(uint32_t base, uint32_t group, const uint8_t* filter);
+  bool _writeDigest(uint32_t base, uint32_t group, uint32_t firstTs, uint32_t lastTs, uint32_t sum);
+  uint16_t _digestCount(uint32_t base);
+  void _sizeSync(Reader& r);                       // openSync(): size of the sync form
+  bool _locate(uint32_t seq, uint8_t& seg, size_t& off);
+  uint32_t _seqAtTime(uint32_t ts);                // first seq with ts >= given
+  size_t _textBytes(uint32_t a, uint32_t b);       // text size of [a, b)
+  Reader _reader(uint32_t a, uint32_t b);
+  int  _segIndex(uint32_t seq) const;
+  bool _readHdr(SegIn& in, size_t pos, size_t end, uint32_t& len, uint32_t& seq, uint32_t& ts, bool verify,
+                uint8_t* bloom = nullptr,                  // verify also adds the text's words to bloom
+                uint32_t* key = nullptr);                  // ... and gives its JournalSync key
+  uint16_t _bloomCount(uint32_t base);
+  bool _idxFloor(uint32_t base, uint32_t key, bool byTs, IdxEntry& out);
+
+  struct Commit;                                   // one append: open segment + pending index entries
 };
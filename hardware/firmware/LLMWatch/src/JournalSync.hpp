@@ -0,0 +1,96 @@
+#pragma once
+// Anti-entropy sync between two journals: what both ends agree on.
+// An entry is known by its key, a hash of its timestamp and text, so the
+// same line has the same key on the watch and the host whatever seq it got.
+// A time range [t0, t1) is summed up by a Digest (entry count + sum of
+// keys) and splits into FANOUT equal children, so both sides cut the same
+// tree without exchanging anything but digests. ProtoV1::sendSync walks
+// down the children whose digests differ until one side has at most LEAF
+// entries there, compares key lists, and fetches only the missing entries.
+// Fetched entries travel as "<ts> <len> <text>\n" records; the text is raw
+// (it may hold newlines), len says where it ends.
+// C# tether: the Merkle-tree repair of Cassandra/Dynamo, over time buckets.
+
+#include <Arduino.h>
+
+#ifndef PROTO_SYNC_FANOUT
+#define PROTO_SYNC_FANOUT 16      // children per range (a SUM lists this many digests)
+#endif
+#ifndef PROTO_SYNC_LEAF
+#define PROTO_SYNC_LEAF 16        // a range with at most this many entries is answered with keys
+#endif
+// A SUM or KEYS line must fit BLE_RX_LINE_MAX (and a v2 frame).
+static_assert(PROTO_SYNC_FANOUT >= 2 && PROTO_SYNC_FANOUT <= 32, "PROTO_SYNC_FANOUT must be 2..32");
+static_assert(PROTO_SYNC_LEAF >= 1 && PROTO_SYNC_LEAF <= 32, "PROTO_SYNC_LEAF must be 1..32");
+
+namespace JournalSync {
+
+constexpr uint8_t FANOUT = PROTO_SYNC_FANOUT;
+constexpr uint8_t LEAF   = PROTO_SYNC_LEAF;
+
+struct Digest {
+  uint32_t count = 0;
+  uint32_t sum = 0;             // of the entries' keys, mod 2^32 (order-free; duplicates do not cancel)
+
+  void add(uint32_t key)        { count++; sum += key; }
+  void add(const Digest& d)     { count += d.count; sum += d.sum; }
+  bool operator==(const Digest& o) const { return count == o.count && sum == o.sum; }
+  bool operator!=(const Digest& o) const { return !(*this == o); }
+};
+
+// FNV-1a over the text, fed in pieces.
+struct TextHash {
+  uint32_t h = 2166136261u;
+  void feed(const uint8_t* p, size_t n) { for (size_t i = 0; i < n; ++i) h = (h ^ p[i]) * 16777619u; }
+};
+
+// Key of an entry from its timestamp and TextHash (murmur3 finalizer).
+inline uint32_t key(uint32_t ts, uint32_t textHash) {
+  uint32_t x = textHash ^ (ts * 0x9E3779B1u);
+  x ^= x >> 16; x *= 0x85EBCA6Bu;
+  x ^= x >> 13; x *= 0xC2B2AE35u;
+  x ^= x >> 16;
+  return x;
+}
+
+inline uint32_t key(uint32_t ts, const char* s, size_t n) {
+  TextHash t;
+  t.feed((const uint8_t*)s, n);
+  return key(ts, t.h);
+}
+
+// Start of child i of [t0, t1); split(t0, t1, FANOUT) == t1. A range
+// narrower than 2 s does not split (one child is the range itself).
+inline uint32_t split(uint32_t t0, uint32_t t1, uint8_t i) {
+  return t0 + (uint32_t)((uint64_t)(t1 - t0) * i / FANOUT);
+}
+
+// Child of [t0, t1) that holds ts (t0 <= ts < t1).
+inline uint8_t child(uint32_t t0, uint32_t t1, uint32_t ts) {
+  uint8_t i = (uint8_t)((uint64_t)(ts - t0) * FANOUT / (t1 - t0));
+  while (i + 1 < FANOUT && split(t0, t1, i + 1) <= ts) i++;
+  while (i > 0 && split(t0, t1, i) > ts) i--;
+  return i;
+}
+
+// Records as fetched: onEntry(ts, text, len) for each; false at the first
+// malformed one (the rest is not trusted).
+template <typename F>
+bool parse(const char* p, size_t n, F&& onEntry) {
+  size_t i = 0;
+  auto num = [&](uint32_t& v) {
+    const size_t from = i;
+    v = 0;
+    while (i < n && p[i] >= '0' && p[i] <= '9') v = v * 10 + (uint32_t)(p[i++] - '0');
+    return i > from && i < n && p[i++] == ' ';
+  };
+  while (i < n) {
+    uint32_t ts, len;
+    if (!num(ts) || !num(len) || len > n - i || i + len >= n || p[i + len] != '\n') return false;
+    onEntry(ts, p + i, (size_t)len);
+    i += len + 1;
+  }
+  return true;
+}
+
+} // namespace JournalSync
@@ -0,0 +1,104 @@
+#pragma once
+// Group-commit front end for JournalStore. Lines collect in a RAM buffer
+// (packed with JournalStore::packEntry, stamped when appended) and reach
+// flash in one append (one open/write/close per segment, so one LittleFS
+// metadata commit) when the buffer would overflow, when no line arrived for
+// JOURNAL_IDLE_MS, or on flush().
+//
+// Durability: append() returning true means the line is queued in RAM, not
+// on flash. A reset or power loss can lose whatever is pending: at most
+// JOURNAL_BATCH_BYTES, written within the last JOURNAL_IDLE_MS (plus however
+// late loop() runs). flush() returning true means everything appended so far
+// is on flash. Callers that read or erase the file flush/discard first.
+// C# tether: BufferedStream over a FileStream with a Flush() timer.
+
+#include <Arduino.h>
+#include "JournalStore.hpp"
+
+#ifndef JOURNAL_BATCH_BYTES
+#define JOURNAL_BATCH_BYTES 1024
+#endif
+#ifndef JOURNAL_IDLE_MS
+#define JOURNAL_IDLE_MS 2000
+#endif
+
+class JournalWriter {
+public:
+  struct Stats {
+    uint32_t lines;       // lines accepted
+    uint32_t commits;     // appends that reached the store
+    uint64_t bytes;       // bytes committed (packed: 6 B per line + text)
+    uint32_t failures;    // commits the store rejected (data kept for a retry)
+    uint32_t lastUs;      // latency of the latest commit
+    uint32_t maxUs;       // slowest commit
+    uint64_t totalUs;     // all commits together
+  };
+
+  explicit JournalWriter(JournalStore& store) : _store(store) {}
+
+  // Queue one line. Commits first if it would not fit. False if the line
+  // could not be queued or written.
+  bool append(const String& line) { return append(line.c_str(), line.length()); }
+  bool append(const char* s, size_t n) {
+    if (n > JournalStore::MAX_LINE) return false;
+    const size_t need = JournalStore::BATCH_HDR + n;
+    if (need > sizeof(_buf)) {                    // too big to batch: write it through
+      if (!flush()) return false;
+      if (!_timed(n, [&] { return _store.appendLine(s, n, JournalStore::now()); })) return false;
+      _stats.lines++;
+      return true;
+    }
+    if (_len + need > sizeof(_buf) && !flush()) return false;
+    _len += JournalStore::packEntry(_buf + _len, JournalStore::now(), s, n);
+    _lastMs = millis();
+    _stats.lines++;
+    return true;
+  }
+
+  // Commit on the idle deadline. Call once per loop().
+  void loop(uint32_t nowMs) {
+    if (_len && nowMs - _lastMs >= JOURNAL_IDLE_MS) flush();
+  }
+
+  // Time until loop() would commit; UINT32_MAX when nothing is pending.
+  uint32_t msUntilDue(uint32_t nowMs) const {
+    if (!_len) return UINT32_MAX;
+    const uint32_t idle = nowMs - _lastMs;
+    return idle >= JOURNAL_IDLE_MS ? 0 : JOURNAL_IDLE_MS - idle;
+  }
+
+  // Write everything pending. True when nothing is left in RAM.
+  bool flush() {
+    if (!_len) return true;
+    if (!_timed(_len, [&] { return _store.append(_buf, _len); })) return false;
+    _len = 0;
+    return true;
+  }
+
+  // Forget pending lines (the journal is being cleared).
+  void discard() { _len = 0; }
+
+  size_t pending() const      { return _len; }
+  const Stats& stats() const  { return _stats; }
+
+private:
+  JournalStore& _store;
+  uint8_t  _buf[JOURNAL_BATCH_BYTES];
+  size_t   _len = 0;
+  uint32_t _lastMs = 0;        // millis() of the latest append
+  Stats    _stats{};
+
+  template <typename F>
+  bool _timed(size_t n, F&& commit) {
+    const uint32_t t0 = micros();
+    const bool ok = commit();
+    const uint32_t us = micros() - t0;
+    if (!ok) { _stats.failures++; return false; }
+    _stats.commits++;
+    _stats.bytes += n;
+    _stats.lastUs = us;
+    if (us > _stats.maxUs) _stats.maxUs = us;
+    _stats.totalUs += us;
+    return true;
+  }
+};
@@ -0,0 +1,75 @@
+#pragma once
+// Reassembles newline-terminated lines from arbitrary write chunks.
+// A write may carry several lines, or end halfway through one; the partial
+// tail waits in a fixed buffer for the rest. Lines longer than the buffer
+// are dropped whole (up to their newline) rather than delivered truncated.
+// C# tether: PipeReader + SequenceReader.TryReadTo('\n').
+
+#include <Arduino.h>
+
+#ifndef BLE_RX_LINE_MAX
+#define BLE_RX_LINE_MAX 512
+#endif
+
+class LineAssembler {
+public:
+  struct Stats {
+    uint32_t lines;       // complete lines delivered
+    uint32_t overflows;   // lines dropped for exceeding BLE_RX_LINE_MAX
+    uint32_t carried;     // writes that ended mid-line
+  };
+
+  // Consume bytes up to and including the first '\n'. Returns how many were
+  // used; `done` is set when a line is complete (read it with line()/length(),
+  // then call next()). The '\n' and a preceding '\r' are not stored.
+  size_t push(const char* p, size_t n, bool& done) {
+    done = false;
+    if (_ready) next();
+    const char* nl = (const char*)memchr(p, '\n', n);
+    const size_t take = nl ? (size_t)(nl - p) : n;
+
+    if (!_dropping) {
+      if (_len + take > BLE_RX_LINE_MAX) {
+        _dropping = true;
+        _stats.overflows++;
+        _len = 0;
+      } else {
+        memcpy(_buf + _len, p, take);
+        _len += take;
+      }
+    }
+
+    if (!nl) {
+      if (_len || _dropping) _stats.carried++;
+      return n;
+    }
+    if (_dropping) { _dropping = false; _len = 0; return take + 1; }
+    if (_len && _buf[_len - 1] == '\r') _len--;
+    _buf[_len] = '\0';
+    _ready = true;
+    done = true;
+    _stats.lines++;
+    return take + 1;
+  }
+
+  const char* line() const { return _buf; }
+  size_t length() const    { return _len; }
+
+  // Release the line returned by the last completed push().
+  void next() { _len = 0; _ready = false; }
+
+  // Nothing buffered (no partial line waiting).
+  bool empty() const { return _len == 0 && !_dropping; }
+
+  // Drop any partial line (e.g. the connection went away mid-line).
+  void reset() { _len = 0; _ready = false; _dropping = false; }
+
+  const Stats& stats() const { return _stats; }
+
+private:
+  char   _buf[BLE_RX_LINE_MAX + 1];
+  size_t _len = 0;
+  bool   _ready = false;      // _buf holds a complete line not yet released
+  bool   _dropping = false;   // inside an overlong line: skip to its newline
+  Stats  _stats{};
+};
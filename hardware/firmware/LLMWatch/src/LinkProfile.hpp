@@ -0,0 +1,136 @@
+#pragma once
+// Connection parameters that follow what the protocol is doing. A stream or
+// bulk transfer asks the central for a short interval (and the 2M PHY); once
+// nothing has streamed for BLE_IDLE_AFTER_MS the link relaxes to a long
+// interval with slave latency, so an idle watch sleeps through most
+// connection events. The central has the last word: what it granted is kept
+// next to what was asked. Each profile keeps its own tally (time, bytes each
+// way, RTT samples) so the gain can be measured rather than assumed.
+// C# tether: a power plan switched by load, with a perf counter per plan.
+
+#include <Arduino.h>
+
+// Intervals in units of 1.25 ms, supervision timeout in units of 10 ms (as on air).
+#ifndef BLE_FAST_ITVL_MIN
+#define BLE_FAST_ITVL_MIN 6       // 7.5 ms
+#endif
+#ifndef BLE_FAST_ITVL_MAX
+#define BLE_FAST_ITVL_MAX 12      // 15 ms (iOS grants 15 ms at best)
+#endif
+#ifndef BLE_IDLE_ITVL_MIN
+#define BLE_IDLE_ITVL_MIN 80      // 100 ms
+#endif
+#ifndef BLE_IDLE_ITVL_MAX
+#define BLE_IDLE_ITVL_MAX 120     // 150 ms
+#endif
+#ifndef BLE_IDLE_LATENCY
+#define BLE_IDLE_LATENCY 4        // connection events the watch may skip while idle
+#endif
+#ifndef BLE_SUPERVISION_TIMEOUT
+#define BLE_SUPERVISION_TIMEOUT 500   // 5 s
+#endif
+#ifndef BLE_PHY_2M
+#define BLE_PHY_2M 1              // ask for 2M while fast (C3/S3 have it; the central may not)
+#endif
+#ifndef BLE_IDLE_AFTER_MS
+#define BLE_IDLE_AFTER_MS 2000    // quiet time before relaxing
+#endif
+// The central drops the link if it hears nothing for the timeout, and with
+// latency the watch may be silent for (1 + latency) intervals.
+static_assert(BLE_SUPERVISION_TIMEOUT * 10 > (1 + BLE_IDLE_LATENCY) * BLE_IDLE_ITVL_MAX * 125 / 100 * 2,
+              "BLE_SUPERVISION_TIMEOUT too short for the idle interval and latency");
+static_assert(BLE_FAST_ITVL_MIN >= 6 && BLE_FAST_ITVL_MIN <= BLE_FAST_ITVL_MAX, "bad fast interval");
+static_assert(BLE_IDLE_ITVL_MIN <= BLE_IDLE_ITVL_MAX && BLE_IDLE_ITVL_MAX <= 3200, "bad idle interval");
+
+class LinkProfile {
+public:
+  enum class Mode : uint8_t {
+    Central = 0,   // what the central picked; nothing asked yet on this connection
+    Fast    = 1,   // streaming
+    Idle    = 2,   // relaxed
+  };
+  static constexpr uint8_t MODES = 3;
+
+  struct Params {
+    uint16_t minItvl, maxItvl;   // 1.25 ms units
+    uint16_t latency;            // events the peripheral may skip
+    uint16_t timeout;            // 10 ms units
+    bool     phy2M;
+  };
+
+  struct Stats {
+    uint32_t entered;       // switches into this mode
+    uint32_t ms;            // time spent in it
+    uint32_t txBytes;       // notified while in it
+    uint32_t rxBytes;       // written by the central while in it
+    uint32_t rttSamples;    // ACK round trips measured while in it
+    uint32_t rttSumMs;
+    uint32_t rttMaxMs;
+    uint16_t itvl;          // interval granted (1.25 ms units; 0 = never reported)
+    uint16_t latency;       // slave latency granted
+
+    uint32_t bytesPerSec() const { return ms ? (uint32_t)((uint64_t)(txBytes + rxBytes) * 1000 / ms) : 0; }
+    uint32_t meanRttMs() const   { return rttSamples ? rttSumMs / rttSamples : 0; }
+  };
+
+  static Params params(Mode m) {
+    if (m == Mode::Fast) return Params{ BLE_FAST_ITVL_MIN, BLE_FAST_ITVL_MAX, 0, BLE_SUPERVISION_TIMEOUT, BLE_PHY_2M != 0 };
+    return Params{ BLE_IDLE_ITVL_MIN, BLE_IDLE_ITVL_MAX, BLE_IDLE_LATENCY, BLE_SUPERVISION_TIMEOUT, false };
+  }
+
+  // A new connection: the central's parameters until something is asked.
+  void reset(uint32_t nowMs) {
+    _mode = Mode::Central;
+    _sinceMs = _lastBusyMs = nowMs;
+    _stats[0].entered++;
+  }
+
+  // Something is streaming. True when that switches to Fast (ask for params(Fast)).
+  bool busy(uint32_t nowMs) {
+    _account(nowMs);
+    _lastBusyMs = nowMs;
+    return _enter(Mode::Fast);
+  }
+
+  // Nothing is. True when the link has been quiet long enough to relax (ask for params(Idle)).
+  bool tick(uint32_t nowMs) {
+    _account(nowMs);
+    if (_mode == Mode::Idle || nowMs - _lastBusyMs < BLE_IDLE_AFTER_MS) return false;
+    return _enter(Mode::Idle);
+  }
+
+  // Traffic and round trips since the last call, charged to the current mode.
+  void bytes(uint32_t tx, uint32_t rx) { Stats& s = _cur(); s.txBytes += tx; s.rxBytes += rx; }
+  void rtt(uint32_t ms) {
+    Stats& s = _cur();
+    s.rttSamples++;
+    s.rttSumMs += ms;
+    if (ms > s.rttMaxMs) s.rttMaxMs = ms;
+  }
+
+  // What the central granted (reported by the stack after each update).
+  void granted(uint16_t itvl, uint16_t latency) { _cur().itvl = itvl; _cur().latency = latency; }
+
+  Mode mode() const                 { return _mode; }
+  const Stats& stats(Mode m) const  { return _stats[(uint8_t)m]; }
+
+private:
+  Mode     _mode = Mode::Central;
+  uint32_t _sinceMs = 0;       // time accounted up to here
+  uint32_t _lastBusyMs = 0;
+  Stats    _stats[MODES]{};
+
+  Stats& _cur() { return _stats[(uint8_t)_mode]; }
+
+  void _account(uint32_t nowMs) {
+    _cur().ms += nowMs - _sinceMs;
+    _sinceMs = nowMs;
+  }
+
+  bool _enter(Mode m) {
+    if (_mode == m) return false;
+    _mode = m;
+    _cur().entered++;
+    return true;
+  }
+};
@@ -0,0 +1,213 @@
+#pragma once
+// Cooperative runtime for loop(): one-shot and periodic timers, event flags
+// other tasks (or an ISR) raise to wake the loop, and a wait that blocks
+// until the nearest deadline instead of spinning. A pass is startPass(),
+// dispatch(), the work, then idle(now, otherMs); otherMs is the nearest
+// deadline the caller's own modules report (RenderScheduler, JournalWriter,
+// ... msUntilDue()), 0 if work is left over. Events and timers run from
+// dispatch() on the loop task, so handlers need no locking.
+// Pass work time goes into a log2 histogram; percentiles are read back
+// from it (within a bucket, assuming samples spread evenly).
+// C# tether: a single-threaded SynchronizationContext with a timer queue.
+
+#include <Arduino.h>
+#include <atomic>
+
+#ifndef LOOP_TIMERS
+#define LOOP_TIMERS 8             // timer slots
+#endif
+#ifndef LOOP_MAX_SLEEP_MS
+#define LOOP_MAX_SLEEP_MS 1000    // longest single block (a lost wakeup costs at most this)
+#endif
+#ifndef LOOP_TICKLESS
+#define LOOP_TICKLESS 1           // 0: never block (poll every pass, as before)
+#endif
+static_assert(LOOP_TIMERS >= 1 && LOOP_TIMERS <= 127, "LOOP_TIMERS must fit an int8_t id");
+
+class LoopRuntime {
+public:
+  using Fn = void (*)();
+  static constexpr uint8_t EVENTS = 32;     // event ids 0..31
+  static constexpr uint8_t BUCKETS = 24;    // pass work time: [2^(k-1), 2^k) µs, up to 8 s
+  static constexpr int8_t  NONE = -1;
+
+  struct Stats {
+    uint32_t passes;            // loop() passes
+    uint32_t sleeps;            // ... that blocked
+    uint64_t sleptMs;           // time spent blocked
+    uint32_t eventWakes;        // events dispatched
+    uint32_t timersFired;
+    uint32_t lateMaxMs;         // worst timer lateness (due -> ran)
+    uint32_t workMaxUs;         // longest pass
+    uint64_t workUs;            // all passes together
+    uint32_t hist[BUCKETS];
+  };
+
+  // Call once from the task that runs loop() (it is the one woken).
+  void begin() {
+#if !defined(BOARD_NATIVE)
+    _task = xTaskGetCurrentTaskHandle();
+#endif
+  }
+
+  // ---- Timers (ids are slot numbers; NONE when all are taken) ----
+  int8_t after(uint32_t ms, Fn fn)       { const int8_t id = timer(fn);           restart(id, ms);       return id; }
+  int8_t every(uint32_t periodMs, Fn fn) { const int8_t id = timer(fn, periodMs); restart(id, periodMs); return id; }
+
+  // A slot that is not armed yet; restart() arms it.
+  int8_t timer(Fn fn, uint32_t periodMs = 0) {
+    for (int8_t i = 0; i < LOOP_TIMERS; ++i) {
+      if (_t[i].fn) continue;
+      _t[i] = Timer{ 0, periodMs, fn, false };
+      return i;
+    }
+    return NONE;
+  }
+
+  // Re-arm to fire ms from now (keeps its period); e.g. an idle timeout per token.
+  void restart(int8_t id, uint32_t ms) {
+    if (id < 0 || id >= LOOP_TIMERS || !_t[id].fn) return;
+    _t[id].due = millis() + ms;
+    _t[id].armed = true;
+  }
+  void stop(int8_t id)   { if (id >= 0 && id < LOOP_TIMERS) _t[id].armed = false; }
+  void cancel(int8_t id) { if (id >= 0 && id < LOOP_TIMERS) _t[id] = Timer{}; }
+  bool armed(int8_t id) const { return id >= 0 && id < LOOP_TIMERS && _t[id].armed; }
+
+  // ---- Events ----
+  void on(uint8_t ev, Fn fn) { if (ev < EVENTS) _on[ev] = fn; }
+
+  // Raise an event and wake the loop. Any task; post() must not be used from an ISR.
+  void post(uint8_t ev) {
+    if (ev >= EVENTS) return;
+    _pending.fetch_or(1u << ev, std::memory_order_release);
+#if !defined(BOARD_NATIVE)
+    if (_task) xTaskNotifyGive(_task);
+#endif
+  }
+  void postFromISR(uint8_t ev) {
+    if (ev >= EVENTS) return;
+    _pending.fetch_or(1u << ev, std::memory_order_release);
+#if !defined(BOARD_NATIVE)
+    BaseType_t woken = pdFALSE;
+    if (_task) vTaskNotifyGiveFromISR(_task, &woken);
+    portYIELD_FROM_ISR(woken);
+#endif
+  }
+
+  // ---- The pass ----
+  void startPass(uint32_t nowUs) { _passUs = nowUs; }
+
+  // Run raised events, then timers that are due. Returns the events seen.
+  uint32_t dispatch(uint32_t nowMs) {
+    const uint32_t evs = _pending.exchange(0, std::memory_order_acquire);
+    for (uint8_t e = 0; e < EVENTS && (evs >> e); ++e) {
+      if (!(evs & (1u << e))) continue;
+      _stats.eventWakes++;
+      if (_on[e]) _on[e]();
+    }
+    for (uint8_t i = 0; i < LOOP_TIMERS; ++i) {
+      Timer& t = _t[i];
+      if (!t.armed || (int32_t)(nowMs - t.due) < 0) continue;
+      const uint32_t late = nowMs - t.due;
+      if (late > _stats.lateMaxMs) _stats.lateMaxMs = late;
+      if (t.period) t.due += t.period * (late / t.period + 1);   // missed beats are skipped, not run twice
+      else          t.armed = false;
+      _stats.timersFired++;
+      t.fn();
+    }
+    return evs;
+  }
+
+  // Time until the next timer (0 = overdue); UINT32_MAX when none is armed.
+  uint32_t msUntilDue(uint32_t nowMs) const {
+    uint32_t best = UINT32_MAX;
+    for (uint8_t i = 0; i < LOOP_TIMERS; ++i) {
+      if (!_t[i].armed) continue;
+      const int32_t d = (int32_t)(_t[i].due - nowMs);
+      const uint32_t ms = d > 0 ? (uint32_t)d : 0;
+      if (ms < best) best = ms;
+    }
+    return best;
+  }
+
+  // How long the pass ending now may block: the nearer of our timers and
+  // otherMs, 0 if an event is already waiting, capped at LOOP_MAX_SLEEP_MS.
+  uint32_t sleepMs(uint32_t nowMs, uint32_t otherMs) const {
+    if (!LOOP_TICKLESS || _pending.load(std::memory_order_acquire)) return 0;
+    uint32_t ms = msUntilDue(nowMs);
+    if (otherMs < ms) ms = otherMs;
+    return ms < LOOP_MAX_SLEEP_MS ? ms : LOOP_MAX_SLEEP_MS;
+  }
+
+  // End the pass: record its work time, then block for sleepMs() (an event wakes it early).
+  void idle(uint32_t nowMs, uint32_t otherMs) {
+    endPass(micros());
+    block(sleepMs(nowMs, otherMs));
+  }
+
+  // Record the pass that startPass() began.
+  void endPass(uint32_t nowUs) {
+    const uint32_t us = nowUs - _passUs;
+    _stats.passes++;
+    _stats.workUs += us;
+    if (us > _stats.workMaxUs) _stats.workMaxUs = us;
+    uint8_t k = 0;
+    while (k + 1 < BUCKETS && (us >> k)) ++k;
+    _stats.hist[k]++;
+  }
+
+  void block(uint32_t ms) {
+    if (!ms) return;
+    const uint32_t t0 = millis();
+    _stats.sleeps++;
+#if defined(BOARD_NATIVE)
+    if (shimBlock) shimBlock(ms);
+    else           delay(ms);
+#else
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+#endif
+    _stats.sleptMs += millis() - t0;
+  }
+
+  // Pass work time at percentile p (0..100), in µs.
+  uint32_t percentileUs(uint8_t p) const {
+    if (!_stats.passes) return 0;
+    const uint64_t rank = ((uint64_t)_stats.passes * p + 99) / 100;
+    uint64_t seen = 0;
+    for (uint8_t k = 0; k < BUCKETS; ++k) {
+      const uint32_t n = _stats.hist[k];
+      if (!n || seen + n < rank) { seen += n; continue; }
+      const uint32_t lo = k ? 1u << (k - 1) : 0, hi = 1u << k;
+      const uint32_t at = lo + (uint32_t)((uint64_t)(hi - lo) * (rank - seen) / n);
+      return at < _stats.workMaxUs ? at : _stats.workMaxUs;
+    }
+    return _stats.workMaxUs;
+  }
+
+  const Stats& stats() const { return _stats; }
+  void resetStats() { _stats = Stats{}; }
+
+#if defined(BOARD_NATIVE)
+  // Native: block() advances the virtual clock; a bench can take over to
+  // inject the events that would have woken the loop meanwhile.
+  std::function<void(uint32_t)> shimBlock;
+#endif
+
+private:
+  struct Timer {
+    uint32_t due = 0;
+    uint32_t period = 0;        // 0: one-shot
+    Fn       fn = nullptr;
+    bool     armed = false;
+  };
+
+  Timer    _t[LOOP_TIMERS];
+  Fn       _on[EVENTS] = {};
+  std::atomic<uint32_t> _pending{ 0 };
+  uint32_t _passUs = 0;
+  Stats    _stats{};
+#if !defined(BOARD_NATIVE)
+  TaskHandle_t _task = nullptr;
+#endif
+};
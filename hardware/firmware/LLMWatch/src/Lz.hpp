@@ -0,0 +1,133 @@
+#pragma once
+// Small LZSS codec for journal blocks (heatshrink class: 2 KB window, no
+// entropy stage). A block is compressed on its own, so any block can be
+// decoded without the ones before it.
+//
+//   [flags:1][8 items] ...   flag bit i (LSB first) says item i is a match
+//   literal: 1 byte
+//   match:   2 bytes LE, (offset - 1) << 5 | (length - MIN_MATCH)
+//            offset 1..WINDOW back into the output, length 3..34
+//
+// The stream simply ends after the last item; the container records the
+// compressed and decoded sizes. Decoding needs no state beyond the output
+// buffer, so the host side is a dozen lines.
+// C# tether: like DeflateStream with CompressionLevel.Fastest, minus Huffman.
+
+#include <Arduino.h>
+
+namespace Lz {
+
+constexpr size_t WINDOW    = 2048;   // also the largest block (offsets are 11 bits)
+constexpr size_t MIN_MATCH = 3;
+constexpr size_t MAX_MATCH = MIN_MATCH + 31;
+
+// Worst case output for n input bytes (all literals).
+constexpr size_t bound(size_t n) { return n + (n + 7) / 8; }
+
+// Compressor with a hash-chain match finder: ~6 KB of tables, reused per block.
+// Not thread-safe; the journal uses one from loop().
+class Encoder {
+public:
+  static constexpr size_t HASH_BITS = 10;
+  static constexpr uint8_t CHAIN    = 16;   // candidates tried per position
+
+  // Compress n (<= WINDOW) bytes into out. Returns the compressed size, or 0
+  // if it would not be smaller than cap (callers store the block raw then).
+  size_t encode(const uint8_t* in, size_t n, uint8_t* out, size_t cap) {
+    if (n > WINDOW) return 0;
+    for (size_t i = 0; i < (1u << HASH_BITS); ++i) _head[i] = NONE;
+
+    size_t o = 0, flagAt = 0;
+    uint8_t bit = 8;
+    for (size_t i = 0; i < n; ) {
+      if (bit == 8) {
+        if (o >= cap) return 0;
+        flagAt = o++;
+        out[flagAt] = 0;
+        bit = 0;
+      }
+      size_t bestLen = 0, bestOff = 0;
+      if (i + MIN_MATCH <= n) {
+        const size_t limit = (n - i) < MAX_MATCH ? n - i : MAX_MATCH;
+        uint16_t cand = _head[_hash(in + i)];
+        for (uint8_t c = 0; c < CHAIN && cand != NONE; ++c, cand = _prev[cand]) {
+          const uint8_t* a = in + cand;
+          if (a[bestLen] != in[i + bestLen] && bestLen) continue;
+          size_t k = 0;
+          while (k < limit && a[k] == in[i + k]) ++k;
+          if (k > bestLen) {
+            bestLen = k;
+            bestOff = i - cand;
+            if (k == limit) break;
+          }
+        }
+      }
+      if (bestLen >= MIN_MATCH) {
+        if (o + 2 > cap) return 0;
+        const uint16_t v = (uint16_t)(((bestOff - 1) << 5) | (bestLen - MIN_MATCH));
+        out[o++] = (uint8_t)v;
+        out[o++] = (uint8_t)(v >> 8);
+        out[flagAt] |= (uint8_t)(1u << bit);
+        for (size_t e = i + bestLen; i < e; ++i) _insert(in, i, n);
+      } else {
+        if (o + 1 > cap) return 0;
+        out[o++] = in[i];
+        _insert(in, i, n);
+        ++i;
+      }
+      ++bit;
+    }
+    return o < cap ? o : 0;
+  }
+
+private:
+  static constexpr uint16_t NONE = 0xFFFF;
+  uint16_t _head[1u << HASH_BITS];
+  uint16_t _prev[WINDOW];
+
+  static uint32_t _hash(const uint8_t* p) {
+    const uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+  }
+  void _insert(const uint8_t* in, size_t i, size_t n) {
+    if (i + MIN_MATCH > n) return;
+    const uint32_t h = _hash(in + i);
+    _prev[i] = _head[h];
+    _head[h] = (uint16_t)i;
+  }
+};
+
+// Decode a block whose bytes come from next() (returns -1 at the end of the
+// compressed data). Returns the decoded size, or SIZE_MAX if the data is
+// corrupt or decodes to more than cap.
+template <typename Next>
+size_t decode(Next&& next, uint8_t* out, size_t cap) {
+  size_t o = 0;
+  for (;;) {
+    const int flags = next();
+    if (flags < 0) return o;
+    for (uint8_t bit = 0; bit < 8; ++bit) {
+      const int a = next();
+      if (a < 0) return o;
+      if (!(flags & (1 << bit))) {
+        if (o >= cap) return SIZE_MAX;
+        out[o++] = (uint8_t)a;
+        continue;
+      }
+      const int b = next();
+      if (b < 0) return SIZE_MAX;
+      const uint16_t v = (uint16_t)(a | (b << 8));
+      const size_t off = (size_t)(v >> 5) + 1;
+      const size_t len = (size_t)(v & 31) + MIN_MATCH;
+      if (off > o || o + len > cap) return SIZE_MAX;
+      for (size_t k = 0; k < len; ++k, ++o) out[o] = out[o - off];   // may overlap: byte by byte
+    }
+  }
+}
+
+inline size_t decode(const uint8_t* in, size_t n, uint8_t* out, size_t cap) {
+  size_t i = 0;
+  return decode([&]() -> int { return i < n ? in[i++] : -1; }, out, cap);
+}
+
+} // namespace Lz
@@ -6,29 +6,153 @@ bool OledView::begin() {
   u8g2.setI2CAddress(OLED_ADDR << 1); // U8g2 wants 8-bit address
   u8g2.begin();
 
+  // Start from a blank panel (its RAM is noise after power-on); the first
+  // frame loop() draws follows at once, so nothing is held on screen here.
   u8g2.clearBuffer();
   u8g2.setFont(u8g2_font_6x12_tf);
-  u8g2.drawStr(0, 12, "OLED: SH1106 OK");
   u8g2.sendBuffer();
-  delay(250);
+  _synced();
+
+#if OLED_ASYNC
+  // From here on only the display task talks to the panel.
+  if (!_task) xTaskCreatePinnedToCore(_taskMain, "oled", 3072, this, OLED_TASK_PRIO, &_task, OLED_TASK_CORE);
+#endif
 
   cursorY = 12;
   return true;
 }
 
 void OledView::clear() {
+  _clears++;
+  _dirty = 0xFF;
+  _scroll = false;
+  _top = 0;
+  _line = 0;
   u8g2.clearBuffer();
   u8g2.setFont(u8g2_font_6x12_tf);
   cursorY = 12;
 }
 
 void OledView::println(const String& s) {
+  _touch(cursorY - 10, cursorY + 2);
   u8g2.drawStr(0, cursorY, s.c_str());
   cursorY += 12;
   if (cursorY > 62) cursorY = 12; // simple wrap
 }
 
-void OledView::show() { u8g2.sendBuffer(); }
+// Send only what changed: for each page drawn on, the span from the first to
+// the last 8x8 tile that differs from the panel. With OLED_ASYNC the display
+// task sends it and show() returns at once; if the previous frame is still
+// on the bus the dirty pages are kept for poll() to offer again.
+void OledView::show() {
+  if (busy()) {
+    _stats.dropped++;
+    _retry = true;
+    return;
+  }
+  const uint8_t* buf = u8g2.getBufferPtr();
+  const size_t rowBytes = TILES * 8;
+  uint32_t bytes = 0;
+  for (uint8_t p = 0; p < PAGES; ++p) {
+    _span[p] = Span{ 0, 0 };
+    if (!(_dirty & (1u << p))) continue;
+    const uint8_t* row = buf + p * rowBytes;
+    uint8_t* sh = _shadow + p * rowBytes;
+    int t0 = -1, t1 = -1;
+    for (uint8_t t = 0; t < TILES; ++t) {
+      if (memcmp(row + t * 8, sh + t * 8, 8) == 0) continue;
+      if (t0 < 0) t0 = t;
+      t1 = t;
+    }
+    if (t0 < 0) continue;
+    const uint8_t tw = (uint8_t)(t1 - t0 + 1);
+    memcpy(sh + t0 * 8, row + t0 * 8, tw * 8);
+    _span[p] = Span{ (uint8_t)t0, tw };
+    bytes += PAGE_CMD_BYTES + tw * 8;
+    _stats.pages++;
+  }
+  _jobLine = -1;
+  if (_line != _panelLine) {                 // after the new row is in place
+    _jobLine = _line;
+    _panelLine = _line;
+    bytes += LINE_CMD_BYTES;
+  }
+  _dirty = 0;
+  _retry = false;
+  _stats.frames++;
+  if (!bytes) _stats.idle++;
+  _stats.bytes += bytes;
+  _stats.lastBytes = bytes;
+  if (!bytes) return;
+
+#if OLED_ASYNC
+  _busy.store(true, std::memory_order_release);
+  xTaskNotifyGive(_task);
+#else
+  _flush();
+#endif
+}
+
+void OledView::_flush() {
+  const uint32_t t0 = micros();
+  for (uint8_t p = 0; p < PAGES; ++p) {
+    if (!_span[p].w) continue;
+    u8g2.drawTile(_span[p].x, p, _span[p].w, _shadow + p * TILES * 8 + _span[p].x * 8);
+  }
+  if (_jobLine >= 0) u8g2.sendF("c", 0x40 | _jobLine);   // SH1106/SSD1306: set display start line
+  const uint32_t us = micros() - t0;
+  _stats.flushUs = us;
+  if (us > _stats.flushMaxUs) _stats.flushMaxUs = us;
+}
+
+#if OLED_ASYNC
+void OledView::_taskMain(void* arg) {
+  OledView* self = static_cast<OledView*>(arg);
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    self->_flush();
+    self->_busy.store(false, std::memory_order_release);
+  }
+}
+#endif
+
+void OledView::_touch(int y0, int y1) {
+  if (y0 < 0) y0 = 0;
+  if (y1 > PAGES * 8) y1 = PAGES * 8;
+  for (int p = y0 >> 3; p < PAGES && p * 8 < y1; ++p) _dirty |= (uint8_t)(1u << p);
+}
+
+void OledView::_synced() {
+  memcpy(_shadow, u8g2.getBufferPtr(), sizeof(_shadow));
+  _dirty = 0;
+}
+
+void OledView::drawRow(int y, const char* s) {
+  _touch(y - 10, y + 2);
+  u8g2.setDrawColor(0);
+  u8g2.drawBox(0, y - 10, 128, 12);   // 6x12 glyphs span [y-10, y+2)
+  u8g2.setDrawColor(1);
+  u8g2.drawStr(0, y, s);
+}
+
+void OledView::scrollBegin() {
+  clear();
+  _scroll = true;
+}
+
+void OledView::scrollAdvance() {
+  _top = (uint8_t)((_top + 1) % SCROLL_ROWS);
+  _line = (uint8_t)(_top * SCROLL_ROW_PX);
+}
+
+void OledView::scrollRow(uint8_t k, const char* s) {
+  const int y = ((_top + k) % SCROLL_ROWS) * SCROLL_ROW_PX;   // RAM row of the slot
+  _touch(y, y + SCROLL_ROW_PX);
+  u8g2.setDrawColor(0);
+  u8g2.drawBox(0, y, 128, SCROLL_ROW_PX);
+  u8g2.setDrawColor(1);
+  u8g2.drawStr(0, y + 12, s);                                 // glyphs span [y+2, y+14)
+}
 
 void OledView::statusPage(const char* title, const char* line1, const char* line2) {
   clear();
@@ -2,6 +2,7 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include <U8g2lib.h>
+#include <atomic>
 
 // Pins/address that worked in your probe
 #ifndef OLED_SDA
@@ -14,16 +15,114 @@
 #define OLED_ADDR 0x3C
 #endif
 
+// Push frames to the panel from a display task so show() returns while the
+// I2C transfer runs. Needs a second core; C3 (unicore) and native stay synchronous.
+#ifndef OLED_ASYNC
+#  if defined(BOARD_NATIVE) || defined(CONFIG_FREERTOS_UNICORE)
+#    define OLED_ASYNC 0
+#  else
+#    define OLED_ASYNC 1
+#  endif
+#endif
+#ifndef OLED_TASK_CORE
+#define OLED_TASK_CORE 0   // loop() runs on core 1
+#endif
+#ifndef OLED_TASK_PRIO
+#define OLED_TASK_PRIO 1
+#endif
+
 class OledView {
 public:
+  // Transfer counters. Only pages drawn on since the last show() are
+  // compared with what the panel already has, and only the differing tile
+  // span of each is sent.
+  struct Stats {
+    uint32_t frames;      // show() calls that handed a frame over
+    uint32_t idle;        // ... of which found nothing to send
+    uint32_t dropped;     // show() calls made while the panel was still busy
+    uint32_t pages;       // page transfers
+    uint64_t bytes;       // bus bytes (data + per-page addressing)
+    uint32_t lastBytes;   // bus bytes of the latest frame
+    uint32_t flushUs;     // duration of the latest panel transfer
+    uint32_t flushMaxUs;  // longest panel transfer
+  };
+
   bool begin();
   void clear();
   void println(const String& s);
   void show();
+
+  // Re-offer a frame that show() dropped because the panel was busy. Call
+  // once per loop(); a no-op when nothing is waiting.
+  void poll() { if (_retry && !busy()) show(); }
+
+  // A dropped frame is waiting for poll().
+  bool retrying() const { return _retry; }
+
+  // A transfer is still in progress (always false when synchronous).
+  bool busy() const { return _busy.load(std::memory_order_acquire); }
   void statusPage(const char* title, const char* line1, const char* line2);
 
+  // Redraw one text row in place: blank its 12-px band, then draw s at baseline y.
+  void drawRow(int y, const char* s);
+
+  // Times the screen was cleared; lets partial painters notice someone else drew.
+  uint32_t clears() const { return _clears; }
+
+  // ---- Hardware scroll ----
+  // Panel RAM as a ring of SCROLL_ROWS text rows. Advancing moves the display
+  // start line down one row, so a scroll only sends the row drawn into the
+  // slot that came free instead of the whole screen. Covers the full panel
+  // (the controllers scroll all 64 lines); clear() leaves this mode.
+  static constexpr uint8_t SCROLL_ROW_PX = 16;                 // page-aligned: 2 pages per row
+  static constexpr uint8_t SCROLL_ROWS   = 64 / SCROLL_ROW_PX;
+
+  void scrollBegin();                        // clear and enter ring mode at start line 0
+  void scrollAdvance();                      // drop the top row; its slot becomes the bottom row
+  void scrollRow(uint8_t k, const char* s);  // redraw visible row k (0 = top)
+  bool scrolling() const { return _scroll; }
+
+  const Stats& stats() const { return _stats; }
+
+#if defined(BOARD_NATIVE)
+  // Native bench access to the shim display (bus counters, panel RAM).
+  U8G2& shimDisplay() { return u8g2; }
+#endif
+
 private:
+  static constexpr uint8_t  PAGES = 8;                // 8-px rows
+  static constexpr uint8_t  TILES = 16;               // 8-px columns
+  static constexpr uint8_t  PAGE_CMD_BYTES = 4;       // ctrl + page + column hi/lo per page
+  static constexpr uint8_t  LINE_CMD_BYTES = 2;       // ctrl + set start line
+
   // SH1106 128x64 over I2C (full framebuffer)
   U8G2_SH1106_128X64_NONAME_F_HW_I2C u8g2{U8G2_R0, U8X8_PIN_NONE};
   int cursorY = 12;
+  uint32_t _clears = 0;
+
+  // The U8g2 buffer is the back buffer the UI draws into. _shadow is the
+  // front buffer: show() copies the changed spans into it and the transfer
+  // reads only from it, so drawing the next frame never races the bus.
+  struct Span { uint8_t x, w; };         // tile span of one page (w = 0: nothing)
+  uint8_t _dirty = 0;                    // bit p: page p drawn on since the last show()
+  uint8_t _shadow[PAGES * TILES * 8] = {}; // what the panel holds once the transfer ends
+  Span    _span[PAGES] = {};             // the transfer in progress / last sent
+  int16_t _jobLine = -1;                 // start line to set after the tiles (-1: unchanged)
+  bool    _retry = false;                // a show() was dropped; poll() re-offers it
+  std::atomic<bool> _busy{ false };      // set by show(), cleared when the transfer ends
+  Stats   _stats{};
+
+  bool    _scroll = false;               // ring mode (see scrollBegin)
+  uint8_t _top = 0;                      // ring slot shown as the top row
+  uint8_t _line = 0;                     // display start line wanted
+  uint8_t _panelLine = 0;                // ... and the one the panel has after the last show()
+
+#if OLED_ASYNC
+  TaskHandle_t _task = nullptr;
+  static void _taskMain(void* arg);
+#endif
+
+  void _touch(int y0, int y1);           // mark pages covering rows [y0, y1)
+  void _synced();                        // panel now equals the buffer
+  void _flush();                         // send _span from _shadow
 };
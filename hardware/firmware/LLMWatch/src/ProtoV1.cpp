@@ -1,5 +1,6 @@
 #include "ProtoV1.hpp"
 #include "BleLink.hpp"
+#include <memory>
 
 /// <summary>Store transport reference only.</summary>
 ProtoV1::ProtoV1(BleLink& link) noexcept : _link(link) {}
@@ -7,44 +8,80 @@ ProtoV1::ProtoV1(BleLink& link) noexcept : _link(link) {}
 /// <summary>Register inbound line handler and announce HELLO.</summary>
 void ProtoV1::begin(const char* deviceName, const ProtoHandlers& h) {
   _h = h;
+  _setV2(false);
   _link.begin(deviceName, [this](const String& line) { _onLine(line); });
 
   // Send a simple HELLO so the peer can sanity-check the protocol.
-  String hello = String("HELLO name=") + deviceName + " proto=1";
+  // "max=2" offers binary framing; v1-only hosts ignore the extra key.
+  String hello = String("HELLO name=") + deviceName + " proto=1 max=2";
   _link.sendLine(hello);
 }
 
-/// <summary>Pump BLE link, resends, and heartbeats.</summary>
+/// <summary>Pump BLE link, resends, SACKs, and heartbeats.</summary>
 void ProtoV1::loop(uint32_t nowMs) {
   _link.loop();
+
+  // A new connection starts in v1 until it negotiates again.
+  const bool up = _link.isConnected();
+  if (_wasConnected && !up) { _suspendBody(); _setV2(false); _setWindow(0); _syncEnd(true); }
+  if (_wasConnected != up) _resetCredit();   // counts are per connection
+  if (!_wasConnected && up) { _lp.reset(nowMs); _lpTx = _link.txBytes(); _lpRx = 0; }
+  _wasConnected = up;
+
   _txPump(nowMs);
+  if (_win) {
+    _txw.tick(nowMs, _retx.stats().rtoMs, [this](uint32_t seq, const DataWindow::Chunk& c) {
+      _sendSeq(_bodyOut.id, seq, c.data, c.len, c.nl);
+    });
+    // Chunks that arrived in order since the last pass share one SACK.
+    if (_rxw.unacked()) _sendSack();
+  }
+  _pumpBody();
+  _flushTok();
+  _grantCredit(false);
+  _syncStep();
+  if (up) _linkStep(nowMs);
 
-  // Heartbeat (optional)
-  if (nowMs - _lastPingMs >= PING_EVERY_MS) {
+  // Heartbeat (optional); an idle link has asked to be left alone
+  if (nowMs - _lastPingMs >= (_lp.mode() == LinkProfile::Mode::Idle ? PROTO_PING_IDLE_MS : PING_EVERY_MS)) {
     _lastPingMs = nowMs;
-    _link.sendLine(String("PING ts=") + nowMs);
+    if (_v2) _sendLenFrame(ProtoV2::Type::Ping, 0, nowMs, false);
+    else     _link.sendLine(String("PING ts=") + nowMs, TxPrio::Control);
   }
 }
 
-/// <summary>Send a prompt header + DATA lines. Only the header expects ACK.</summary>
+/// <summary>
+/// Switch profiles (Fast while text streams: tokens, bodies, a sync walk;
+/// Idle once LinkProfile has seen BLE_IDLE_AFTER_MS of quiet), then charge
+/// this pass's traffic and RTT samples to the one in use.
+/// </summary>
+void ProtoV1::_linkStep(uint32_t nowMs) {
+  const bool busy = _lpBusy || _bodyOut.stage != BodyStage::Idle || !_bodyNext.empty() || _bodyActive
+                 || _cr.held.length() || _sync.id;
+  _lpBusy = false;
+  if ((busy ? _lp.busy(nowMs) : _lp.tick(nowMs)) && _lpOn) _link.requestParams(LinkProfile::params(_lp.mode()));
+  _lp.granted(_link.connInterval(), _link.connLatency());
+
+  // What started this pass counts for the profile it switched to.
+  const uint32_t tx = _link.txBytes();
+  _lp.bytes(tx - _lpTx, _lpRx);
+  _lpTx = tx;
+  _lpRx = 0;
+  const RetxWheel::Stats& rs = _retx.stats();
+  if (rs.samples != _lpRtt) { _lpRtt = rs.samples; _lp.rtt(rs.lastRttMs); }
+}
+
+/// <summary>Send a prompt header + DATA lines, streamed as bulk room frees up. Only the header expects ACK.</summary>
 uint32_t ProtoV1::sendPrompt(const String& text) {
   const uint32_t id = _nextId++;
-  const String hdr = String("PROMPT id=") + id + " len=" + text.length();
-  _txEnqueue(id, hdr);                // track for ACK
-  _link.sendLine(hdr);
-
-  // DATA lines (chunk into ~120 chars to keep it readable)
-  const size_t CHUNK = 120;
-  for (size_t i = 0; i < text.length(); i += CHUNK) {
-    String chunk = text.substring(i, i + CHUNK);
-    _link.sendLine(String("DATA ") + chunk);
-  }
+  _queueText(id, text, true);
   return id;
 }
 
 /// <summary>Send a DSL command. The whole string after 'cmd=' is considered the command.</summary>
 uint32_t ProtoV1::sendDsl(const String& cmd) {
   const uint32_t id = _nextId++;
+  if (_v2) { _sendFrame(ProtoV2::Type::Dsl, id, cmd, true); return id; }
   String line = String("DSL id=") + id + " cmd=" + cmd;
   _txEnqueue(id, line);
   _link.sendLine(line);
@@ -54,6 +91,7 @@ uint32_t ProtoV1::sendDsl(const String& cmd) {
 /// <summary>Send SAVE with one line. Expects ACK + later SAVE_OK/ERR.</summary>
 uint32_t ProtoV1::sendSaveLine(const String& line) {
   const uint32_t id = _nextId++;
+  if (_v2) { _sendFrame(ProtoV2::Type::Save, id, line, true); return id; }
   // Note: keep the payload on the same line for simplicity
   String msg = String("SAVE id=") + id + " line=" + line;
   _txEnqueue(id, msg);
@@ -64,6 +102,7 @@ uint32_t ProtoV1::sendSaveLine(const String& line) {
 /// <summary>Request the whole body (READALL). Expects ACK + BODY/DATA.../BODY_END.</summary>
 uint32_t ProtoV1::sendReadAll() {
   const uint32_t id = _nextId++;
+  if (_v2) { _sendFrame(ProtoV2::Type::ReadAll, true, id, nullptr, 0, true); return id; }
   String msg = String("READALL id=") + id;
   _txEnqueue(id, msg);
   _link.sendLine(msg);
@@ -73,6 +112,7 @@ uint32_t ProtoV1::sendReadAll() {
 /// <summary>Ask host to clear the journal. Expects ACK + CLEAR_OK/ERR.</summary>
 uint32_t ProtoV1::sendClear() {
   const uint32_t id = _nextId++;
+  if (_v2) { _sendFrame(ProtoV2::Type::Clear, true, id, nullptr, 0, true); return id; }
   String msg = String("CLEAR id=") + id;
   _txEnqueue(id, msg);
   _link.sendLine(msg);
@@ -81,192 +121,1328 @@ uint32_t ProtoV1::sendClear() {
 
 
 /// <summary>ACK helper.</summary>
-void ProtoV1::sendAck(uint32_t id)        { _link.sendLine(String("ACK id=")  + id); }
+void ProtoV1::sendAck(uint32_t id) {
+  if (_v2) _sendFrame(ProtoV2::Type::Ack, true, id, nullptr, 0, false);
+  else     _link.sendLine(String("ACK id=")  + id, TxPrio::Control);
+}
+
 /// <summary>NACK helper.</summary>
-void ProtoV1::sendNack(uint32_t id, const String& reason) { _link.sendLine(String("NACK id=") + id + " reason=" + reason); }
+void ProtoV1::sendNack(uint32_t id, const String& reason) {
+  if (_v2) _sendFrame(ProtoV2::Type::Nack, id, reason, false);
+  else     _link.sendLine(String("NACK id=") + id + " reason=" + reason, TxPrio::Control);
+}
 
 /// <summary>Reply OK/ERR for save operations.</summary>
-void ProtoV1::sendSaveOk(uint32_t id, bool ok) { _link.sendLine(String(ok ? "SAVE_OK id=" : "SAVE_ERR id=") + id); }
+void ProtoV1::sendSaveOk(uint32_t id, bool ok) {
+  if (_v2) _sendFrame(ok ? ProtoV2::Type::SaveOk : ProtoV2::Type::SaveErr, true, id, nullptr, 0, false);
+  else     _link.sendLine(String(ok ? "SAVE_OK id=" : "SAVE_ERR id=") + id);
+}
 
-/// <summary>Send a whole body with length for integrity; ends with BODY_END.</summary>
+/// <summary>
+/// Send a whole body with length for integrity; ends with BODY_END.
+/// Streamed from a copy like a windowed body, so a body larger than the bulk
+/// queue waits for room instead of losing its tail.
+/// </summary>
 void ProtoV1::sendBody(uint32_t id, const String& body) {
-  _link.sendLine(String("BODY id=") + id + " len=" + body.length());
-  const size_t CHUNK = 120;
-  for (size_t i = 0; i < body.length(); i += CHUNK) {
-    _link.sendLine(String("DATA ") + body.substring(i, i + CHUNK));
+  _queueText(id, body, false);
+}
+
+/// <summary>Start a streamed body; the header goes out as soon as there is room.</summary>
+void ProtoV1::sendBody(uint32_t id, size_t len, BodySource src, BodyRewind rewind) {
+  BodyOut b;
+  b.src = std::move(src);
+  b.rewind = std::move(rewind);
+  b.id = id;
+  b.total = len;
+  b.stage = BodyStage::Header;
+  if (_bodyOut.stage != BodyStage::Idle && _bodyOut.prompt) {   // a prompt is not cut off
+    _bodyNext.insert(_bodyNext.begin(), std::move(b));
+    return;
   }
-  _link.sendLine(String("BODY_END id=") + id);
+  _bodyOut = std::move(b);
+  _txw.reset();   // chunks of a replaced stream are not resent
+  _pumpBody();
 }
 
-/// <summary>Transport connectivity hint.</summary>
-bool ProtoV1::connected() const noexcept { return _link.isConnected(); }
+/// <summary>PROMPT/BODY text: stream it from a copy (resumable), after any stream still going.</summary>
+void ProtoV1::_queueText(uint32_t id, const String& text, bool prompt) {
+  struct Copy { String text; size_t off; };
+  auto c = std::make_shared<Copy>(Copy{ text, 0 });
+  BodyOut b;
+  b.src = [c](uint8_t* buf, size_t cap) {
+    const size_t n = std::min(cap, c->text.length() - c->off);
+    memcpy(buf, c->text.c_str() + c->off, n);
+    c->off += n;
+    return n;
+  };
+  b.rewind = [c] { c->off = 0; return true; };
+  b.id = id;
+  b.total = text.length();
+  b.prompt = prompt;
+  b.stage = BodyStage::Header;
+  if (_bodyOut.stage != BodyStage::Idle) { _bodyNext.push_back(std::move(b)); return; }
+  _bodyOut = std::move(b);
+  _pumpBody();
+}
 
-/// <summary>Inbound line parser. Accepts both new v1 frames and your legacy "TOK:"/"TOK_END".</summary>
-void ProtoV1::_onLine(const String& raw) {
-  const String line = _trim(raw);
+/// <summary>
+/// Advance the streamed body while the bulk class has room: header, then
+/// DATA sized to fill one notification (v1 lines also end at '\n'), then
+/// BODY_END. The staging buffer is refilled from the source as it drains.
+/// Windowed, the header and BODY_END are tracked for ACK, the text goes out
+/// as SEQ chunks no more than the window ahead of the peer's SACKs, and
+/// BODY_END waits until every chunk is SACKed. Nothing moves while the
+/// link is down: the stream is suspended (or dropped) when loop() sees that.
+/// A send may hand a SACK straight back (Cmd::Sack pumps again); that call
+/// only asks for another pass, so _bodyOutBuf and _bodyOut never shift
+/// under the one in progress.
+/// </summary>
+void ProtoV1::_pumpBody() {
+  if (_bodyPumping) { _bodyRepump = true; return; }
+  _bodyPumping = true;
+  do {
+    _bodyRepump = false;
+    _pumpBodyOnce();
+  } while (_bodyRepump);
+  _bodyPumping = false;
+}
+
+void ProtoV1::_pumpBodyOnce() {
+  BodyOut& b = _bodyOut;
+  if (!_link.isConnected()) return;
+  while (b.stage != BodyStage::Idle) {
+    const size_t room = _link.txFree(TxPrio::Bulk);
+    if (b.stage == BodyStage::Header) {
+      if (room < BODY_MSG_ROOM) return;
+      const bool track = _win != 0 || b.prompt;   // a PROMPT header is always ACKed
+      if (_v2) {
+        uint8_t v[10];
+        size_t k = ProtoV2::putVarint(v, b.total);
+        if (b.from) k += ProtoV2::putVarint(v + k, b.from);
+        _sendFrame(b.prompt ? ProtoV2::Type::Prompt : ProtoV2::Type::Body, true, b.id, v, k, track);
+      } else {
+        String hdr = String(b.prompt ? "PROMPT id=" : "BODY id=") + b.id + " len=" + b.total;
+        if (b.from) hdr += String(" off=") + b.from;
+        if (track) _txEnqueue(b.id, hdr, TxPrio::Bulk);
+        _link.sendLine(hdr, TxPrio::Bulk);
+      }
+      _txw.reset();
+      // Chunks wait for the BODY header's ACK, so the peer is collecting when they land.
+      b.stage = (_win && !b.prompt) ? BodyStage::HeaderAck : BodyStage::Data;
+      continue;
+    }
+    if (b.stage == BodyStage::HeaderAck) {
+      if (_retx.pending(b.id)) return;
+      b.stage = BodyStage::Data;
+      continue;
+    }
+    if (b.stage == BodyStage::End) {
+      if (_win && !_txw.empty()) return;
+      if (room < BODY_MSG_ROOM) return;
+      if (!b.prompt) {
+        const bool track = _win != 0;
+        const uint32_t crc = ~b.crc;
+        if (_v2) {
+          uint8_t v[5];
+          _sendFrame(ProtoV2::Type::BodyEnd, true, b.id, v, ProtoV2::putVarint(v, crc), track);
+        } else {
+          const String end = String("BODY_END id=") + b.id + " crc=" + crc;
+          if (track) _txEnqueue(b.id, end, TxPrio::Bulk);
+          _link.sendLine(end, TxPrio::Bulk);
+        }
+        // Plain DATA is never ACKed: the receiver may still ask for the tail.
+        if (b.rewind) _bodyHeld = std::move(b);
+      }
+      b = BodyOut{};
+      if (_bodyNext.empty()) return;
+      b = std::move(_bodyNext.front());
+      _bodyNext.erase(_bodyNext.begin());
+      continue;
+    }
 
-   // Keep a simple BODY accumulator alongside token streaming.
-  static bool bodyActive = false;
-  static uint32_t bodyId = 0;
-  static String bodyBuf;
+    const size_t chunk = std::min(_dataChunk(), sizeof(_bodyOutBuf));
+    if (b.len - b.off < chunk && !b.eof) {
+      memmove(_bodyOutBuf, _bodyOutBuf + b.off, b.len - b.off);
+      b.len -= b.off;
+      b.off = 0;
+      while (b.len < sizeof(_bodyOutBuf) && !b.eof) {
+        const size_t got = b.src(_bodyOutBuf + b.len, sizeof(_bodyOutBuf) - b.len);
+        if (got == 0) b.eof = true;
+        b.len += got;
+      }
+    }
+    if (b.skip) {
+      // Resumed: the peer has these; they only feed the CRC.
+      const size_t k = std::min(b.skip, b.len - b.off);
+      b.crc = ProtoV2::crc32(_bodyOutBuf + b.off, k, b.crc);
+      b.off += k;
+      b.skip -= k;
+      if (b.skip && !b.eof) continue;
+    }
+    if (b.off == b.len) { b.stage = BodyStage::End; continue; }
+
+    const uint8_t* p = _bodyOutBuf + b.off;
+    size_t n = std::min(chunk, b.len - b.off);
+    size_t used = n;
+    if (!_v2) {
+      const uint8_t* nl = (const uint8_t*)memchr(p, '\n', n);
+      if (nl) { n = (size_t)(nl - p); used = n + 1; }
+    }
+    if (_win) {
+      if (!_txw.room(_win) || room < n + (_v2 ? SEQ_FRAME_OVERHEAD : SEQ_LINE_OVERHEAD)) return;
+      const bool nl = used > n;
+      const uint32_t seq = _txw.push(p, n, nl, millis());
+      b.crc = ProtoV2::crc32(p, used, b.crc);
+      b.off += used;   // before the send: the chunk is out as far as the stream is concerned
+      _sendSeq(b.id, seq, p, n, nl);
+      continue;
+    }
+    if (room < n + (_v2 ? DATA_FRAME_OVERHEAD : DATA_LINE_OVERHEAD)) return;
+    if (_v2) {
+      _sendFrame(ProtoV2::Type::Data, false, 0, p, n, false);
+      b.crc = ProtoV2::crc32(p, n, b.crc);
+    } else {
+      _txLine = "DATA ";
+      _txLine.concat((const char*)p, n);
+      _link.sendLine(_txLine, TxPrio::Bulk);
+      // The receiver trims the line end and adds one '\n'; a blank line adds nothing.
+      size_t k = n;
+      while (k && (p[k - 1] == ' ' || p[k - 1] == '\r' || p[k - 1] == '\t')) k--;
+      if (k) b.crc = ProtoV2::crc32((const uint8_t*)"\n", 1, ProtoV2::crc32(p, k, b.crc));
+    }
+    b.off += used;
+  }
+}
+
+/// <summary>
+/// The link dropped (or a BODY header went unACKed): keep a resumable
+/// outbound body for RESUME; one that cannot resume is dropped.
+/// </summary>
+void ProtoV1::_suspendBody() {
+  BodyOut& b = _bodyOut;
+  if (b.stage == BodyStage::Idle) return;
+  if (b.rewind && !b.prompt) {
+    b.stage = BodyStage::Idle;
+    _bodyHeld = std::move(b);
+    _bs.suspended++;
+  }
+  b = BodyOut{};
+}
+
+/// <summary>Rewind b and set it to send from off (header first). False if the source cannot rewind.</summary>
+bool ProtoV1::_restartBody(BodyOut& b, size_t off) {
+  if (!b.rewind || !b.rewind()) return false;
+  b.stage = BodyStage::Header;
+  b.eof = false;
+  b.len = b.off = 0;
+  b.crc = 0xFFFFFFFFu;
+  b.from = b.skip = off;
+  return true;
+}
 
-  if (line.length() == 0) return;
+/// <summary>Ask for the rest of the half-received body; tracked for ACK like READALL.</summary>
+uint32_t ProtoV1::resumeBody() {
+  if (!_bodyActive) return 0;
+  const uint32_t off = _bodyExact ? _bodyBuf.length() : 0;
+  if (_v2) {
+    uint8_t v[5];
+    _sendFrame(ProtoV2::Type::Resume, true, _bodyId, v, ProtoV2::putVarint(v, off), true);
+  } else {
+    const String msg = String("RESUME id=") + _bodyId + " off=" + off;
+    _txEnqueue(_bodyId, msg);
+    _link.sendLine(msg);
+  }
+  return _bodyId;
+}
 
-    // --- DATA handling for both TOK streaming and BODY accumulation ---
-  if (_startsWith(line, "DATA ")) {
-    String payload = line.substring(5);
+/// <summary>FIND with the terms as the rest of the line (they may hold spaces).</summary>
+uint32_t ProtoV1::sendFind(const String& terms) {
+  const uint32_t id = _nextId++;
+  if (_v2) { _sendFrame(ProtoV2::Type::Find, id, terms, true); return id; }
+  String msg = String("FIND id=") + id + " q=" + terms;
+  _txEnqueue(id, msg);
+  _link.sendLine(msg);
+  return id;
+}
+
+/// <summary>Start walking the tree from [t0, t1); _syncStep() sends the queries.</summary>
+uint32_t ProtoV1::sendSync(uint32_t t0, uint32_t t1) {
+  _syncEnd(false);
+  _ss = SyncStats{};
+  _sync.id = _nextId++;
+  _sync.todo.push_back(SyncRange{ t0, t1, 1 });
+  _syncStep();
+  return _sync.id;
+}
 
-    // If a BODY is active, accumulate it
-    if (bodyActive) {
-      bodyBuf += payload;
-      bodyBuf += '\n'; // optional: preserve newlines
+/// <summary>
+/// Keep the walk going: SYNCs for pending ranges while fewer than
+/// PROTO_SYNC_PARALLEL are open, the next FETCH once the last body is in,
+/// and onSyncDone when nothing is left.
+/// </summary>
+void ProtoV1::_syncStep() {
+  if (!_sync.id) return;
+  bool open = false;
+  for (SyncQuery& q : _sync.open) {
+    if (!q.id && !_sync.todo.empty()) {
+      q.r = _sync.todo.back();
+      _sync.todo.pop_back();
+      q.id = _nextId++;
+      _ss.queries++;
+      if (q.r.depth > _ss.depth) _ss.depth = q.r.depth;
+      if (_v2) {
+        uint8_t v[10];
+        size_t k = ProtoV2::putVarint(v, q.r.t0);
+        k += ProtoV2::putVarint(v + k, q.r.t1);
+        _sendFrame(ProtoV2::Type::Sync, true, q.id, v, k, true);
+      } else {
+        const String msg = String("SYNC id=") + q.id + " t0=" + q.r.t0 + " t1=" + q.r.t1;
+        _txEnqueue(q.id, msg);
+        _link.sendLine(msg);
+      }
     }
+    open |= q.id != 0;
+  }
+  if (!_sync.fetchId && !_sync.fetches.empty()) {
+    _sync.fetching = _sync.fetches.front();
+    _sync.fetches.erase(_sync.fetches.begin());
+    const SyncFetch& f = _sync.fetching;
+    _sync.fetchId = _nextId++;
+    _ss.fetches++;
+    if (_v2) {
+      uint8_t v[10 + 4 * JournalSync::LEAF];
+      size_t k = ProtoV2::putVarint(v, f.t0);
+      k += ProtoV2::putVarint(v + k, f.t1);
+      for (uint8_t i = 0; i < f.n; ++i, k += 4)
+        for (uint8_t b = 0; b < 4; ++b) v[k + b] = (uint8_t)(f.keys[i] >> (8 * b));
+      _sendFrame(ProtoV2::Type::Fetch, true, _sync.fetchId, v, k, true);
+    } else {
+      String msg = String("FETCH id=") + _sync.fetchId + " t0=" + f.t0 + " t1=" + f.t1;
+      for (uint8_t i = 0; i < f.n; ++i) {
+        char h[10];
+        snprintf(h, sizeof(h), "%c%lx", i ? ',' : '=', (unsigned long)f.keys[i]);
+        if (!i) msg += " k";
+        msg += h;
+      }
+      _txEnqueue(_sync.fetchId, msg);
+      _link.sendLine(msg);
+    }
+  }
+  if (open || !_sync.todo.empty() || _sync.fetchId || !_sync.fetches.empty()) return;
+  _ss.complete = _ss.failed == 0;
+  _syncEnd(true);
+}
 
-    // Also forward to onTok for streaming text UIs (harmless for BODY)
-    if (_h.onTok) _h.onTok(payload);
+/// <summary>Drop the walk (its queries are no longer resent); report it when notify.</summary>
+void ProtoV1::_syncEnd(bool notify) {
+  const uint32_t id = _sync.id;
+  if (!id) return;
+  for (const SyncQuery& q : _sync.open) if (q.id) _retx.remove(q.id);
+  if (_sync.fetchId) {
+    _retx.remove(_sync.fetchId);
+    if (_bodyActive && _bodyId == _sync.fetchId) { _bodyActive = false; _bodyId = 0; _bodyBuf = ""; }
+  }
+  _sync = SyncState{};
+  _syncOwn.clear();
+  _syncOwn.shrink_to_fit();
+  if (notify && _h.onSyncDone) _h.onSyncDone(id);
+}
+
+/// <summary>A query or fetch of the walk was NACKed or given up: that part stays unsynced.</summary>
+void ProtoV1::_syncFail(uint32_t id) {
+  if (!_sync.id || !id) return;
+  bool hit = false;
+  for (SyncQuery& q : _sync.open) if (q.id == id) { q.id = 0; hit = true; }
+  if (_sync.fetchId == id) { _sync.fetchId = 0; hit = true; }
+  if (!hit) return;
+  _ss.failed++;
+  _syncStep();
+}
+
+/// <summary>Local keys of [t0, t1) into _syncOwn (sized to fit); returns how many.</summary>
+size_t ProtoV1::_syncLocal(uint32_t t0, uint32_t t1) {
+  if (_syncOwn.size() < JournalSync::LEAF) _syncOwn.resize(JournalSync::LEAF);
+  size_t n = _h.onSyncKeys(t0, t1, _syncOwn.data(), _syncOwn.size());
+  if (n > _syncOwn.size()) {
+    _syncOwn.resize(n);
+    n = std::min(_h.onSyncKeys(t0, t1, _syncOwn.data(), n), n);
+  }
+  return n;
+}
+
+/// <summary>
+/// SUM or KEYS for one of our SYNCs. Differing children are walked into
+/// (or fetched whole when this end has nothing there, or they cannot split);
+/// a key list is compared with ours and the missing keys fetched.
+/// </summary>
+void ProtoV1::_syncReply(const Msg& m) {
+  _retx.ack(m.id, millis());
+  SyncQuery* q = nullptr;
+  for (SyncQuery& o : _sync.open) if (_sync.id && o.id == m.id) q = &o;
+  if (!q) return;   // an answer to a resend, or to a sync that ended
+  const SyncRange r = q->r;
+  q->id = 0;
+  if (!_h.onSyncDigest || !_h.onSyncKeys) { _ss.failed++; _syncStep(); return; }
+
+  if (m.cmd == Cmd::Keys) {
+    _ss.leaves++;
+    uint32_t peer[JournalSync::LEAF];
+    const size_t np = _syncKeyList(m.text, peer, JournalSync::LEAF);
+    const size_t nl = _syncLocal(r.t0, r.t1);
+    SyncFetch f{ r.t0, r.t1, 0, {} };
+    for (size_t i = 0; i < np; ++i)
+      if (std::find(_syncOwn.begin(), _syncOwn.begin() + nl, peer[i]) == _syncOwn.begin() + nl) f.keys[f.n++] = peer[i];
+    for (size_t i = 0; i < nl; ++i)
+      if (std::find(peer, peer + np, _syncOwn[i]) == peer + np) _ss.peerLacks++;
+    if (f.n) _sync.fetches.push_back(f);
+    _syncStep();
     return;
   }
 
+  _ss.sums++;
+  JournalSync::Digest peer[JournalSync::FANOUT], own[JournalSync::FANOUT];
+  if (!_syncDigestList(m.text, peer)) { _ss.failed++; _syncStep(); return; }
+  _h.onSyncDigest(r.t0, r.t1, own);
+  for (uint8_t i = 0; i < JournalSync::FANOUT; ++i) {
+    if (peer[i] == own[i]) continue;
+    const uint32_t c0 = JournalSync::split(r.t0, r.t1, i), c1 = JournalSync::split(r.t0, r.t1, i + 1);
+    if (!peer[i].count) { _ss.peerLacks += own[i].count; continue; }
+    if (!own[i].count || c1 - c0 < 2) _sync.fetches.push_back(SyncFetch{ c0, c1, 0, {} });
+    else _sync.todo.push_back(SyncRange{ c0, c1, (uint8_t)(r.depth + 1) });
+  }
+  _syncStep();
+}
+
+/// <summary>
+/// A FETCH body: store each record that belongs to the request and is not
+/// here yet (a whole-range fetch may overlap what we have).
+/// </summary>
+void ProtoV1::_syncBody(const String& body) {
+  const SyncFetch f = _sync.fetching;
+  _sync.fetchId = 0;
+  const bool ok = JournalSync::parse(body.c_str(), body.length(), [&](uint32_t ts, const char* t, size_t n) {
+    const uint32_t k = JournalSync::key(ts, t, n);
+    if (ts < f.t0 || ts >= f.t1 || (f.n && std::find(f.keys, f.keys + f.n, k) == f.keys + f.n)) { _ss.bad++; return; }
+    const size_t nl = _syncLocal(ts, ts + 1);
+    if (std::find(_syncOwn.begin(), _syncOwn.begin() + nl, k) != _syncOwn.begin() + nl) { _ss.dupes++; return; }
+    _ss.fetched++;
+    if (_h.onSyncEntry) _h.onSyncEntry(ts, _argFrom(Slice{ t, n }));
+  });
+  if (!ok) _ss.bad++;
+  _syncStep();
+}
 
-  // Extract CMD + tokens
-  int sp = line.indexOf(' ');
-  String cmd = (sp < 0) ? line : line.substring(0, sp);
-  String rest = (sp < 0) ? String() : line.substring(sp + 1);
-
-  // Parse simple key=value tokens into a tiny map
-  std::map<String, String> kv;
-  int pos = 0;
-  while (pos < (int)rest.length()) {
-    int next = rest.indexOf(' ', pos);
-    String tok = (next < 0) ? rest.substring(pos) : rest.substring(pos, next);
-    if (tok.length() > 0) {
-      int eq = tok.indexOf('=');
-      if (eq > 0) {
-        kv[tok.substring(0, eq)] = tok.substring(eq + 1);
+/// <summary>
+/// Answer a SYNC from the local journal: the key list when there are at most
+/// JournalSync::LEAF entries in the range, else the children's digests.
+/// </summary>
+void ProtoV1::_syncAnswer(uint32_t id, uint32_t t0, uint32_t t1) {
+  JournalSync::Digest d[JournalSync::FANOUT];
+  _h.onSyncDigest(t0, t1, d);
+  uint32_t total = 0;
+  for (const JournalSync::Digest& c : d) total += c.count;
+  if (total <= JournalSync::LEAF) {
+    uint32_t keys[JournalSync::LEAF];
+    const size_t n = _h.onSyncKeys(t0, t1, keys, JournalSync::LEAF);
+    if (n <= JournalSync::LEAF) {
+      if (_v2) {
+        uint8_t v[4 * JournalSync::LEAF];
+        for (size_t i = 0; i < n; ++i)
+          for (uint8_t b = 0; b < 4; ++b) v[4 * i + b] = (uint8_t)(keys[i] >> (8 * b));
+        _sendFrame(ProtoV2::Type::Keys, true, id, v, 4 * n, false);
+      } else {
+        String msg = String("KEYS id=") + id + " k=";
+        for (size_t i = 0; i < n; ++i) {
+          char h[10];
+          snprintf(h, sizeof(h), i ? ",%lx" : "%lx", (unsigned long)keys[i]);
+          msg += h;
+        }
+        _link.sendLine(msg);
       }
+      return;
+    }
+  }
+  if (_v2) {
+    uint8_t v[9 * JournalSync::FANOUT];
+    size_t k = 0;
+    for (const JournalSync::Digest& c : d) {
+      k += ProtoV2::putVarint(v + k, c.count);
+      if (!c.count) continue;
+      for (uint8_t b = 0; b < 4; ++b) v[k + b] = (uint8_t)(c.sum >> (8 * b));
+      k += 4;
+    }
+    _sendFrame(ProtoV2::Type::Sum, true, id, v, k, false);
+  } else {
+    String msg = String("SUM id=") + id + " d=";
+    for (uint8_t i = 0; i < JournalSync::FANOUT; ++i) {
+      char h[24];
+      if (d[i].count) snprintf(h, sizeof(h), "%s%lu:%lx", i ? "," : "", (unsigned long)d[i].count, (unsigned long)d[i].sum);
+      else            snprintf(h, sizeof(h), "%s0", i ? "," : "");
+      msg += h;
     }
-    if (next < 0) break;
-    pos = next + 1;
+    _link.sendLine(msg);
   }
+}
+
+/// <summary>Keys of a KEYS/FETCH list: 4-byte LE each (v2), or comma-separated hex (v1).</summary>
+size_t ProtoV1::_syncKeyList(const Slice& s, uint32_t* out, size_t max) const {
+  size_t n = 0;
+  if (_v2) {
+    const uint8_t* p = (const uint8_t*)s.p;
+    for (size_t i = 0; i + 4 <= s.n && n < max; i += 4)
+      out[n++] = (uint32_t)p[i] | ((uint32_t)p[i + 1] << 8) | ((uint32_t)p[i + 2] << 16) | ((uint32_t)p[i + 3] << 24);
+    return n;
+  }
+  for (size_t i = 0; i < s.n && n < max; ) {
+    uint32_t v = 0;
+    const size_t from = i;
+    for (; i < s.n && isxdigit((unsigned char)s.p[i]); ++i)
+      v = (v << 4) | (uint32_t)(s.p[i] <= '9' ? s.p[i] - '0' : (s.p[i] | 0x20) - 'a' + 10);
+    if (i == from) break;
+    out[n++] = v;
+    if (i < s.n && s.p[i] == ',') i++;
+  }
+  return n;
+}
 
-  // Handle a few core commands
-  if (cmd == "ACK") {
-    auto it = kv.find("id");
-    if (it != kv.end()) {
-      uint32_t id = it->second.toInt();
-      _pending.erase(id);
-      if (_h.onAck) _h.onAck(id);
+/// <summary>FANOUT child digests of a SUM: varint count[, 4-byte LE sum] (v2), or "count:hexsum" / "0" by commas (v1).</summary>
+bool ProtoV1::_syncDigestList(const Slice& s, JournalSync::Digest* out) const {
+  if (_v2) {
+    const uint8_t* p = (const uint8_t*)s.p;
+    const uint8_t* end = p + s.n;
+    for (uint8_t i = 0; i < JournalSync::FANOUT; ++i) {
+      out[i] = JournalSync::Digest{};
+      if (!ProtoV2::getVarint(p, end, out[i].count)) return false;
+      if (!out[i].count) continue;
+      if (end - p < 4) return false;
+      out[i].sum = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+      p += 4;
     }
-    return;
+    return true;
   }
+  size_t i = 0;
+  for (uint8_t c = 0; c < JournalSync::FANOUT; ++c) {
+    out[c] = JournalSync::Digest{};
+    if (c) { if (i >= s.n || s.p[i] != ',') return false; i++; }
+    const size_t from = i;
+    for (; i < s.n && s.p[i] >= '0' && s.p[i] <= '9'; ++i) out[c].count = out[c].count * 10 + (uint32_t)(s.p[i] - '0');
+    if (i == from) return false;
+    if (!out[c].count) continue;
+    if (i >= s.n || s.p[i++] != ':') return false;
+    const size_t hex = i;
+    for (; i < s.n && isxdigit((unsigned char)s.p[i]); ++i)
+      out[c].sum = (out[c].sum << 4) | (uint32_t)(s.p[i] <= '9' ? s.p[i] - '0' : (s.p[i] | 0x20) - 'a' + 10);
+    if (i == hex) return false;
+  }
+  return true;
+}
 
-  if (cmd == "NACK") {
-    uint32_t id = kv.count("id") ? kv["id"].toInt() : 0;
-    String reason = kv.count("reason") ? kv["reason"] : "unknown";
-    _pending.erase(id);
-    if (_h.onNack) _h.onNack(id, reason);
-    return;
+/// <summary>
+/// Stream one token chunk. v1 uses a DATA line so spaces survive. With credit
+/// from the peer, text past the granted limit is held (in order) and sent by
+/// _flushTok() as credit arrives; a full hold refuses the chunk.
+/// </summary>
+bool ProtoV1::sendTok(const String& chunk) {
+  const size_t n = chunk.length();
+  if (!_cr.credited || (!_cr.held.length() && _cr.sent + n <= _cr.limit)) {
+    _sendTokNow(chunk.c_str(), n);
+    return true;
   }
+  if (_cr.held.length() + n > PROTO_TOK_HOLD) { _cr.refused++; return false; }
+  const bool wasHeld = _cr.held.length() != 0;
+  if (!wasHeld) _cr.stallSince = millis();
+  _cr.held += chunk;
+  if (_cr.held.length() > _cr.maxHeld) _cr.maxHeld = _cr.held.length();
+  _flushTok();   // what still fits goes now
+  if (!wasHeld && _cr.held.length()) _cr.stalls++;
+  return true;
+}
 
-  if (cmd == "PING") {
-    if (_h.onPing) _h.onPing();
-    _link.sendLine("PONG");
+/// <summary>End of a token stream; waits behind held tokens.</summary>
+void ProtoV1::sendTokEnd() {
+  if (_cr.held.length()) { _cr.endHeld = true; return; }
+  _sendTokEndNow();
+}
+
+/// <summary>
+/// Put token text on the link. Counts what the peer will count: v1 DATA
+/// lines end at a newline and lose trailing blanks to the line trim.
+/// </summary>
+void ProtoV1::_sendTokNow(const char* p, size_t n) {
+  _lpBusy = true;
+  if (_v2) {
+    _sendFrame(ProtoV2::Type::Tok, false, 0, (const uint8_t*)p, n, false);
+    _cr.sent += n;
     return;
   }
+  while (n) {
+    const char* nl = (const char*)memchr(p, '\n', n);
+    const size_t k = nl ? (size_t)(nl - p) : n;
+    _txLine = "DATA ";
+    _txLine.concat(p, k);
+    _link.sendLine(_txLine, TxPrio::Bulk);
+    size_t counted = k;
+    while (counted && (p[counted - 1] == ' ' || p[counted - 1] == '\r' || p[counted - 1] == '\t')) counted--;
+    _cr.sent += counted;
+    const size_t used = nl ? k + 1 : k;
+    p += used;
+    n -= used;
+  }
+}
+
+/// <summary>TOK_END on the link.</summary>
+void ProtoV1::_sendTokEndNow() {
+  if (_v2) _sendFrame(ProtoV2::Type::TokEnd, false, 0, nullptr, 0, false);
+  else     _link.sendLine("TOK_END", TxPrio::Bulk);
+}
 
-  if (cmd == "TOK") {
-    // Allow "TOK chunk=..." from a v1 host
-    String chunk = kv.count("chunk") ? kv["chunk"] : String();
-    if (_h.onTok) _h.onTok(chunk);
+/// <summary>Send held tokens as far as credit and bulk TX room allow, then a held TOK_END.</summary>
+void ProtoV1::_flushTok() {
+  if (!_cr.held.length() && !_cr.endHeld) return;
+  size_t room = _cr.held.length();
+  if (_cr.credited) room = (int32_t)(_cr.limit - _cr.sent) > 0 ? std::min<size_t>(room, _cr.limit - _cr.sent) : 0;
+  const size_t chunk = _dataChunk();
+  size_t off = 0;
+  while (off < room) {
+    size_t k = std::min(room - off, chunk);
+    if (!_v2 && off + k < _cr.held.length()) {
+      // A v1 line loses trailing blanks: cut before them, they lead the next piece.
+      const char* p = _cr.held.c_str() + off;
+      size_t t = k;
+      while (t && (p[t - 1] == ' ' || p[t - 1] == '\t')) t--;
+      if (!t) break;
+      k = t;
+    }
+    if (_link.txFree(TxPrio::Bulk) < k + DATA_LINE_OVERHEAD) break;
+    _sendTokNow(_cr.held.c_str() + off, k);
+    off += k;
+  }
+  if (off) {
+    _cr.held.remove(0, off);
+    if (!_cr.held.length()) _cr.stalledMs += millis() - _cr.stallSince;
+  }
+  if (!_cr.held.length() && _cr.endHeld) {
+    _cr.endHeld = false;
+    _sendTokEndNow();
+  }
+}
+
+/// <summary>Watch side: start (or stop, with 0) granting token credit.</summary>
+void ProtoV1::setTokCredit(uint32_t budget) {
+  const bool was = _cr.budget != 0;
+  _cr.budget = budget;
+  if (budget || was) _grantCredit(true);
+}
+
+/// <summary>
+/// Raise the host's limit to consumed + budget, capped by what the inbound
+/// queue can take. Small raises wait until the host is close to its limit;
+/// force resends the current limit (a CREDIT may have been lost).
+/// </summary>
+void ProtoV1::_grantCredit(bool force) {
+  if (!_link.isConnected()) return;
+  if (!_cr.budget) {
+    if (!force) return;
+    if (_v2) _sendFrame(ProtoV2::Type::Credit, false, 0, nullptr, 0, false);   // no limit: credit off
+    else     _link.sendLine("CREDIT", TxPrio::Control);
     return;
   }
+  // Short tokens cost several times their text in framing on the way in.
+  const uint32_t queueRoom = (uint32_t)(_link.rxFree() / 4);
+  uint32_t limit = std::min(_cr.consumed + _cr.budget, _cr.received + queueRoom);
+  if ((int32_t)(limit - _cr.granted) <= 0) {
+    if (!force || !_cr.grants) return;
+    limit = _cr.granted;
+  } else if (!force && _cr.grants && limit - _cr.granted < _cr.budget / 4
+             && _cr.granted - _cr.received >= _cr.budget / 4) {
+    return;   // a small step while the host still has room: batch it
+  }
+  _cr.granted = limit;
+  _cr.grants++;
+  if (_v2) {
+    uint8_t v[5];
+    _sendFrame(ProtoV2::Type::Credit, false, 0, v, ProtoV2::putVarint(v, limit), false);
+  } else {
+    _link.sendLine(String("CREDIT c=") + limit, TxPrio::Control);
+  }
+}
+
+/// <summary>New connection (or none): both roles start counting from zero.</summary>
+void ProtoV1::_resetCredit() {
+  if (_cr.held.length()) _cr.stalledMs += millis() - _cr.stallSince;
+  _cr.received = _cr.consumed = _cr.granted = 0;
+  _cr.credited = false;
+  _cr.limit = _cr.sent = 0;
+  _cr.held = String();
+  _cr.endHeld = false;
+}
+
+/// <summary>Snapshot of both roles' credit counters.</summary>
+ProtoV1::CreditStats ProtoV1::creditStats() const noexcept {
+  CreditStats s{};
+  s.received = _cr.received;
+  s.consumed = _cr.consumed;
+  s.buffered = _cr.received > _cr.consumed ? _cr.received - _cr.consumed : 0;
+  s.maxBuffered = _cr.maxBuffered;
+  s.granted = _cr.granted;
+  s.grants = _cr.grants;
+  s.limit = _cr.limit;
+  s.sent = _cr.sent;
+  s.held = _cr.held.length();
+  s.maxHeld = _cr.maxHeld;
+  s.stalls = _cr.stalls;
+  s.stalledMs = _cr.stalledMs + (_cr.held.length() ? millis() - _cr.stallSince : 0);
+  s.refused = _cr.refused;
+  s.credited = _cr.credited;
+  return s;
+}
 
-  if (cmd == "TOK_END") {
-    if (_h.onTokEnd) _h.onTokEnd();
+/// <summary>Offer the peer binary framing (and a window); switch happens on PROTO_OK v=2.</summary>
+void ProtoV1::requestV2(uint8_t window) {
+  if (_v2) return;
+  _v2Requested = true;
+  String line = "PROTO v=2";
+  if (window) line += String(" win=") + (unsigned)window;
+  _link.sendLine(line, TxPrio::Control);
+}
+
+/// <summary>Offer windowed delivery over text lines; it starts on PROTO_OK with win=.</summary>
+void ProtoV1::requestWindow(uint8_t window) {
+  if (_v2 || !window) return;
+  _link.sendLine(String("PROTO v=1 win=") + (unsigned)window, TxPrio::Control);
+}
+
+/// <summary>Transport connectivity hint.</summary>
+bool ProtoV1::connected() const noexcept { return _link.isConnected(); }
+
+/// <summary>
+/// Inbound line parser. Accepts both new v1 frames and your legacy "TOK:"/"TOK_END".
+/// Works on slices of the caller's buffer: trimming, the verb, and key=value
+/// tokens are just pointer ranges, so a line costs no heap allocations.
+/// Once v2 is negotiated the bytes go to the frame decoder instead.
+/// </summary>
+void ProtoV1::_onLine(const String& raw) {
+  _lpRx += raw.length() + (_v2 ? 0 : 1);   // v1 lines lost their '\n'
+  if (_v2) {
+    _v2rx.feed((const uint8_t*)raw.c_str(), raw.length(),
+               [this](const ProtoV2::Frame& f) { _onFrame(f); });
     return;
   }
 
-    // --- SAVE replies ---
-  if (cmd == "SAVE_OK" || cmd == "SAVE_ERR") {
-    uint32_t id = kv.count("id") ? kv["id"].toInt() : 0;
-    bool ok = (cmd == "SAVE_OK");
-    _pending.erase(id);
-    if (_h.onSaveResult) _h.onSaveResult(id, ok);
+  Slice line{ raw.c_str(), raw.length() };
+
+  // Trim spaces and CRLF by moving the slice bounds.
+  auto isWs = [](char c) { return c == ' ' || c == '\r' || c == '\n' || c == '\t'; };
+  while (line.n && isWs(line.p[0]))          { line.p++; line.n--; }
+
+  if (line.n == 0) return;
+
+  // --- SEQ <stream> <seq>[+] <crc16 hex> <text>: the text is exact bytes, so no
+  // trimming at the end; the CRC drops a line that a lost notification cut short.
+  if (line.startsWith("SEQ ")) {
+    Slice f[3];
+    Slice rest{ line.p + 4, line.n - 4 };
+    for (Slice& s : f) {
+      const char* sp = (const char*)memchr(rest.p, ' ', rest.n);
+      if (!sp) return;
+      s = Slice{ rest.p, (size_t)(sp - rest.p) };
+      rest = Slice{ sp + 1, rest.n - s.n - 1 };
+    }
+    uint32_t crc = 0;
+    for (size_t i = 0; i < f[2].n; ++i) {
+      const char ch = f[2].p[i];
+      const int d = (ch >= '0' && ch <= '9') ? ch - '0' : (ch >= 'a' && ch <= 'f') ? ch - 'a' + 10 : -1;
+      if (d < 0) return;
+      crc = crc << 4 | (uint32_t)d;
+    }
+    if (f[2].n != 4 || crc != ProtoV2::crc16((const uint8_t*)rest.p, rest.n)) return;
+    const bool nl = f[1].n && f[1].p[f[1].n - 1] == '+';
+    _dispatch(Msg{ Cmd::Seq, true, f[0].toU32(), rest, true, f[1].toU32(), nl ? 1u : 0u });
     return;
   }
 
-  // --- CLEAR replies ---
-  if (cmd == "CLEAR_OK" || cmd == "CLEAR_ERR") {
-    uint32_t id = kv.count("id") ? kv["id"].toInt() : 0;
-    bool ok = (cmd == "CLEAR_OK");
-    _pending.erase(id);
-    if (_h.onClearResult) _h.onClearResult(id, ok);
+  while (line.n && isWs(line.p[line.n - 1])) { line.n--; }
+
+  // --- DATA handling for both TOK streaming and BODY accumulation ---
+  if (line.startsWith("DATA ")) {
+    _dispatch(Msg{ Cmd::Data, false, 0, Slice{ line.p + 5, line.n - 5 }, true, 0, 0 });
     return;
   }
 
-  // --- BODY / DATA / BODY_END for READALL ---
-  if (cmd == "BODY") {
-    bodyActive = true;
-    bodyId = kv.count("id") ? kv["id"].toInt() : 0;
-    bodyBuf = "";
+  // Extract CMD + tokens
+  const char* sp = (const char*)memchr(line.p, ' ', line.n);
+  const Slice cmd{ line.p, sp ? (size_t)(sp - line.p) : line.n };
+  const Slice rest = sp ? Slice{ sp + 1, line.n - cmd.n - 1 } : Slice{};
+  _parseKv(rest);
+
+  const Cmd c = _lookup(cmd);
+
+  // --- v2 / window negotiation (text only) ---
+  if (c == Cmd::Proto) {
+    // Control class: later v2 ACKs/PONGs must not overtake the switch.
+    const bool v2 = _kvU32("v") >= 2;
+    const uint32_t win = std::min<uint32_t>(_kvU32("win"), DataWindow::WINDOW);
+    String ok = v2 ? "PROTO_OK v=2" : "PROTO_OK v=1";
+    if (win) ok += String(" win=") + win;
+    _link.sendLine(ok, TxPrio::Control);
+    if (v2) _setV2(true);
+    _setWindow((uint8_t)win);
+    return;
+  }
+  if (c == Cmd::ProtoOk) {
+    if (_v2Requested && _kvU32("v") == 2) _setV2(true);
+    _v2Requested = false;
+    _setWindow((uint8_t)std::min<uint32_t>(_kvU32("win"), DataWindow::WINDOW));
     return;
   }
 
-  if (cmd == "DATA") {
-    // DATA chunk (already handled for TOK, but share for body too).
-    // We’ll just append the raw rest of the line after "DATA ".
-    // Note: above we already handled "DATA " early for TOK streaming.
-    // To make BODY work too, ensure that early path also reaches here if needed.
-    // (If you prefer separate paths, you can keep TOK vs BODY separate.)
+  const Slice* id = _kvGet("id");
+  const Slice* text = (c == Cmd::Nack) ? _kvGet("reason")
+                    : (c == Cmd::Tok)  ? _kvGet("chunk")
+                    : (c == Cmd::Find) ? _kvGet("q")
+                    : (c == Cmd::Save) ? _kvGet("line") : nullptr;
+  Slice t = text ? *text : Slice{};
+  // q= and line= run to the end of the line
+  if ((c == Cmd::Find || c == Cmd::Save) && text) t.n = (size_t)(line.p + line.n - t.p);
+  if (c == Cmd::Credit) { _dispatch(Msg{ c, false, 0, Slice{}, false, _kvU32("c"), _kvGet("c") ? 1u : 0u }); return; }
+  if (c == Cmd::Sack) { _dispatch(Msg{ c, id != nullptr, id ? id->toU32() : 0, t, false, _kvU32("c"), _kvU32("m") }); return; }
+  if (c == Cmd::BodyEnd) { _dispatch(Msg{ c, id != nullptr, id ? id->toU32() : 0, t, false, _kvU32("crc"), _kvGet("crc") ? 1u : 0u }); return; }
+  if (c == Cmd::Resume) { _dispatch(Msg{ c, id != nullptr, id ? id->toU32() : 0, t, false, _kvU32("off"), 0 }); return; }
+  if (c == Cmd::Sync || c == Cmd::Fetch || c == Cmd::Sum || c == Cmd::Keys) {
+    const Slice* list = _kvGet(c == Cmd::Sum ? "d" : "k");
+    _dispatch(Msg{ c, id != nullptr, id ? id->toU32() : 0, list ? *list : Slice{}, list != nullptr,
+                   _kvU32("t0"), _kvU32("t1") });
     return;
   }
+  _dispatch(Msg{ c, id != nullptr, id ? id->toU32() : 0, t, text != nullptr, _kvU32("len"), c == Cmd::Body ? _kvU32("off") : 0 });
+}
+
+/// <summary>Map a decoded ProtoV2 frame onto the same message handling as v1.</summary>
+void ProtoV1::_onFrame(const ProtoV2::Frame& f) {
+  using T = ProtoV2::Type;
+  Msg m{ Cmd::Unknown, f.hasId, f.id, Slice{ (const char*)f.payload, f.len }, false, 0, 0 };
+  switch (f.type) {
+    case T::Ack:      m.cmd = Cmd::Ack;      break;
+    case T::Nack:     m.cmd = Cmd::Nack;     m.hasText = f.len > 0; break;
+    case T::Ping:     m.cmd = Cmd::Ping;     break;
+    case T::Pong:     m.cmd = Cmd::Pong;     break;
+    case T::Tok:      m.cmd = Cmd::Tok;      m.hasText = true; break;
+    case T::TokEnd:   m.cmd = Cmd::TokEnd;   break;
+    case T::Data:     m.cmd = Cmd::Data;     m.hasText = true; break;
+    case T::SaveOk:   m.cmd = Cmd::SaveOk;   break;
+    case T::SaveErr:  m.cmd = Cmd::SaveErr;  break;
+    case T::ClearOk:  m.cmd = Cmd::ClearOk;  break;
+    case T::ClearErr: m.cmd = Cmd::ClearErr; break;
+    case T::Find:     m.cmd = Cmd::Find;     m.hasText = true; break;
+    case T::Save:     m.cmd = Cmd::Save;     m.hasText = true; break;
+    case T::Credit: {
+      m.cmd = Cmd::Credit;
+      const uint8_t* p = f.payload;
+      m.aux = ProtoV2::getVarint(p, f.payload + f.len, m.len) ? 1 : 0;   // empty: credit off
+      break;
+    }
+    case T::Seq: {
+      m.cmd = Cmd::Seq;
+      const uint8_t* p = f.payload;
+      const uint8_t* end = f.payload + f.len;
+      if (!ProtoV2::getVarint(p, end, m.len)) return;
+      m.text = Slice{ (const char*)p, (size_t)(end - p) };
+      m.hasText = true;
+      break;
+    }
+    case T::Sack: {
+      m.cmd = Cmd::Sack;
+      const uint8_t* p = f.payload;
+      const uint8_t* end = f.payload + f.len;
+      if (!ProtoV2::getVarint(p, end, m.len) || !ProtoV2::getVarint(p, end, m.aux)) return;
+      break;
+    }
+    case T::Body: {
+      m.cmd = Cmd::Body;
+      const uint8_t* p = f.payload;
+      const uint8_t* end = f.payload + f.len;
+      if (ProtoV2::getVarint(p, end, m.len)) ProtoV2::getVarint(p, end, m.aux);   // no offset: from the start
+      break;
+    }
+    case T::BodyEnd: {
+      m.cmd = Cmd::BodyEnd;
+      const uint8_t* p = f.payload;
+      m.aux = ProtoV2::getVarint(p, f.payload + f.len, m.len) ? 1 : 0;   // empty: no CRC to check
+      break;
+    }
+    case T::Resume: {
+      m.cmd = Cmd::Resume;
+      const uint8_t* p = f.payload;
+      if (!ProtoV2::getVarint(p, f.payload + f.len, m.len)) return;
+      break;
+    }
+    case T::Sync:
+    case T::Fetch: {
+      m.cmd = f.type == T::Sync ? Cmd::Sync : Cmd::Fetch;
+      const uint8_t* p = f.payload;
+      const uint8_t* end = f.payload + f.len;
+      if (!ProtoV2::getVarint(p, end, m.len) || !ProtoV2::getVarint(p, end, m.aux)) return;
+      m.text = Slice{ (const char*)p, (size_t)(end - p) };   // FETCH keys
+      m.hasText = true;
+      break;
+    }
+    case T::Sum:      m.cmd = Cmd::Sum;      m.hasText = true; break;
+    case T::Keys:     m.cmd = Cmd::Keys;     m.hasText = true; break;
+    default: return;   // other watch → host requests: not handled on this side (same as v1)
+  }
+  _dispatch(m);
+}
+
+/// <summary>Act on one inbound message and fire the matching ProtoHandlers callback.</summary>
+void ProtoV1::_dispatch(const Msg& m) {
+  switch (m.cmd) {
+    case Cmd::Data:
+      // Bare "DATA" (no payload) carries nothing.
+      if (!m.hasText) return;
+      if (!_bodyActive) _tokIn(m.text.n);   // a token (sendTok's v1 form)
+      else if (!_v2) _bodyExact = false;    // the line ending may have eaten more than '\n' (see BODY_END)
+      // v1 DATA lines drop their newline; v2 frames are exact bytes
+      _onData(m.text, !_v2, _bodyActive);
+      return;
+
+    case Cmd::Credit:
+      if (m.aux) {
+        // Limits only grow; an older CREDIT overtaken by a newer one changes nothing.
+        if (!_cr.credited || (int32_t)(m.len - _cr.limit) > 0) _cr.limit = m.len;
+        _cr.credited = true;
+      } else {
+        _cr.credited = false;
+      }
+      _flushTok();
+      return;
+
+    // --- windowed chunks of a PROMPT/BODY, and the peer's reports on ours ---
+    case Cmd::Seq: {
+      if (!_win) return;
+      if (m.id != _rxStream) { _rxStream = m.id; _rxw.reset(); }   // the peer finished the last one
+      const bool body = _bodyActive && _bodyId == m.id;
+      const bool now = _rxw.accept(m.len, (const uint8_t*)m.text.p, m.text.n, m.aux != 0,
+        [this, body](const uint8_t* p, size_t n, bool nl) { _onData(Slice{ (const char*)p, n }, nl, body); });
+      if (now) _sendSack();
+      return;
+    }
+
+    case Cmd::Sack: {
+      const BodyStage st = _bodyOut.stage;
+      if (!m.hasId || m.id != _bodyOut.id || (st != BodyStage::Data && st != BodyStage::End)) return;
+      const RetxWheel::Stats& rs = _retx.stats();
+      _txw.sack(m.len, m.aux, millis(), rs.srttMs ? rs.srttMs : rs.rtoMs,
+        [this](uint32_t seq, const DataWindow::Chunk& c) { _sendSeq(_bodyOut.id, seq, c.data, c.len, c.nl); });
+      _pumpBody();   // the window moved
+      return;
+    }
+
+    case Cmd::Ack:
+      if (!m.hasId) return;
+      _retx.ack(m.id, millis());
+      if (_bodyHeld.src && _bodyHeld.id == m.id) _bodyHeld = BodyOut{};   // BODY_END arrived: nothing to resume
+      if (_h.onAck) _h.onAck(m.id);
+      return;
+
+    case Cmd::Nack:
+      _retx.remove(m.id);
+      if (_bodyActive && m.id == _bodyId) { _bodyActive = false; _bodyId = 0; _bodyBuf = ""; }   // the rest is not coming
+      _syncFail(m.id);
+      if (_h.onNack) {
+        if (m.hasText) _h.onNack(m.id, _argFrom(m.text));
+        else { _arg = "unknown"; _h.onNack(m.id, _arg); }
+      }
+      return;
+
+    case Cmd::Ping:
+      if (_h.onPing) _h.onPing();
+      if (_cr.budget) _grantCredit(true);   // a lost CREDIT would stall the host for good
+      if (_v2) _sendFrame(ProtoV2::Type::Pong, false, 0, nullptr, 0, false);
+      else     _link.sendLine("PONG", TxPrio::Control);
+      return;
+
+    case Cmd::Tok:
+      // Allow "TOK chunk=..." from a v1 host
+      if (m.hasText) _tokIn(m.text.n);
+      if (_h.onTok) _h.onTok(_argFrom(m.hasText ? m.text : Slice{}));
+      return;
+
+    case Cmd::TokEnd:
+      if (_h.onTokEnd) _h.onTokEnd();
+      return;
+
+    // --- SAVE replies ---
+    case Cmd::SaveOk:
+    case Cmd::SaveErr:
+      _retx.remove(m.id);
+      if (_h.onSaveResult) _h.onSaveResult(m.id, m.cmd == Cmd::SaveOk);
+      return;
+
+    // --- CLEAR replies ---
+    case Cmd::ClearOk:
+    case Cmd::ClearErr:
+      _retx.remove(m.id);
+      if (_h.onClearResult) _h.onClearResult(m.id, m.cmd == Cmd::ClearOk);
+      return;
+
+    // --- BODY / DATA / BODY_END for READALL ---
+    // A resent header carries the same offset and arrives before any chunk
+    // (those wait for its ACK), so starting over from it loses nothing.
+    case Cmd::Body:
+      if (_win && m.hasId) sendAck(m.id);
+      if (m.aux) {
+        // Resumed: go on from the offset if that much of this body is here.
+        if (!_bodyActive || _bodyId != m.id) return;   // not one we are collecting
+        if (!_bodyExact || m.aux > _bodyBuf.length()) { resumeBody(); return; }
+        _bodyBuf.remove(m.aux);
+      } else {
+        _bodyActive = true;
+        _bodyId = m.id;
+        _bodyBuf = "";
+        _bodyExact = true;
+        // Size the accumulator once from the advertised length (+1 newline per DATA line)
+        // so the DATA lines that follow append without reallocating.
+        if (m.len) _bodyBuf.reserve(m.len + m.len / 64 + 16);
+      }
+      if (_win) { _rxStream = m.id; _rxw.reset(); }   // chunks count from 0 again
+      return;
+
+    case Cmd::BodyEnd:
+      if (_win && m.hasId) sendAck(m.id);   // a resent BODY_END finds _bodyActive false
+      if (!_bodyActive || m.id != _bodyId) return;
+      if (m.aux
+          && ~ProtoV2::crc32((const uint8_t*)_bodyBuf.c_str(), _bodyBuf.length()) != m.len) {
+        _bs.crcFails++;
+        sendNack(m.id, "body-crc");
+        if (_h.onNack) { _arg = "body-crc"; _h.onNack(m.id, _arg); }
+        _syncFail(m.id);
+      } else {
+        if (m.aux) _bs.verified++;
+        if (_sync.id && m.id == _sync.fetchId) _syncBody(_bodyBuf);
+        else if (_h.onBody) _h.onBody(m.id, _bodyBuf);
+      }
+      _bodyActive = false;
+      _bodyId = 0;
+      _bodyBuf = "";
+      return;
 
-  if (cmd == "BODY_END") {
-    uint32_t id = kv.count("id") ? kv["id"].toInt() : 0;
-    if (bodyActive && id == bodyId) {
-      if (_h.onBody) _h.onBody(id, bodyBuf);
+    // --- RESUME: the receiver holds off bytes of a body we sent ---
+    case Cmd::Resume: {
+      if (!m.hasId) return;
+      const bool current = _bodyOut.stage != BodyStage::Idle && _bodyOut.id == m.id && !_bodyOut.prompt;
+      const bool held = !current && _bodyHeld.src && _bodyHeld.id == m.id;
+      if (!current && !held) { _bs.refused++; sendNack(m.id, "no-resume"); return; }
+      BodyOut& b = current ? _bodyOut : _bodyHeld;
+      if (!_restartBody(b, m.len)) { _bs.refused++; _bodyHeld = BodyOut{}; sendNack(m.id, "no-resume"); return; }
+      sendAck(m.id);
+      _bs.resumed++;
+      _bs.notResent += m.len;
+      if (current) {
+        _retx.remove(m.id);   // an unACKed header or BODY_END of the old attempt
+        _txw.reset();
+      } else if (_bodyOut.stage == BodyStage::Idle) {
+        _bodyOut = std::move(_bodyHeld);
+        _bodyHeld = BodyOut{};
+      } else {
+        _bodyNext.insert(_bodyNext.begin(), std::move(_bodyHeld));   // after the stream going now
+        _bodyHeld = BodyOut{};
+      }
+      _pumpBody();
+      return;
     }
-    bodyActive = false;
-    bodyId = 0;
-    bodyBuf = "";
+
+    // --- FIND: the one request the watch answers ---
+    case Cmd::Find:
+      if (!m.hasId) return;
+      if (!_h.onFind) { sendNack(m.id, "unsupported"); return; }
+      sendAck(m.id);
+      if (_seenBefore(m.id)) return;   // our ACK was lost; the answer is already on its way
+      _h.onFind(m.id, _argFrom(m.hasText ? m.text : Slice{}));
+      return;
+
+    // --- Journal sync: queries and fetches from the peer's sendSync, answers to ours ---
+    case Cmd::Sync:
+      if (!m.hasId) return;
+      if (!_h.onSyncDigest || !_h.onSyncKeys) { sendNack(m.id, "unsupported"); return; }
+      _syncAnswer(m.id, m.len, m.aux);   // a resent SYNC gets the same answer again
+      return;
+
+    case Cmd::Sum:
+    case Cmd::Keys:
+      if (m.hasId) _syncReply(m);
+      return;
+
+    case Cmd::Fetch: {
+      if (!m.hasId) return;
+      if (!_h.onSyncFetch) { sendNack(m.id, "unsupported"); return; }
+      sendAck(m.id);
+      if (_seenBefore(m.id)) return;   // our ACK was lost; the body is already on its way
+      uint32_t keys[JournalSync::LEAF];
+      const size_t n = m.hasText ? _syncKeyList(m.text, keys, JournalSync::LEAF) : 0;
+      _h.onSyncFetch(m.id, m.len, m.aux, keys, n);
+      return;
+    }
+
+    // --- SAVE, when this end plays the host ---
+    case Cmd::Save:
+      if (!m.hasId || !_h.onSave) return;
+      sendAck(m.id);
+      if (_seenBefore(m.id)) return;   // a resend: saving again would duplicate the line
+      _h.onSave(m.id, _argFrom(m.hasText ? m.text : Slice{}));
+      return;
+
+    default:
+      return;
+  }
+}
+
+/// <summary>Accepted body/prompt text: collect it for onBody when body, and pass it to onTok.</summary>
+void ProtoV1::_onData(const Slice& text, bool nl, bool body) {
+  _lpBusy = true;
+  if (body) {
+    _bodyBuf.concat(text.p, text.n);
+    if (nl) _bodyBuf += '\n';
+  }
+  // Also forward to onTok for streaming text UIs (harmless for BODY)
+  if (_h.onTok) _h.onTok(_argFrom(text));
+}
+
+/// <summary>One windowed chunk: v1 "SEQ" line with a CRC of the text, or a v2 Seq frame.</summary>
+void ProtoV1::_sendSeq(uint32_t stream, uint32_t seq, const uint8_t* p, size_t n, bool nl) {
+  if (_v2) {
+    uint8_t buf[5 + PROTO_DATA_SLOT];
+    const size_t k = ProtoV2::putVarint(buf, seq);
+    memcpy(buf + k, p, n);
+    _sendFrame(ProtoV2::Type::Seq, true, stream, buf, k + n, false);
     return;
   }
+  char crc[6];
+  snprintf(crc, sizeof(crc), "%04x", (unsigned)ProtoV2::crc16(p, n));
+  _txLine = "SEQ ";
+  _txLine += stream;
+  _txLine += ' ';
+  _txLine += seq;
+  if (nl) _txLine += '+';
+  _txLine += ' ';
+  _txLine += crc;
+  _txLine += ' ';
+  _txLine.concat((const char*)p, n);
+  _link.sendLine(_txLine, TxPrio::Bulk);
+}
 
+/// <summary>Report what arrived of the current inbound stream (Control class: overtakes bulk).</summary>
+void ProtoV1::_sendSack() {
+  if (_v2) {
+    uint8_t v[10];
+    size_t n = ProtoV2::putVarint(v, _rxw.cum());
+    n += ProtoV2::putVarint(v + n, _rxw.mask());
+    _sendFrame(ProtoV2::Type::Sack, true, _rxStream, v, n, false);
+  } else {
+    _link.sendLine(String("SACK id=") + _rxStream + " c=" + _rxw.cum() + " m=" + _rxw.mask(), TxPrio::Control);
+  }
+  _rxw.acked();
 }
 
-/// <summary>Track a line that requires an ACK.</summary>
-void ProtoV1::_txEnqueue(uint32_t id, const String& line) {
-  OutTx tx{ line, id, 1, millis() };
-  _pending[id] = tx;
+/// <summary>Remember a request id; true if it was answered lately.</summary>
+bool ProtoV1::_seenBefore(uint32_t id) {
+  for (uint32_t s : _seen) if (s == id) return true;
+  _seen[_seenAt] = id;
+  _seenAt = (uint8_t)((_seenAt + 1) % (sizeof(_seen) / sizeof(_seen[0])));
+  return false;
 }
 
-/// <summary>Resend lines that haven't been ACKed within timeout (up to retries).</summary>
-void ProtoV1::_txPump(uint32_t nowMs) {
-  for (auto it = _pending.begin(); it != _pending.end(); ) {
-    OutTx& tx = it->second;
-    if (nowMs - tx.lastSend >= ACK_TIMEOUT_MS) {
-      if (tx.tries >= ACK_RETRIES) {
-        // Give up; notify as NACK
-        if (_h.onNack) _h.onNack(tx.id, "ack-timeout");
-        it = _pending.erase(it);
-        continue;
+/// <summary>
+/// Set the negotiated window (0 = plain DATA). Either way both windows and
+/// the seen-id ring start empty, and a windowed stream that can no longer be
+/// SACKed is dropped.
+/// </summary>
+void ProtoV1::_setWindow(uint8_t win) {
+  if ((_win || win) && _bodyOut.stage != BodyStage::Idle) _bodyOut = BodyOut{};
+  _bodyNext.clear();
+  _win = win;
+  _txw.reset();
+  _rxw.reset();
+  _rxStream = 0;
+  memset(_seen, 0, sizeof(_seen));
+  _seenAt = 0;
+}
+
+/// <summary>Switch framing; the decoder and the link's line buffer start empty either way.</summary>
+void ProtoV1::_setV2(bool on) {
+  _v2 = on;
+  _v2Requested = false;
+  _v2rx.reset();
+  _link.setRaw(on);
+}
+
+/// <summary>Split "k=v k=v" on spaces into the fixed table. Later duplicates win.</summary>
+void ProtoV1::_parseKv(Slice rest) {
+  _kvCount = 0;
+  while (rest.n) {
+    const char* sp = (const char*)memchr(rest.p, ' ', rest.n);
+    const Slice tok{ rest.p, sp ? (size_t)(sp - rest.p) : rest.n };
+    const char* eq = tok.n ? (const char*)memchr(tok.p, '=', tok.n) : nullptr;
+    if (eq && eq > tok.p) {
+      const Slice key{ tok.p, (size_t)(eq - tok.p) };
+      const Slice val{ eq + 1, tok.n - key.n - 1 };
+      Kv* slot = nullptr;
+      for (uint8_t i = 0; i < _kvCount; ++i) {
+        if (_kv[i].key.n == key.n && memcmp(_kv[i].key.p, key.p, key.n) == 0) { slot = &_kv[i]; break; }
       }
-      tx.tries++;
-      tx.lastSend = nowMs;
-      _link.sendLine(tx.line);
+      if (!slot && _kvCount < MAX_KV) slot = &_kv[_kvCount++];
+      if (slot) *slot = Kv{ key, val };
     }
-    ++it;
+    if (!sp) break;
+    rest = Slice{ sp + 1, rest.n - tok.n - 1 };
+  }
+}
+
+/// <summary>Find a parsed value by key (nullptr if absent).</summary>
+const ProtoV1::Slice* ProtoV1::_kvGet(const char* key) const {
+  for (uint8_t i = 0; i < _kvCount; ++i) {
+    if (_kv[i].key.equals(key)) return &_kv[i].val;
   }
+  return nullptr;
+}
+
+/// <summary>Numeric value for key, 0 if absent.</summary>
+uint32_t ProtoV1::_kvU32(const char* key) const {
+  const Slice* v = _kvGet(key);
+  return v ? v->toU32() : 0;
 }
 
-/// <summary>Trim spaces and CRLF.</summary>
-String ProtoV1::_trim(const String& s) {
-  int a = 0, b = s.length() - 1;
-  while (a <= b && (s[a] == ' ' || s[a] == '\r' || s[a] == '\n' || s[a] == '\t')) a++;
-  while (b >= a && (s[b] == ' ' || s[b] == '\r' || s[b] == '\n' || s[b] == '\t')) b--;
-  return (a <= b) ? s.substring(a, b + 1) : String();
+/// <summary>Copy a slice into the reused String; only grows past its largest line so far.</summary>
+const String& ProtoV1::_argFrom(const Slice& s) {
+  _arg = "";
+  _arg.concat(s.p, s.n);
+  return _arg;
 }
-bool ProtoV1::_startsWith(const String& s, const char* prefix) {
-  size_t n = strlen(prefix);
-  return s.length() >= n && s.substring(0, n) == prefix;
+
+/// <summary>Map a verb to a Cmd via its precomputed hash, then confirm the hit once.</summary>
+ProtoV1::Cmd ProtoV1::_lookup(const Slice& cmd) {
+  Cmd c;
+  const char* name;
+  switch (_hash(cmd.p, cmd.n)) {
+    case _key("ACK"):       c = Cmd::Ack;      name = "ACK";       break;
+    case _key("NACK"):      c = Cmd::Nack;     name = "NACK";      break;
+    case _key("PING"):      c = Cmd::Ping;     name = "PING";      break;
+    case _key("TOK"):       c = Cmd::Tok;      name = "TOK";       break;
+    case _key("TOK_END"):   c = Cmd::TokEnd;   name = "TOK_END";   break;
+    case _key("SAVE_OK"):   c = Cmd::SaveOk;   name = "SAVE_OK";   break;
+    case _key("SAVE_ERR"):  c = Cmd::SaveErr;  name = "SAVE_ERR";  break;
+    case _key("CLEAR_OK"):  c = Cmd::ClearOk;  name = "CLEAR_OK";  break;
+    case _key("CLEAR_ERR"): c = Cmd::ClearErr; name = "CLEAR_ERR"; break;
+    case _key("BODY"):      c = Cmd::Body;     name = "BODY";      break;
+    case _key("DATA"):      c = Cmd::Data;     name = "DATA";      break;
+    case _key("BODY_END"):  c = Cmd::BodyEnd;  name = "BODY_END";  break;
+    case _key("PONG"):      c = Cmd::Pong;     name = "PONG";      break;
+    case _key("PROTO"):     c = Cmd::Proto;    name = "PROTO";     break;
+    case _key("PROTO_OK"):  c = Cmd::ProtoOk;  name = "PROTO_OK";  break;
+    case _key("FIND"):      c = Cmd::Find;     name = "FIND";      break;
+    case _key("SAVE"):      c = Cmd::Save;     name = "SAVE";      break;
+    case _key("SACK"):      c = Cmd::Sack;     name = "SACK";      break;
+    case _key("CREDIT"):    c = Cmd::Credit;   name = "CREDIT";    break;
+    case _key("RESUME"):    c = Cmd::Resume;   name = "RESUME";    break;
+    case _key("SYNC"):      c = Cmd::Sync;     name = "SYNC";      break;
+    case _key("SUM"):       c = Cmd::Sum;      name = "SUM";       break;
+    case _key("KEYS"):      c = Cmd::Keys;     name = "KEYS";      break;
+    case _key("FETCH"):     c = Cmd::Fetch;    name = "FETCH";     break;
+    default: return Cmd::Unknown;
+  }
+  // A colliding unknown verb must not alias a real one.
+  return cmd.equals(name) ? c : Cmd::Unknown;
+}
+
+/// <summary>TX class per frame type; mirrors the priorities used for v1 lines.</summary>
+TxPrio ProtoV1::_prioOf(ProtoV2::Type t) {
+  using T = ProtoV2::Type;
+  switch (t) {
+    case T::Ack: case T::Nack: case T::Ping: case T::Pong: case T::Sack: case T::Credit:
+      return TxPrio::Control;
+    case T::Prompt: case T::Data: case T::Tok: case T::TokEnd: case T::Body: case T::BodyEnd: case T::Seq:
+      return TxPrio::Bulk;
+    default:
+      return TxPrio::Normal;
+  }
+}
+
+/// <summary>Encode and send one v2 frame; track it for ACK when asked.</summary>
+void ProtoV1::_sendFrame(ProtoV2::Type t, bool hasId, uint32_t id, const uint8_t* p, size_t n, bool track) {
+  uint8_t buf[ProtoV2::MAX_FRAME];
+  const size_t len = ProtoV2::encode(buf, sizeof(buf), t, hasId, id, p, n);
+  if (!len) return;   // payload over MAX_PAYLOAD; bulk text is chunked by _pumpBody
+  const TxPrio prio = _prioOf(t);
+  if (track) _txEnqueue(id, buf, len, true, prio);
+  _link.sendBytes(buf, len, prio);
+}
+
+/// <summary>Frame with an id and a text payload.</summary>
+void ProtoV1::_sendFrame(ProtoV2::Type t, uint32_t id, const String& payload, bool track) {
+  _sendFrame(t, true, id, (const uint8_t*)payload.c_str(), payload.length(), track);
+}
+
+/// <summary>Frame whose payload is a single varint (PROMPT/BODY length, PING ts).</summary>
+void ProtoV1::_sendLenFrame(ProtoV2::Type t, uint32_t id, uint32_t len, bool track) {
+  uint8_t v[5];
+  _sendFrame(t, t != ProtoV2::Type::Ping, id, v, ProtoV2::putVarint(v, len), track);
+}
+
+/// <summary>DATA (or windowed SEQ) text bytes that fit one notification on the live link.</summary>
+size_t ProtoV1::_dataChunk() const {
+  const size_t payload = _link.payloadSize();
+  const size_t overhead = _win ? (_v2 ? SEQ_FRAME_OVERHEAD : SEQ_LINE_OVERHEAD)
+                               : (_v2 ? DATA_FRAME_OVERHEAD : DATA_LINE_OVERHEAD);
+  size_t chunk = payload > overhead ? payload - overhead : payload;   // tiny MTU: a message spans two
+  if (chunk > ProtoV2::MAX_PAYLOAD) chunk = ProtoV2::MAX_PAYLOAD;
+  if (_win && chunk > PROTO_DATA_SLOT) chunk = PROTO_DATA_SLOT;   // a window slot holds one chunk
+  return chunk;
+}
+
+/// <summary>Track a line (or encoded frame) that requires an ACK; it was just queued.</summary>
+void ProtoV1::_txEnqueue(uint32_t id, const uint8_t* p, size_t n, bool bin, TxPrio prio) {
+  _retx.add(id, p, n, bin, prio, millis());
+}
+
+/// <summary>Resend what timed out (backing off per try); NACK "ack-timeout" when out of tries.</summary>
+void ProtoV1::_txPump(uint32_t nowMs) {
+  _retx.tick(nowMs,
+    [this](const RetxWheel::Msg& m) {
+      if (m.bin) { _link.sendBytes(m.data, m.len, m.prio); return; }
+      _txLine = "";
+      _txLine.concat((const char*)m.data, m.len);
+      _link.sendLine(_txLine, m.prio);
+    },
+    [this](uint32_t id) {
+      // A BODY header nobody ACKs: its chunks would have nowhere to go.
+      if (_bodyOut.stage == BodyStage::HeaderAck && _bodyOut.id == id) {
+        _suspendBody();
+        if (!_bodyNext.empty()) { _bodyOut = std::move(_bodyNext.front()); _bodyNext.erase(_bodyNext.begin()); }
+      }
+      _syncFail(id);
+      if (!_h.onNack) return;
+      _arg = "ack-timeout";
+      _h.onNack(id, _arg);
+    });
+}
+
+/// <summary>Exact match against a C string.</summary>
+bool ProtoV1::Slice::equals(const char* s) const {
+  const size_t k = strlen(s);
+  return k == n && memcmp(p, s, n) == 0;
+}
+
+/// <summary>Prefix match against a C string.</summary>
+bool ProtoV1::Slice::startsWith(const char* s) const {
+  const size_t k = strlen(s);
+  return k <= n && memcmp(p, s, k) == 0;
+}
+
+/// <summary>Leading decimal digits (optional sign), like toInt(); 0 if none.</summary>
+uint32_t ProtoV1::Slice::toU32() const {
+  size_t i = 0;
+  bool neg = false;
+  if (i < n && (p[i] == '-' || p[i] == '+')) neg = (p[i++] == '-');
+  uint32_t v = 0;
+  for (; i < n && p[i] >= '0' && p[i] <= '9'; ++i) v = v * 10 + (uint32_t)(p[i] - '0');
+  return neg ? (uint32_t)(0u - v) : v;
 }
@@ -1,7 +1,23 @@
 #pragma once
 #include <Arduino.h>
 #include <functional>
-#include <map>
+#include <vector>
+#include "ProtoV2.hpp"
+#include "BleTxQueue.hpp"
+#include "RetxWheel.hpp"
+#include "DataWindow.hpp"
+#include "JournalSync.hpp"
+#include "LinkProfile.hpp"
+
+#ifndef PROTO_TOK_HOLD
+#define PROTO_TOK_HOLD 4096       // host: token bytes held back while out of credit; sendTok refuses more
+#endif
+#ifndef PROTO_SYNC_PARALLEL
+#define PROTO_SYNC_PARALLEL 4     // SYNC queries in flight at once during sendSync
+#endif
+#ifndef PROTO_PING_IDLE_MS
+#define PROTO_PING_IDLE_MS 15000  // heartbeat period while the link profile is Idle (else every 3 s)
+#endif
 
 /// <summary>
 /// Callbacks from ProtoV1 to the app (watch firmware).
@@ -31,6 +47,36 @@ struct ProtoHandlers {
 
   /// <summary>Host replied to CLEAR: true=ok, false=err (id matches the request).</summary>
   std::function<void(uint32_t /*id*/, bool /*ok*/)> onClearResult;
+
+  /// <summary>
+  /// Watch asked to save a line (watch → host, already ACKed). A resent SAVE
+  /// whose ACK was lost is ACKed again but not passed on twice. Reply with sendSaveOk.
+  /// </summary>
+  std::function<void(uint32_t /*id*/, const String& /*line*/)> onSave;
+
+  /// <summary>Host searched the journal (host → watch, already ACKed); answer with sendBody(id, ...).</summary>
+  std::function<void(uint32_t /*id*/, const String& /*terms*/)> onFind;
+
+  /// <summary>
+  /// Sync, both ends: digests of the JournalSync::FANOUT children of [t0, t1)
+  /// in the local journal, into out (see ProtoV1::sendSync).
+  /// </summary>
+  std::function<void(uint32_t /*t0*/, uint32_t /*t1*/, JournalSync::Digest* /*out*/)> onSyncDigest;
+
+  /// <summary>Sync, both ends: keys of local entries with t0 &lt;= ts &lt; t1 (at most max into out); returns how many there are.</summary>
+  std::function<size_t(uint32_t /*t0*/, uint32_t /*t1*/, uint32_t* /*out*/, size_t /*max*/)> onSyncKeys;
+
+  /// <summary>
+  /// Sync peer wants entries (already ACKed): all of [t0, t1), or only the n
+  /// with the given keys. Answer with sendBody(id, ...) holding JournalSync records.
+  /// </summary>
+  std::function<void(uint32_t /*id*/, uint32_t /*t0*/, uint32_t /*t1*/, const uint32_t* /*keys*/, size_t /*n*/)> onSyncFetch;
+
+  /// <summary>Sync: an entry this end lacked arrived; store it.</summary>
+  std::function<void(uint32_t /*ts*/, const String& /*text*/)> onSyncEntry;
+
+  /// <summary>sendSync finished (id as it returned); syncStats() tells how it went.</summary>
+  std::function<void(uint32_t /*id*/)> onSyncDone;
 };
 
 class BleLink; // forward: we only store a ref; definitions live in .cpp
@@ -40,6 +86,54 @@ class BleLink; // forward: we only store a ref; definitions live in .cpp
 /// - Human-readable lines: "CMD key=value key=value"
 /// - DATA lines: "DATA <raw text>"
 /// - ACK/NACK with id for reliability
+///
+/// Outbound messages are queued by priority: ACK/NACK/PING/PONG (and the
+/// PROTO handshake) overtake pending bulk DATA, which never blocks the caller.
+/// Commands that expect an ACK are resent on a timeout that tracks the
+/// measured round trip (see RetxWheel); retxStats() shows what it learned.
+///
+/// HELLO advertises "max=2". A peer that answers "PROTO v=2" gets "PROTO_OK v=2"
+/// and from then on both directions use ProtoV2 binary frames; the public API
+/// and ProtoHandlers stay the same. The link falls back to v1 on disconnect.
+///
+/// "win=<n>" on PROTO / PROTO_OK turns on windowed delivery: PROMPT and BODY
+/// text goes out as numbered chunks ("SEQ" lines / Seq frames) that the
+/// receiver SACKs, only missing chunks are resent (see DataWindow), and the
+/// BODY header and BODY_END are ACKed too, so a lost notification no longer
+/// corrupts a body. Plain DATA is used otherwise.
+///
+/// Token streams can be flow controlled: a watch that calls setTokCredit()
+/// sends "CREDIT c=<n>", the total token bytes the host may have sent so far.
+/// It raises n as the app reports rendered bytes (tokConsumed) and never past
+/// what its inbound queue can hold. A host that has seen a CREDIT holds
+/// tokens beyond n and sends them as credit arrives; creditStats() shows
+/// both ends.
+///
+/// Bodies survive a dropped link. BODY_END carries "crc=<n>", the CRC-32 of
+/// the whole body as the receiver collects it, checked before onBody. On
+/// plain v1 that is the text as DATA lines deliver it: each line with its
+/// trailing spaces, tabs and '\r' trimmed, plus '\n'; blank lines drop out. The receiver keeps what arrived
+/// across a disconnect; once the link is back, resumeBody() sends
+/// "RESUME id=<n> off=<bytes held>" and a sender that still has the body
+/// (streamed with a rewind, or windowed text) answers with
+/// "BODY id=<n> len=<n> off=<n>" and the rest. Plain v1 DATA lines are not
+/// byte-exact, so a receiver that got those asks for off=0 instead.
+///
+/// Journals sync by difference (see JournalSync). sendSync() asks
+/// "SYNC id=<n> t0=<a> t1=<b>"; the peer answers "SUM id=<n> d=<c>:<sum>,..."
+/// (its digest of each child range) or, with few entries there, "KEYS id=<n>
+/// k=<key>,...". Children whose digests differ are asked about in turn, and
+/// what this end lacks comes back from "FETCH id=<n> t0=<a> t1=<b> [k=...]"
+/// as a BODY of records handed to onSyncEntry. Bytes and round trips follow
+/// the number of differing entries, not the journal size. Sync pulls: entries
+/// only this end has are counted, not sent. The fetched bodies must arrive
+/// byte-exact, so sync over v2 or a windowed link.
+///
+/// The connection follows the traffic (see LinkProfile): token streams,
+/// bodies and sync walks ask the central for a short interval and the 2M
+/// PHY; after BLE_IDLE_AFTER_MS without any, a long interval with slave
+/// latency, and the heartbeat slows to PROTO_PING_IDLE_MS. linkProfile()
+/// shows what each profile measured.
 /// </summary>
 class ProtoV1 {
 public:
@@ -75,31 +169,350 @@ public:
   void sendSaveOk(uint32_t id, bool ok);
   void sendBody(uint32_t id, const String& body);
 
+  /// <summary>Search the watch journal for records with every word of terms. Expects ACK + BODY/DATA.../BODY_END.</summary>
+  uint32_t sendFind(const String& terms);
+
+  /// <summary>Fills buf with the next body bytes (at most cap); returns 0 at the end.</summary>
+  using BodySource = std::function<size_t(uint8_t* buf, size_t cap)>;
+
+  /// <summary>Starts the source over from its first byte; false if it cannot.</summary>
+  using BodyRewind = std::function<bool()>;
+
+  /// <summary>
+  /// Send a body of len bytes pulled from src a block at a time as bulk TX
+  /// room frees up (loop() keeps it going), so RAM use does not depend on
+  /// the body size. Same messages as the String overload; replaces any
+  /// streamed body still in progress (a PROMPT still going finishes first). With a rewind the body can be resumed:
+  /// it is kept (source and all) until the next one finishes, and a RESUME
+  /// re-reads it to the asked offset (for the CRC) and sends from there.
+  /// </summary>
+  void sendBody(uint32_t id, size_t len, BodySource src, BodyRewind rewind = nullptr);
+
+  /// <summary>
+  /// Receiver: ask the sender to go on with the body a dropped link cut off.
+  /// Call once the link is back (after any PROTO handshake). Returns the
+  /// body id, or 0 if no body is half received.
+  /// </summary>
+  uint32_t resumeBody();
+
+  /// <summary>A PROMPT or BODY (streamed or from a String) is still being sent.</summary>
+  bool bodyPending() const noexcept { return _bodyOut.stage != BodyStage::Idle || !_bodyNext.empty(); }
+  /// <summary>
+  /// Stream one token chunk. False when the peer's credit is used up and
+  /// PROTO_TOK_HOLD bytes already wait: nothing was queued, offer it again after loop().
+  /// </summary>
+  bool sendTok(const String& chunk);
+  void sendTokEnd();
+
+  /// <summary>
+  /// Host side: ask the peer to switch to ProtoV2, with windowed delivery if
+  /// window > 0. Send nothing else until PROTO_OK arrives; the switch happens when it does.
+  /// </summary>
+  void requestV2(uint8_t window = 0);
+
+  /// <summary>Ask for windowed delivery on v1 text lines (same handshake, v=1).</summary>
+  void requestWindow(uint8_t window = DataWindow::WINDOW);
+
+  /// <summary>Windowed delivery was negotiated on this connection.</summary>
+  bool windowed() const noexcept { return _win != 0; }
+
+  /// <summary>Chunk counters of both directions.</summary>
+  DataWindow::Sender::Stats dataTxStats() const noexcept { return _txw.stats(); }
+  const DataWindow::Receiver::Stats& dataRxStats() const noexcept { return _rxw.stats(); }
+
+  /// <summary>Active framing: 1 = text lines, 2 = binary frames.</summary>
+  uint8_t version() const noexcept { return _v2 ? 2 : 1; }
+
   /// <summary>Transport connectivity hint.</summary>
   bool connected() const noexcept;
 
+  /// <summary>Round-trip estimate, current timeout, and resend counters.</summary>
+  const RetxWheel::Stats& retxStats() const noexcept { return _retx.stats(); }
+
+  // ===== Token flow control (see class comment) =====
+
+  /// <summary>
+  /// Watch side: let the host run at most budget token bytes ahead of what
+  /// tokConsumed() reported (0 = no credit: the host sends freely).
+  /// </summary>
+  void setTokCredit(uint32_t budget);
+
+  /// <summary>Watch side: the app has rendered (or otherwise let go of) n token bytes.</summary>
+  void tokConsumed(uint32_t n) noexcept { _cr.consumed += n; }
+
+  struct CreditStats {
+    // watch (granting) side
+    uint32_t received;      // token bytes taken in on this connection
+    uint32_t consumed;      // ... of which the app reported rendered
+    uint32_t buffered;      // received - consumed, now
+    uint32_t maxBuffered;
+    uint32_t granted;       // last limit sent
+    uint32_t grants;        // CREDIT messages sent
+    // host (sending) side
+    uint32_t limit;         // last limit received (meaningful once credited)
+    uint32_t sent;          // token bytes sent on this connection
+    uint32_t held;          // bytes waiting for credit, now
+    uint32_t maxHeld;
+    uint32_t stalls;        // times tokens had to wait for credit
+    uint32_t stalledMs;     // total time spent waiting
+    uint32_t refused;       // sendTok calls turned away (hold full)
+    bool     credited;      // the peer grants credit on this connection
+  };
+
+  /// <summary>Token credit counters of both roles.</summary>
+  CreditStats creditStats() const noexcept;
+
+  struct BodyStats {
+    // sending side
+    uint32_t suspended;     // bodies cut off by a dropped link, kept for RESUME
+    uint32_t resumed;       // RESUMEs answered from an offset
+    uint32_t notResent;     // body bytes those RESUMEs did not send again
+    uint32_t refused;       // RESUMEs for a body no longer held (NACK "no-resume")
+    // receiving side
+    uint32_t verified;      // bodies whose BODY_END CRC matched
+    uint32_t crcFails;      // ... that did not: NACK "body-crc", no onBody
+  };
+
+  /// <summary>Resume and integrity counters of both roles.</summary>
+  const BodyStats& bodyStats() const noexcept { return _bs; }
+
+  // ===== Journal sync (see class comment) =====
+
+  /// <summary>
+  /// Pull the peer's entries with t0 &lt;= ts &lt; t1 that this journal lacks;
+  /// returns the id onSyncDone reports. Needs the onSync* handlers here and
+  /// on the peer. Replaces a sync still running; a dropped link ends it.
+  /// </summary>
+  uint32_t sendSync(uint32_t t0 = 0, uint32_t t1 = UINT32_MAX);
+
+  /// <summary>A sendSync is still running.</summary>
+  bool syncPending() const noexcept { return _sync.id != 0; }
+
+  struct SyncStats {
+    uint32_t queries;       // SYNCs sent (resends not counted)
+    uint32_t sums;          // ... answered with child digests
+    uint32_t leaves;        // ... answered with keys
+    uint32_t depth;         // deepest tree level asked about (root = 1)
+    uint32_t fetches;       // FETCHes sent
+    uint32_t fetched;       // entries handed to onSyncEntry
+    uint32_t dupes;         // fetched entries this end already had
+    uint32_t bad;           // fetched records that were malformed or not asked for
+    uint32_t peerLacks;     // entries only this end has (not sent: sync pulls)
+    uint32_t failed;        // queries and fetches NACKed or given up
+    bool     complete;      // every difference was looked into
+  };
+
+  /// <summary>Counters of the last sendSync.</summary>
+  const SyncStats& syncStats() const noexcept { return _ss; }
+
+  /// <summary>
+  /// Off: never ask the central for connection parameters (profiles are still
+  /// tracked). For centrals that handle updates badly, or a ProtoV1 playing the host.
+  /// </summary>
+  void setLinkProfiles(bool on) noexcept { _lpOn = on; }
+
+  /// <summary>Connection profile in use, and time, bytes and RTT measured in each.</summary>
+  const LinkProfile& linkProfile() const noexcept { return _lp; }
+
 private:
   BleLink& _link;
   ProtoHandlers _h;
 
-  struct OutTx {
-    String   line;
-    uint32_t id;
-    uint8_t  tries;
-    uint32_t lastSend;
-  };
-
-  std::map<uint32_t, OutTx> _pending;
+  RetxWheel _retx;      // sent commands awaiting ACK
   uint32_t _nextId = 1;
   uint32_t _lastPingMs = 0;
 
-  static constexpr uint32_t ACK_TIMEOUT_MS = 800;
-  static constexpr uint8_t  ACK_RETRIES    = 3;
   static constexpr uint32_t PING_EVERY_MS  = 3000;
 
+  LinkProfile _lp;
+  uint32_t _lpTx = 0;        // link TX bytes at the last _linkStep
+  uint32_t _lpRx = 0;        // inbound bytes since then
+  uint32_t _lpRtt = 0;       // RTT samples already charged
+  bool     _lpBusy = false;  // token or body text moved since then
+  bool     _lpOn = true;     // ask the central (setLinkProfiles)
+
+  // Bytes a DATA message adds around its text: "DATA " + '\n', or a v2
+  // header (type + 2-byte length varint) + CRC.
+  static constexpr size_t DATA_LINE_OVERHEAD  = 6;
+  static constexpr size_t DATA_FRAME_OVERHEAD = 5;
+
+  // ===== Inbound parser (no heap work per line) =====
+
+  /// <summary>Non-owning view into the current inbound line (not NUL-terminated).</summary>
+  struct Slice {
+    const char* p;
+    size_t      n;
+    bool equals(const char* s) const;
+    bool startsWith(const char* s) const;
+    uint32_t toU32() const;   // same result as String::toInt() cast to uint32_t
+  };
+
+  /// <summary>One key=value token; both sides point into the line.</summary>
+  struct Kv { Slice key; Slice val; };
+
+  /// <summary>Inbound verbs, resolved once per line by a hash switch.</summary>
+  enum class Cmd : uint8_t {
+    Unknown, Ack, Nack, Ping, Pong, Tok, TokEnd,
+    SaveOk, SaveErr, ClearOk, ClearErr, Body, Data, BodyEnd,
+    Proto, ProtoOk, Find, Save, Seq, Sack, Credit, Resume,
+    Sync, Sum, Keys, Fetch
+  };
+
+  /// <summary>One inbound message, whichever framing it arrived in.</summary>
+  struct Msg {
+    Cmd      cmd;
+    bool     hasId;
+    uint32_t id;
+    Slice    text;      // DATA/TOK/SEQ payload, NACK reason, FIND terms, SAVE line; SUM/KEYS/FETCH list
+    bool     hasText;
+    uint32_t len;       // BODY length; SEQ seq; SACK cum; CREDIT limit; RESUME offset; BODY_END CRC; SYNC/FETCH t0
+    uint32_t aux;       // SACK mask; SEQ: 1 = the chunk ended at a newline (v1); BODY offset; BODY_END: 1 = has a CRC; SYNC/FETCH t1
+  };
+
+  static constexpr uint8_t MAX_KV = 8;   // extra tokens on a line are ignored
+  Kv      _kv[MAX_KV];
+  uint8_t _kvCount = 0;
+  String  _arg;                          // reused for String-typed callbacks
+  String  _txLine;                       // reused for outbound DATA lines
+
+  // BODY accumulator (READALL replies); DATA lines append while active.
+  // Kept across a disconnect so resumeBody() can continue it.
+  bool     _bodyActive = false;
+  uint32_t _bodyId = 0;
+  String   _bodyBuf;
+  bool     _bodyExact = false;    // _bodyBuf is the sender's bytes (no v1 DATA line seen)
+
+  // Outbound streamed BODY (sendBody with a source); _pumpBody() advances it.
+  enum class BodyStage : uint8_t { Idle, Header, HeaderAck, Data, End };
+  struct BodyOut {
+    BodySource src;
+    BodyRewind rewind;        // set: resumable
+    uint32_t   id = 0;
+    size_t     total = 0;     // advertised length
+    bool       prompt = false; // PROMPT text: header already sent, no BODY_END
+    BodyStage  stage = BodyStage::Idle;
+    bool       eof = false;   // src returned 0
+    size_t     len = 0;       // bytes staged in _bodyOutBuf
+    size_t     off = 0;       // ... of which already sent
+    uint32_t   crc = 0xFFFFFFFFu;   // running CRC-32 of the body as the peer will hold it
+    size_t     from = 0;      // resumed at this offset (BODY off=)
+    size_t     skip = 0;      // bytes still to read past before sending
+  };
+  static constexpr size_t BODY_STAGE_BYTES = 512;   // >= the largest DATA chunk
+  static constexpr size_t BODY_MSG_ROOM    = 40;    // header / BODY_END with margin
+  BodyOut _bodyOut;
+  uint8_t _bodyOutBuf[BODY_STAGE_BYTES];
+  std::vector<BodyOut> _bodyNext;     // PROMPT/BODY text waiting for _bodyOut
+  BodyOut _bodyHeld;                  // last resumable body, finished or cut off
+  BodyStats _bs{};
+  bool _bodyPumping = false;          // inside _pumpBody (a send can deliver a SACK back into it)
+  bool _bodyRepump = false;           // ... and it was asked to run again
+
+  // Windowed delivery (see class comment): 0 = off, else the window in chunks.
+  uint8_t _win = 0;
+  DataWindow::Sender   _txw;          // chunks of _bodyOut
+  DataWindow::Receiver _rxw;          // chunks of stream _rxStream
+  uint32_t _rxStream = 0;
+  static constexpr size_t SEQ_LINE_OVERHEAD  = 28;   // "SEQ <id> <seq>+ <crc> " + '\n'
+  static constexpr size_t SEQ_FRAME_OVERHEAD = 16;   // type, id, len, seq varints + CRC
+
+  // Token credit, both roles; all counts are token text bytes since the connection came up.
+  struct Credit {
+    uint32_t budget = 0;          // watch: setTokCredit(); 0 = off
+    uint32_t received = 0, consumed = 0, maxBuffered = 0;
+    uint32_t granted = 0, grants = 0;
+    bool     credited = false;    // host: a CREDIT arrived on this connection
+    uint32_t limit = 0, sent = 0;
+    String   held;                // host: tokens waiting for credit, in order
+    bool     endHeld = false;     // ... followed by TOK_END
+    uint32_t maxHeld = 0, stalls = 0, stalledMs = 0, stallSince = 0, refused = 0;
+  };
+  Credit _cr;
+
+  // sendSync walk: ranges still to ask about (depth first), SYNCs waiting
+  // for their SUM/KEYS, and FETCHes, sent one at a time (one body at a time).
+  struct SyncRange { uint32_t t0, t1; uint8_t depth; };
+  struct SyncQuery { uint32_t id; SyncRange r; };
+  struct SyncFetch { uint32_t t0, t1; uint8_t n; uint32_t keys[JournalSync::LEAF]; };   // n = 0: all
+  struct SyncState {
+    uint32_t id = 0;                  // sendSync id; 0 = none running
+    std::vector<SyncRange> todo;
+    SyncQuery open[PROTO_SYNC_PARALLEL] = {};
+    std::vector<SyncFetch> fetches;
+    SyncFetch fetching{};             // the FETCH whose body is on its way
+    uint32_t fetchId = 0;
+  };
+  SyncState _sync;
+  SyncStats _ss{};
+  std::vector<uint32_t> _syncOwn;     // local keys of the range being compared
+
+  // Ids of requests we answered lately (a resend must not act twice).
+  uint32_t _seen[8] = {};
+  uint8_t  _seenAt = 0;
+
+  // ProtoV2 state (see class comment)
+  bool _v2 = false;
+  bool _v2Requested = false;
+  bool _wasConnected = false;
+  ProtoV2::Decoder _v2rx;
+
   void _onLine(const String& line);
-  void _txEnqueue(uint32_t id, const String& line);
+  void _onFrame(const ProtoV2::Frame& f);
+  void _dispatch(const Msg& m);
+  void _setV2(bool on);
+  void _parseKv(Slice rest);
+  const Slice* _kvGet(const char* key) const;
+  uint32_t _kvU32(const char* key) const;
+  const String& _argFrom(const Slice& s);
+  static Cmd _lookup(const Slice& cmd);
+
+  /// <summary>FNV-1a, usable in case labels.</summary>
+  static constexpr uint32_t _hash(const char* s, size_t n, uint32_t h = 2166136261u) {
+    return n ? _hash(s + 1, n - 1, (h ^ (uint8_t)*s) * 16777619u) : h;
+  }
+  template <size_t N>
+  static constexpr uint32_t _key(const char (&s)[N]) { return _hash(s, N - 1); }
+
+  static TxPrio _prioOf(ProtoV2::Type t);
+  void _sendFrame(ProtoV2::Type t, bool hasId, uint32_t id, const uint8_t* p, size_t n, bool track);
+  void _sendFrame(ProtoV2::Type t, uint32_t id, const String& payload, bool track);
+  void _sendLenFrame(ProtoV2::Type t, uint32_t id, uint32_t len, bool track);
+  size_t _dataChunk() const;
+  void _pumpBody();
+  void _pumpBodyOnce();
+  void _suspendBody();
+  bool _restartBody(BodyOut& b, size_t off);
+  void _onData(const Slice& text, bool nl, bool body);
+  void _queueText(uint32_t id, const String& text, bool prompt);
+  void _setWindow(uint8_t win);
+  void _sendTokNow(const char* p, size_t n);
+  void _sendTokEndNow();
+  void _flushTok();
+  void _grantCredit(bool force);
+  void _resetCredit();
+  void _tokIn(size_t n) {
+    _lpBusy = true;
+    _cr.received += (uint32_t)n;
+    const uint32_t b = _cr.received > _cr.consumed ? _cr.received - _cr.consumed : 0;
+    if (b > _cr.maxBuffered) _cr.maxBuffered = b;
+  }
+  void _linkStep(uint32_t nowMs);
+  void _syncStep();
+  void _syncEnd(bool notify);
+  void _syncFail(uint32_t id);
+  void _syncReply(const Msg& m);
+  void _syncBody(const String& body);
+  void _syncAnswer(uint32_t id, uint32_t t0, uint32_t t1);
+  size_t _syncLocal(uint32_t t0, uint32_t t1);     // local keys into _syncOwn
+  size_t _syncKeyList(const Slice& s, uint32_t* out, size_t max) const;
+  bool _syncDigestList(const Slice& s, JournalSync::Digest* out) const;
+  void _sendSeq(uint32_t stream, uint32_t seq, const uint8_t* p, size_t n, bool nl);
+  void _sendSack();
+  bool _seenBefore(uint32_t id);
+
+  void _txEnqueue(uint32_t id, const uint8_t* p, size_t n, bool bin, TxPrio prio);
+  void _txEnqueue(uint32_t id, const String& line, TxPrio prio = TxPrio::Normal) {
+    _txEnqueue(id, (const uint8_t*)line.c_str(), line.length(), false, prio);
+  }
   void _txPump(uint32_t nowMs);
-  static String _trim(const String& s);
-  static bool _startsWith(const String& s, const char* prefix);
 };
@@ -0,0 +1,111 @@
+#include "ProtoV2.hpp"
+
+/// <summary>Header + payload + CRC into a caller buffer.</summary>
+size_t ProtoV2::encode(uint8_t* out, size_t cap, Type type, bool hasId, uint32_t id,
+                       const uint8_t* payload, size_t len) {
+  if (len > MAX_PAYLOAD) return 0;
+  uint8_t hdr[11];
+  size_t h = 0;
+  hdr[h++] = (uint8_t)type | (hasId ? ID_FLAG : 0);
+  if (hasId) h += putVarint(hdr + h, id);
+  h += putVarint(hdr + h, (uint32_t)len);
+  if (h + len + 2 > cap) return 0;
+
+  memcpy(out, hdr, h);
+  if (len) memcpy(out + h, payload, len);
+  const uint16_t crc = crc16(out, h + len);
+  out[h + len]     = (uint8_t)(crc & 0xFF);
+  out[h + len + 1] = (uint8_t)(crc >> 8);
+  return h + len + 2;
+}
+
+/// <summary>Bitwise CRC; frames are small, so no table in flash.</summary>
+uint16_t ProtoV2::crc16(const uint8_t* data, size_t n, uint16_t crc) {
+  while (n--) {
+    crc ^= (uint16_t)(*data++) << 8;
+    for (uint8_t b = 0; b < 8; ++b) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+  }
+  return crc;
+}
+
+/// <summary>Nibble table, the same CRC the journal stores per record.</summary>
+uint32_t ProtoV2::crc32(const uint8_t* data, size_t n, uint32_t crc) {
+  static const uint32_t T[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+  };
+  while (n--) {
+    crc ^= *data++;
+    crc = (crc >> 4) ^ T[crc & 15];
+    crc = (crc >> 4) ^ T[crc & 15];
+  }
+  return crc;
+}
+
+size_t ProtoV2::putVarint(uint8_t* out, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) { out[n++] = (uint8_t)(v | 0x80); v >>= 7; }
+  out[n++] = (uint8_t)v;
+  return n;
+}
+
+bool ProtoV2::getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v) {
+  v = 0;
+  for (uint8_t shift = 0; shift < 35; shift += 7) {
+    if (p >= end) return false;
+    const uint8_t b = *p++;
+    v |= (uint32_t)(b & 0x7F) << shift;
+    if (!(b & 0x80)) return true;
+  }
+  return false;
+}
+
+/// <summary>
+/// Try to parse a frame at _buf[0]. Garbage (unknown type, oversize length,
+/// bad CRC) drops one byte so the next call resyncs on the following byte.
+/// </summary>
+size_t ProtoV2::Decoder::_next(Frame& f) {
+  while (_len) {
+    const uint8_t* p = _buf;
+    const uint8_t* end = _buf + _len;
+    const uint8_t t = *p++;
+    const uint8_t base = t & (uint8_t)~ID_FLAG;
+    const bool known = (base >= 0x01 && base <= 0x06) || (base >= 0x10 && base <= 0x1B) || (base >= 0x20 && base <= 0x28);
+    if (!known) { _resyncs++; _consume(1); continue; }
+
+    uint32_t id = 0, len = 0;
+    const bool hasId = (t & ID_FLAG) != 0;
+    const uint8_t* q = p;
+    if (hasId && !getVarint(q, end, id)) {
+      if (end - p >= 5) { _resyncs++; _consume(1); continue; }   // overlong varint
+      return 0;                                                  // need more bytes
+    }
+    if (!getVarint(q, end, len)) {
+      if (end - q >= 5) { _resyncs++; _consume(1); continue; }
+      return 0;
+    }
+    if (len > MAX_PAYLOAD) { _resyncs++; _consume(1); continue; }
+
+    const size_t hdr = (size_t)(q - _buf);
+    const size_t total = hdr + len + 2;
+    if (_len < total) return 0;
+
+    const uint16_t want = (uint16_t)(_buf[hdr + len] | (_buf[hdr + len + 1] << 8));
+    if (crc16(_buf, hdr + len) != want) { _crcErrors++; _consume(1); continue; }
+
+    f.type    = (Type)base;
+    f.hasId   = hasId;
+    f.id      = id;
+    f.payload = _buf + hdr;
+    f.len     = len;
+    _frames++;
+    return total;
+  }
+  return 0;
+}
+
+void ProtoV2::Decoder::_consume(size_t n) {
+  if (n >= _len) { _len = 0; return; }
+  memmove(_buf, _buf + n, _len - n);
+  _len -= n;
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <Arduino.h>
+
+/// <summary>
+/// Compact binary framing (protocol v2). Same messages as ProtoV1, smaller on air:
+///
+///   [type:1][id:varint]?[len:varint][payload:len][crc16:2 LE]
+///
+/// - type bit 7 (ID_FLAG) says an id follows; DATA/TOK/PING frames omit it.
+/// - varints are LEB128 (7 bits per byte, low group first).
+/// - crc16 is CRC-16/CCITT-FALSE over everything before it.
+/// Frames are self-delimiting, so they may be split across or packed into
+/// notifications/writes; the Decoder reassembles and resyncs on bad CRC.
+/// Negotiated in-band by ProtoV1 ("HELLO ... max=2" / "PROTO v=2" / "PROTO_OK v=2").
+/// </summary>
+class ProtoV2 {
+public:
+  /// <summary>Frame types; values are on-air and must not change.</summary>
+  enum class Type : uint8_t {
+    // watch → host
+    Prompt  = 0x01,   // payload: varint text length; DATA frames follow
+    Dsl     = 0x02,   // payload: command text
+    Save    = 0x03,   // payload: journal line
+    ReadAll = 0x04,
+    Clear   = 0x05,
+    Credit  = 0x06,   // payload: varint token-byte limit (see ProtoV1::setTokCredit)
+    // either direction
+    Data    = 0x10,   // payload: raw text chunk
+    Ack     = 0x11,
+    Nack    = 0x12,   // payload: reason text
+    Ping    = 0x13,   // payload: varint timestamp
+    Pong    = 0x14,
+    Seq     = 0x15,   // id = stream (PROMPT/BODY id); payload: varint seq, chunk bytes
+    Sack    = 0x16,   // id = stream; payload: varint cum, varint mask (see DataWindow)
+    Resume  = 0x17,   // id = body; payload: varint offset the receiver holds (see ProtoV1::resumeBody)
+    Sync    = 0x18,   // payload: varint t0, varint t1; answered with Sum or Keys (see ProtoV1::sendSync)
+    Sum     = 0x19,   // id = Sync; payload per child: varint count[, sum:4 LE if count]
+    Keys    = 0x1A,   // id = Sync; payload: key:4 LE each
+    Fetch   = 0x1B,   // payload: varint t0, varint t1[, key:4 LE each]; answered with Body
+    // host → watch
+    Tok     = 0x20,   // payload: token text
+    TokEnd  = 0x21,
+    SaveOk  = 0x22,
+    SaveErr = 0x23,
+    ClearOk = 0x24,
+    ClearErr= 0x25,
+    Body    = 0x26,   // payload: varint body length[, varint resume offset]; DATA frames follow
+    BodyEnd = 0x27,   // payload: [varint CRC-32 of the whole body]
+    Find    = 0x28,   // payload: search terms; answered with Body
+  };
+
+  static constexpr uint8_t  ID_FLAG     = 0x80;
+  static constexpr size_t   MAX_PAYLOAD = 480;
+  static constexpr size_t   MAX_FRAME   = 1 + 5 + 5 + MAX_PAYLOAD + 2;
+
+  /// <summary>One decoded frame; payload points into the decoder's buffer.</summary>
+  struct Frame {
+    Type           type;
+    bool           hasId;
+    uint32_t       id;
+    const uint8_t* payload;
+    size_t         len;
+  };
+
+  /// <summary>Encode one frame into out (cap bytes). Returns bytes written, 0 if it doesn't fit.</summary>
+  static size_t encode(uint8_t* out, size_t cap, Type type, bool hasId, uint32_t id,
+                       const uint8_t* payload, size_t len);
+
+  /// <summary>CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF).</summary>
+  static uint16_t crc16(const uint8_t* data, size_t n, uint16_t crc = 0xFFFF);
+
+  /// <summary>CRC-32 (IEEE, reflected) without the final inversion, so it can run over pieces; send ~crc.</summary>
+  static uint32_t crc32(const uint8_t* data, size_t n, uint32_t crc = 0xFFFFFFFFu);
+
+  /// <summary>Write v as LEB128; returns bytes used (1..5).</summary>
+  static size_t putVarint(uint8_t* out, uint32_t v);
+
+  /// <summary>Read a LEB128 value; false if truncated or longer than 5 bytes.</summary>
+  static bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v);
+
+  /// <summary>
+  /// Streaming frame decoder with a fixed buffer. Feed it whatever bytes
+  /// arrive; complete frames are handed to onFrame(const Frame&).
+  /// </summary>
+  class Decoder {
+  public:
+    template <typename F>
+    void feed(const uint8_t* data, size_t n, F&& onFrame) {
+      while (n) {
+        const size_t room = sizeof(_buf) - _len;
+        const size_t take = n < room ? n : room;
+        memcpy(_buf + _len, data, take);
+        _len += take; data += take; n -= take;
+
+        Frame f;
+        size_t used;
+        while ((used = _next(f)) != 0) {
+          onFrame(f);
+          _consume(used);
+        }
+      }
+    }
+
+    void reset() { _len = 0; }
+
+    uint32_t frames() const    { return _frames; }
+    uint32_t crcErrors() const { return _crcErrors; }
+    uint32_t resyncs() const   { return _resyncs; }
+
+  private:
+    uint8_t  _buf[MAX_FRAME];
+    size_t   _len = 0;
+    uint32_t _frames = 0;
+    uint32_t _crcErrors = 0;
+    uint32_t _resyncs = 0;
+
+    /// <summary>Parse one frame at the head of the buffer; returns its size or 0 if incomplete.</summary>
+    size_t _next(Frame& f);
+    void   _consume(size_t n);
+  };
+};
@@ -0,0 +1,60 @@
+#pragma once
+// Frame pacing for the OLED. Events only mark the screen invalid; loop()
+// asks whether a frame is due and draws at most one per interval, so a burst
+// of tokens or button events collapses into a single frame.
+// C# tether: a dispatcher that coalesces InvalidateVisual() into one render pass.
+
+#include <Arduino.h>
+
+// Minimum frame spacing while streaming (33 ms ≈ 30 fps) and otherwise
+// (0 = draw on the next loop pass after a change).
+#ifndef RENDER_STREAM_MS
+#define RENDER_STREAM_MS 33
+#endif
+#ifndef RENDER_IDLE_MS
+#define RENDER_IDLE_MS 0
+#endif
+
+class RenderScheduler {
+public:
+  struct Stats {
+    uint32_t requests;    // invalidate() calls
+    uint32_t frames;      // frames actually drawn
+    uint32_t coalesced;   // requests folded into a frame that was already pending
+  };
+
+  // Something on screen changed; a frame will follow.
+  void invalidate() {
+    if (_invalid) _stats.coalesced++;
+    _invalid = true;
+    _stats.requests++;
+  }
+
+  // A frame is wanted and at least intervalMs passed since the last one.
+  bool due(uint32_t nowMs, uint32_t intervalMs) const {
+    return _invalid && (_stats.frames == 0 || nowMs - _lastMs >= intervalMs);
+  }
+
+  // Time until due() turns true (0 = now); UINT32_MAX when nothing is pending.
+  uint32_t msUntilDue(uint32_t nowMs, uint32_t intervalMs) const {
+    if (!_invalid) return UINT32_MAX;
+    if (_stats.frames == 0) return 0;
+    const uint32_t since = nowMs - _lastMs;
+    return since >= intervalMs ? 0 : intervalMs - since;
+  }
+
+  // The caller drew the frame.
+  void rendered(uint32_t nowMs) {
+    _invalid = false;
+    _lastMs = nowMs;
+    _stats.frames++;
+  }
+
+  bool pending() const { return _invalid; }
+  const Stats& stats() const { return _stats; }
+
+private:
+  bool     _invalid = false;
+  uint32_t _lastMs = 0;
+  Stats    _stats{};
+};
@@ -0,0 +1,238 @@
+#pragma once
+// Retransmission state for messages that wait for an ACK. Pending messages
+// live in a fixed slab (bytes inline, no heap unless a message is long) and
+// are hung on a hashed timer wheel by their deadline, so a tick only looks
+// at the buckets whose time has come. The timeout follows the link: ACK
+// timing feeds SRTT/RTTVAR (RFC 6298 style, Karn's rule: no samples from
+// resent messages) and each resend of a message doubles its wait.
+// C# tether: the retry half of a TCP socket, minus the window.
+
+#include <Arduino.h>
+#include "BleTxQueue.hpp"
+
+#ifndef PROTO_TX_SLOTS
+#define PROTO_TX_SLOTS 16         // messages awaiting ACK; more are sent untracked
+#endif
+#ifndef PROTO_TX_INLINE
+#define PROTO_TX_INLINE 160       // bytes of a pending message kept in its slot; longer ones spill to a String
+#endif
+#ifndef PROTO_TX_SENDS
+#define PROTO_TX_SENDS 3          // sends per message before it is given up
+#endif
+#ifndef PROTO_RTO_INIT_MS
+#define PROTO_RTO_INIT_MS 800     // timeout until the first RTT sample
+#endif
+#ifndef PROTO_RTO_MIN_MS
+#define PROTO_RTO_MIN_MS 60
+#endif
+#ifndef PROTO_RTO_MAX_MS
+#define PROTO_RTO_MAX_MS 8000
+#endif
+
+class RetxWheel {
+public:
+  static constexpr uint8_t  SLOTS   = PROTO_TX_SLOTS;
+  static constexpr uint8_t  BUCKETS = 32;
+  static constexpr uint32_t TICK_MS = 8;     // bucket width: deadlines fire up to a tick late
+  static_assert(SLOTS < 0xFF, "PROTO_TX_SLOTS must fit a uint8_t index");
+
+  struct Stats {
+    uint32_t srttMs;        // smoothed RTT (0 until the first sample)
+    uint32_t rttvarMs;
+    uint32_t rtoMs;         // timeout a first send gets now
+    uint32_t lastRttMs;
+    uint32_t samples;       // ACKs that gave an RTT sample
+    uint32_t tracked;       // messages added
+    uint32_t acked;
+    uint32_t retransmits;
+    uint32_t timeouts;      // messages given up after PROTO_TX_SENDS sends
+    uint32_t untracked;     // sent without retries because the slab was full
+    uint8_t  inFlight;
+    uint8_t  maxInFlight;
+  };
+
+  // A message due for resending, as handed to tick()'s callback.
+  struct Msg {
+    uint32_t       id;
+    const uint8_t* data;
+    size_t         len;
+    bool           bin;      // ProtoV2 frame (else a text line)
+    TxPrio         prio;     // resends keep their original class
+  };
+
+  RetxWheel() {
+    for (uint8_t b = 0; b < BUCKETS; ++b) _head[b] = NONE;
+    for (uint8_t i = 0; i < SLOTS; ++i) _slot[i].used = false;
+    _stats.rtoMs = PROTO_RTO_INIT_MS;
+  }
+
+  // Track a message that was just sent. False (counted as untracked) when the slab is full.
+  bool add(uint32_t id, const uint8_t* p, size_t n, bool bin, TxPrio prio, uint32_t nowMs) {
+    remove(id);
+    const uint8_t i = _find(id, true);
+    if (i == NONE) { _stats.untracked++; return false; }
+    Slot& s = _slot[i];
+    s.used = true;
+    s.id = id;
+    s.len = n;
+    s.bin = bin;
+    s.prio = prio;
+    s.sends = 1;
+    s.sentMs = nowMs;
+    if (n <= sizeof(s.inl)) { memcpy(s.inl, p, n); s.spill = String(); }
+    else                    { s.spill = ""; s.spill.concat((const char*)p, n); }
+    _arm(i, nowMs + _stats.rtoMs);
+    _stats.tracked++;
+    if (++_stats.inFlight > _stats.maxInFlight) _stats.maxInFlight = _stats.inFlight;
+    return true;
+  }
+
+  // The peer ACKed id: drop it and, if it was sent once, take an RTT sample.
+  bool ack(uint32_t id, uint32_t nowMs) {
+    const uint8_t i = _find(id, false);
+    if (i == NONE) return false;
+    if (_slot[i].sends == 1) _sample(nowMs - _slot[i].sentMs);
+    _stats.acked++;
+    _free(i);
+    return true;
+  }
+
+  // Stop tracking id (NACK, or a reply that settles it). No RTT sample.
+  bool remove(uint32_t id) {
+    const uint8_t i = _find(id, false);
+    if (i == NONE) return false;
+    _free(i);
+    return true;
+  }
+
+  // Fire what is due: resend(const Msg&) for messages with sends left, then
+  // giveUp(id) for the rest (already dropped, so it may add() again).
+  template <typename Resend, typename GiveUp>
+  void tick(uint32_t nowMs, Resend&& resend, GiveUp&& giveUp) {
+    const uint32_t now = nowMs / TICK_MS;
+    if (!_stats.inFlight) { _tick = now; return; }
+    uint8_t due[SLOTS];
+    uint8_t nd = 0;
+    const uint32_t steps = (now - _tick) < BUCKETS ? (now - _tick) : BUCKETS;
+    for (uint32_t t = 1; t <= steps; ++t) {
+      for (uint8_t i = _head[(_tick + t) % BUCKETS]; i != NONE; i = _slot[i].next)
+        if ((int32_t)(_slot[i].dueTick - now) <= 0) due[nd++] = i;
+    }
+    _tick = now;
+    for (uint8_t k = 0; k < nd; ++k) {
+      Slot& s = _slot[due[k]];
+      _unlink(due[k]);
+      if (s.sends >= PROTO_TX_SENDS) {
+        const uint32_t id = s.id;
+        _stats.timeouts++;
+        _free(due[k]);
+        giveUp(id);
+        continue;
+      }
+      s.sends++;
+      _stats.retransmits++;
+      const uint32_t wait = _stats.rtoMs << (s.sends - 1);
+      _arm(due[k], nowMs + (wait < PROTO_RTO_MAX_MS ? wait : PROTO_RTO_MAX_MS));
+      resend(Msg{ s.id, s.spill.length() ? (const uint8_t*)s.spill.c_str() : s.inl, s.len, s.bin, s.prio });
+    }
+  }
+
+  // Time until the next deadline (0 = overdue); UINT32_MAX when nothing is pending.
+  uint32_t msUntilDue(uint32_t nowMs) const {
+    uint32_t best = UINT32_MAX;
+    for (uint8_t i = 0; i < SLOTS; ++i) {
+      if (!_slot[i].used) continue;
+      const int32_t d = (int32_t)(_slot[i].dueTick * TICK_MS - nowMs);
+      const uint32_t ms = d > 0 ? (uint32_t)d : 0;
+      if (ms < best) best = ms;
+    }
+    return best;
+  }
+
+  // id is still waiting for its ACK.
+  bool pending(uint32_t id) const { return _find(id, false) != NONE; }
+
+  uint8_t inFlight() const     { return _stats.inFlight; }
+  const Stats& stats() const   { return _stats; }
+
+private:
+  static constexpr uint8_t NONE = 0xFF;
+
+  struct Slot {
+    bool     used;
+    uint8_t  sends;
+    bool     bin;
+    TxPrio   prio;
+    uint8_t  prev, next;       // bucket list
+    uint32_t id;
+    uint32_t sentMs;           // first send (RTT samples)
+    uint32_t dueTick;          // deadline, in ticks (rounded up)
+    size_t   len;
+    uint8_t  inl[PROTO_TX_INLINE];
+    String   spill;
+  };
+
+  Slot     _slot[SLOTS];
+  uint8_t  _head[BUCKETS];
+  uint32_t _tick = 0;          // last tick processed
+  uint32_t _srtt8 = 0;         // SRTT << 3
+  uint32_t _rttvar4 = 0;       // RTTVAR << 2
+  Stats    _stats{};
+
+  // Ids are sequential, so id % SLOTS is nearly always the slot.
+  uint8_t _find(uint32_t id, bool free) const {
+    for (uint8_t k = 0; k < SLOTS; ++k) {
+      const uint8_t i = (uint8_t)((id + k) % SLOTS);
+      if (free ? !_slot[i].used : (_slot[i].used && _slot[i].id == id)) return i;
+    }
+    return NONE;
+  }
+
+  void _arm(uint8_t i, uint32_t deadlineMs) {
+    uint32_t due = (deadlineMs + TICK_MS - 1) / TICK_MS;
+    if ((int32_t)(due - _tick) <= 0) due = _tick + 1;   // a bucket already passed would wait a lap
+    Slot& s = _slot[i];
+    s.dueTick = due;
+    const uint8_t b = due % BUCKETS;
+    s.prev = NONE;
+    s.next = _head[b];
+    if (s.next != NONE) _slot[s.next].prev = i;
+    _head[b] = i;
+  }
+
+  void _unlink(uint8_t i) {
+    Slot& s = _slot[i];
+    if (s.prev != NONE) _slot[s.prev].next = s.next;
+    else                _head[s.dueTick % BUCKETS] = s.next;
+    if (s.next != NONE) _slot[s.next].prev = s.prev;
+    s.prev = s.next = NONE;
+  }
+
+  // Called for a slot that is armed (on the wheel); _unlink()ed ones skip it.
+  void _free(uint8_t i) {
+    Slot& s = _slot[i];
+    if (s.prev != NONE || _head[s.dueTick % BUCKETS] == i) _unlink(i);
+    s.used = false;
+    if (s.spill.length()) s.spill = String();
+    _stats.inFlight--;
+  }
+
+  // Jacobson/Karels in fixed point; RTO = SRTT + max(tick, 4 * RTTVAR).
+  void _sample(uint32_t rtt) {
+    _stats.lastRttMs = rtt;
+    if (!_stats.samples++) {
+      _srtt8 = rtt << 3;
+      _rttvar4 = rtt << 1;
+    } else {
+      const int32_t err = (int32_t)rtt - (int32_t)(_srtt8 >> 3);
+      _srtt8 += err;                                           // srtt += err / 8
+      _rttvar4 += (uint32_t)(err < 0 ? -err : err) - (_rttvar4 >> 2);   // rttvar += (|err| - rttvar) / 4
+    }
+    _stats.srttMs = _srtt8 >> 3;
+    _stats.rttvarMs = _rttvar4 >> 2;
+    uint32_t rto = _stats.srttMs + (_rttvar4 > TICK_MS ? _rttvar4 : TICK_MS);
+    if (rto < PROTO_RTO_MIN_MS) rto = PROTO_RTO_MIN_MS;
+    if (rto > PROTO_RTO_MAX_MS) rto = PROTO_RTO_MAX_MS;
+    _stats.rtoMs = rto;
+  }
+};
@@ -0,0 +1,85 @@
+#pragma once
+// Lock-free single-producer / single-consumer queue of variable-size byte
+// messages. Stored as [len:2][bytes] in a power-of-two ring; the producer
+// only advances _tail and the consumer only advances _head, so each side
+// touches one atomic and neither ever blocks the other.
+// Used to hand GATT writes from the NimBLE host task to loop().
+// C# tether: Channel.CreateBounded with SingleReader/SingleWriter.
+
+#include <Arduino.h>
+#include <atomic>
+
+template <size_t N>
+class SpscQueue {
+  static_assert(N >= 4 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+  struct Stats {
+    uint32_t queued;      // messages accepted
+    uint32_t drops;       // messages rejected (full, or larger than the ring)
+    uint32_t highWater;   // max bytes ever waiting (including framing)
+  };
+
+  // Producer side. False if there is no room right now.
+  bool push(const uint8_t* p, size_t n) {
+    if (n > 0xFFFF || n + 2 > N) { _drops++; return false; }
+    const size_t tail = _tail.load(std::memory_order_relaxed);
+    const size_t used = tail - _head.load(std::memory_order_acquire);
+    if (N - used < n + 2) return false;
+    const uint8_t hdr[2] = { (uint8_t)(n & 0xFF), (uint8_t)(n >> 8) };
+    _write(tail, hdr, 2);
+    _write(tail + 2, p, n);
+    _tail.store(tail + 2 + n, std::memory_order_release);
+    _queued++;
+    if (used + n + 2 > _highWater) _highWater = (uint32_t)(used + n + 2);
+    return true;
+  }
+
+  // Producer side: give up on a message that never found room.
+  void drop() { _drops++; }
+
+  // Consumer side. Copies the oldest message into out (at most cap bytes;
+  // the rest of a longer one is discarded) and sets n. False if empty.
+  bool pop(uint8_t* out, size_t cap, size_t& n) {
+    const size_t head = _head.load(std::memory_order_relaxed);
+    if (_tail.load(std::memory_order_acquire) == head) return false;
+    uint8_t hdr[2];
+    _read(head, hdr, 2);
+    const size_t len = (size_t)hdr[0] | ((size_t)hdr[1] << 8);
+    n = len < cap ? len : cap;
+    _read(head + 2, out, n);
+    _head.store(head + 2 + len, std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const {
+    return _tail.load(std::memory_order_acquire) == _head.load(std::memory_order_acquire);
+  }
+
+  // Bytes waiting (including framing); approximate while the producer runs.
+  size_t depth() const {
+    return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+  }
+
+  Stats stats() const { return Stats{ _queued, _drops, _highWater }; }
+
+private:
+  uint8_t _buf[N];
+  std::atomic<size_t> _head{ 0 };   // consumer-owned, free-running
+  std::atomic<size_t> _tail{ 0 };   // producer-owned, free-running
+  // Producer-only counters (read by the consumer for reporting).
+  uint32_t _queued = 0, _drops = 0, _highWater = 0;
+
+  void _write(size_t at, const uint8_t* p, size_t n) {
+    const size_t i = at & (N - 1);
+    const size_t first = (n < N - i) ? n : N - i;
+    memcpy(_buf + i, p, first);
+    memcpy(_buf, p + first, n - first);
+  }
+  void _read(size_t at, uint8_t* out, size_t n) const {
+    const size_t i = at & (N - 1);
+    const size_t first = (n < N - i) ? n : N - i;
+    memcpy(out, _buf + i, first);
+    memcpy(out + first, _buf, n - first);
+  }
+};
@@ -0,0 +1,153 @@
+#pragma once
+// Streaming answer view: word-wraps tokens as they arrive instead of
+// re-wrapping the whole response per token. Only the last ROWS wrapped lines
+// are kept (that is all the screen shows), and a render repaints just the
+// rows that changed: normally only the open line, everything on a scroll.
+// Wrapping matches TextWrap::wrapPrint (break on the last space inside the
+// width, else hard-break; a space right after a hard break is dropped).
+// With hardware scroll the view owns the whole panel (no header, 4 rows) and
+// a new line costs one row of I2C traffic via OledView's start-line ring.
+
+#include <Arduino.h>
+#include "OledView.hpp"
+
+#ifndef STREAM_HW_SCROLL
+#define STREAM_HW_SCROLL 1
+#endif
+
+class StreamView {
+public:
+  static constexpr uint8_t WIDTH = 20;   // chars per line, same as wrapPrint
+  static constexpr uint8_t ROWS  = 3;    // body rows under the two header lines
+  static constexpr uint8_t PITCH = 12;   // px between baselines (6x12 font)
+  static constexpr uint8_t RING  = OledView::SCROLL_ROWS > ROWS ? OledView::SCROLL_ROWS : ROWS;
+
+  // Switch between the header + 3 rows layout and the hardware-scrolled one.
+  void setHwScroll(bool on) { _hw = on; invalidate(); }
+  bool hwScroll() const     { return _hw; }
+
+  // Start an empty response.
+  void reset() {
+    _total = 1;
+    _len = 0;
+    _slot(0)[0] = '\0';
+    _scrolled = true;
+    _curDirty = true;
+    invalidate();
+  }
+
+  // Add token text to the open line, wrapping as needed. O(token length).
+  void append(const char* s, size_t n) {
+    for (size_t i = 0; i < n; ++i) _put(s[i]);
+  }
+  void append(const String& s) { append(s.c_str(), s.length()); }
+
+  // The view must repaint everything, e.g. after another screen was shown.
+  bool needsFull(const OledView& oled) const { return oled.clears() != _painted; }
+
+  // Force the next needsFull() to be true.
+  void invalidate() { _painted = UINT32_MAX; }
+
+  // Paint changed rows at baselines firstY, firstY + PITCH, ... (everything
+  // when `full`; the caller has then cleared and drawn the header). Returns rows drawn.
+  // With hardware scroll firstY is unused and `full` restarts the ring.
+  uint8_t render(OledView& oled, int firstY, bool full) {
+    if (_hw) return _renderScroll(oled, full);
+    const uint32_t first = _total > ROWS ? _total - ROWS : 0;
+    uint8_t drawn = 0;
+    for (uint8_t r = 0; r < ROWS; ++r) {
+      const uint32_t idx = first + r;
+      const bool open = idx == _total - 1;
+      if (!(full || _scrolled || (open && _curDirty))) continue;
+      oled.drawRow(firstY + r * PITCH, idx < _total ? _slot(idx) : "");
+      drawn++;
+    }
+    _scrolled = false;
+    _curDirty = false;
+    _painted = oled.clears();
+    _rowsDrawn += drawn;
+    return drawn;
+  }
+
+  uint32_t lines() const     { return _total; }   // wrapped lines so far (incl. the open one)
+  uint32_t rowsDrawn() const { return _rowsDrawn; }
+
+private:
+  char     _ring[RING][WIDTH + 1] = {};
+  uint32_t _total = 1;                  // lines started; the last is open
+  uint8_t  _len = 0;                    // chars on the open line
+  bool     _scrolled = true;            // a line was started since the last render
+  bool     _curDirty = true;            // the open line changed since the last render
+  uint32_t _painted = UINT32_MAX;       // OledView::clears() at the last render
+  uint32_t _rowsDrawn = 0;
+  bool     _hw = STREAM_HW_SCROLL;
+  uint32_t _shownFirst = 0;             // hw scroll: line in the top row at the last render
+  uint32_t _shownOpen = 0;              // hw scroll: line that was open at the last render
+
+  char* _slot(uint32_t idx) { return _ring[idx % RING]; }
+
+  // Scroll the panel by the lines that left the top, then redraw from the
+  // line that was open last time (a wrap may have moved a word off it).
+  uint8_t _renderScroll(OledView& oled, bool full) {
+    constexpr uint8_t R = OledView::SCROLL_ROWS;
+    const uint32_t first = _total > R ? _total - R : 0;
+    uint32_t from;
+    if (full || !oled.scrolling() || first - _shownFirst >= R) {
+      oled.scrollBegin();
+      from = first;
+    } else {
+      for (uint32_t i = _shownFirst; i < first; ++i) oled.scrollAdvance();
+      from = (_scrolled || _curDirty) ? (_shownOpen > first ? _shownOpen : first) : _total;
+    }
+    uint8_t drawn = 0;
+    for (uint32_t idx = from; idx < _total; ++idx) {
+      oled.scrollRow((uint8_t)(idx - first), _slot(idx));
+      drawn++;
+    }
+    _shownFirst = first;
+    _shownOpen = _total - 1;
+    _scrolled = false;
+    _curDirty = false;
+    _painted = oled.clears();
+    _rowsDrawn += drawn;
+    return drawn;
+  }
+
+  void _newLine() {
+    _total++;
+    _len = 0;
+    _slot(_total - 1)[0] = '\0';
+    _scrolled = true;
+  }
+
+  void _put(char c) {
+    if (c == '\r') return;
+    if (c == '\n') { _newLine(); return; }
+    char* cur = _slot(_total - 1);
+    if (_len < WIDTH) {
+      cur[_len++] = c;
+      cur[_len] = '\0';
+      _curDirty = true;
+      return;
+    }
+
+    // Open line is full: move the word after its last space down, or hard-break.
+    int sp = -1;
+    for (int i = _len - 1; i >= 0; --i) if (cur[i] == ' ') { sp = i; break; }
+    char carry[WIDTH];
+    uint8_t k = 0;
+    if (sp >= 0) {
+      for (uint8_t i = (uint8_t)sp + 1; i < _len; ++i) carry[k++] = cur[i];
+      cur[sp] = '\0';
+    } else if (c == ' ') {
+      _newLine();          // the break itself eats this space
+      return;
+    }
+    _newLine();
+    char* next = _slot(_total - 1);
+    memcpy(next, carry, k);
+    next[k++] = c;
+    next[k] = '\0';
+    _len = k;
+  }
+};
@@ -3,8 +3,12 @@
 #include "OledView.hpp"
 #include "BleJournal.hpp"
 #include "JournalStore.hpp"
+#include "JournalWriter.hpp"
 #include "Typist.hpp"
-#include "TextWrap.hpp"
+#include "StreamView.hpp"
+#include "RenderScheduler.hpp"
+#include "LoopRuntime.hpp"
+#include "BootTimeline.hpp"
 
 // --------- Build-time defaults ----------
 #ifndef DEVICE_NAME
@@ -16,45 +20,112 @@
 #ifndef BTN_B
 #define BTN_B 4   // reserved (not used yet)
 #endif
+#ifndef LOOP_STATS_MS
+#define LOOP_STATS_MS 60000   // print loop timing to Serial this often (0 = never)
+#endif
+#ifndef BOOT_SPLASH_MS
+#define BOOT_SPLASH_MS 1500   // splash overlay after a power-on (shorter after a reset pin / brownout)
+#endif
+// Mount LittleFS on a task of its own while the panel is set up.
+#ifndef BOOT_FS_TASK
+#  if defined(BOARD_NATIVE)
+#    define BOOT_FS_TASK 0
+#  else
+#    define BOOT_FS_TASK 1
+#  endif
+#endif
 
 // --------- Instances ----------
 OledView     oled;
 BleJournal   ble;
 JournalStore store;
+JournalWriter journal(store);   // all appends go through here (group commit)
 Typist       typist;
+LoopRuntime  rt;
+BootTimeline boot;
+
+// --------- Loop events ----------
+// Raised from the NimBLE task / the button ISR; they only end rt's wait,
+// loop() then polls everything as usual.
+enum : uint8_t { EV_BLE = 0, EV_BUTTON = 1 };
 
 // --------- Screens ----------
-enum class Screen { Home, Journal, Settings, Typing, Streaming };
+enum class Screen { Home, Journal, Settings, Typing, Streaming, Find };
 static Screen screen = Screen::Home;
 
 // --------- Streaming state ----------
-static String   g_streamBuf;
+static String   g_streamBuf;      // whole answer, saved on TOK_END
+static StreamView g_streamView;   // wrapped tail that is on screen
 static bool     g_streamActive = false;
-static uint32_t g_lastTokenMs = 0;
+static int8_t   g_streamTimer = LoopRuntime::NONE;   // re-armed by each token
 static const uint32_t STREAM_IDLE_TIMEOUT_MS = 8000;
 
+// --------- Rendering ----------
+// Handlers only call requestRedraw(); loop() draws at most one frame per
+// interval. Short-lived status pages are an overlay that a one-shot timer
+// takes down instead of statusPage() + delay().
+static RenderScheduler g_render;
+static struct {
+  char     title[22], line1[22], line2[22];
+  bool     active;
+} g_status;
+static int8_t g_statusTimer = LoopRuntime::NONE;
+
+// --------- Outbound READALL body ----------
+// The journal can outgrow the bulk TX queue and RAM, so it is read in blocks
+// into a fixed staging buffer and fed in as queue room frees up.
+static JournalStore::Reader g_txReader;
+static uint8_t  g_txBuf[512];      // >= the largest notification payload we cut
+static size_t   g_txLen = 0;       // staged bytes
+static size_t   g_txOff = 0;       // ... of which already queued
+static bool     g_txLz = false;    // this transfer is LZ block frames, not text
+static bool     g_hostLz = false;  // the host sent CAPS:LZ on this connection
+
+// --------- Journal search ----------
+// Hit seqs of the last FIND (BLE) or on-device search; openSeqs() readers
+// point into these, so they live as long as the transfer / the Find screen.
+static constexpr size_t FIND_MAX = 16;
+static uint32_t g_findHits[FIND_MAX];
+static uint32_t g_uiHits[FIND_MAX];
+static size_t   g_uiHitN = 0, g_uiHitI = 0;
+static bool     g_findMode = false;       // Typing composes search terms, not a prompt
+static char     g_findTerms[22];
+static char     g_findText[64];           // text of the hit on screen
+
 // --------- Forward decls ----------
 static void drawScreen();
 static void drawTyping(OledView& oled, const Typist& t);
 static void drawStreaming();
 static void finishStream(const char* reason);
-static void bootStep(const char* title, const char* line1, const char* line2,
-                     uint16_t holdLongMs = 1200, uint16_t holdShortMs = 250);
+static void pumpBody();
+static void sendJournal(JournalStore::Reader r, bool header);
+static void runFind(const char* terms);
+static void loadHit();
+static void requestRedraw();
+static void formatLoopStats(char* out, size_t cap);
+static void showStatus(const char* title, const char* line1, const char* line2, uint32_t holdMs);
+static void formatBoot(char* out, size_t cap);
 
 // --------- BLE command handler ----------
+// Called from ble.loop() on the loop task (BleJournal queues the raw writes),
+// so drawing, flash writes and the stream globals need no locking here.
 static void onBleCommand(const String& cmd) {
   Serial.printf("[BLE cmd] %s\n", cmd.c_str());
 
   if (cmd.startsWith("TOK:")) {
-    String chunk = cmd.substring(4);
+    const char* chunk = cmd.c_str() + 4;
+    const size_t n = cmd.length() - 4;
     if (!g_streamActive) {
       g_streamActive = true;
       g_streamBuf = "";
+      g_streamView.reset();
+      g_status.active = false;
       screen = Screen::Streaming;
     }
-    g_streamBuf += chunk;
-    g_lastTokenMs = millis();
-    drawStreaming();
+    g_streamBuf.concat(chunk, n);
+    g_streamView.append(chunk, n);
+    rt.restart(g_streamTimer, STREAM_IDLE_TIMEOUT_MS);
+    requestRedraw();
     return;
   }
   if (cmd == "TOK_END") {
@@ -62,21 +133,131 @@ static void onBleCommand(const String& cmd) {
     return;
   }
   if (cmd.startsWith("SAVE:")) {
-    bool ok = store.appendLine(cmd.substring(5));
+    bool ok = journal.append(cmd.c_str() + 5, cmd.length() - 5);
     ble.notifyText(ok ? "SAVE:OK" : "SAVE:ERR");
     return;
   }
   if (cmd == "READALL") {
-    String body = store.readAll();
-    ble.notifyText(body.length() ? body : "EMPTY");
+    journal.flush();
+    sendJournal(store.openReader(), false);
+    return;
+  }
+  // READ:LAST:<n>, READ:FROM:<seq>, READ:TIME:<t0>:<t1> — a "READ first=<seq>
+  // count=<n>" line, then the records as READALL sends them.
+  if (cmd.startsWith("READ:")) {
+    journal.flush();
+    const char* a = cmd.c_str() + 5;
+    char* end = nullptr;
+    if (!strncmp(a, "LAST:", 5)) {
+      sendJournal(store.openLast(strtoul(a + 5, nullptr, 10)), true);
+    } else if (!strncmp(a, "FROM:", 5)) {
+      sendJournal(store.openFrom(strtoul(a + 5, nullptr, 10)), true);
+    } else if (!strncmp(a, "TIME:", 5)) {
+      const uint32_t t0 = strtoul(a + 5, &end, 10);
+      const uint32_t t1 = (*end == ':') ? strtoul(end + 1, nullptr, 10) : UINT32_MAX;
+      sendJournal(store.openTime(t0, t1), true);
+    } else {
+      ble.notifyText("READ:ERR");
+    }
+    return;
+  }
+  // FIND:<terms> — "FIND hits=<k>", then the newest matching records as
+  // "<seq> <ts> <text>" lines (text even after CAPS:LZ; at most FIND_MAX).
+  if (cmd.startsWith("FIND:")) {
+    journal.flush();
+    g_txReader.close();             // its hit list is about to change
+    JournalStore::FindStats st;
+    const size_t k = store.find(cmd.c_str() + 5, g_findHits, FIND_MAX, &st);
+    char h[64];
+    snprintf(h, sizeof(h), "FIND hits=%u groups=%lu read=%lu", (unsigned)k,
+             (unsigned long)st.groups, (unsigned long)st.records);
+    ble.notifyText(h, TxPrio::Bulk);
+    sendJournal(store.openSeqs(g_findHits, k), false);
+    return;
+  }
+  // The host can decode LZ block frames; journal bodies use them from now on.
+  if (cmd == "CAPS:LZ") {
+    g_hostLz = true;
+    ble.notifyText("CAPS:OK lz=1");
+    return;
+  }
+  // STATS:LOOP — loop pass timing (see LoopRuntime); STATS:BOOT — the boot timeline.
+  if (cmd == "STATS:LOOP" || cmd == "STATS:BOOT") {
+    char h[160];
+    if (cmd == "STATS:LOOP") formatLoopStats(h, sizeof(h));
+    else                     formatBoot(h, sizeof(h));
+    ble.notifyText(h);
     return;
   }
   if (cmd == "CLEAR") {
+    g_txReader.close();             // an unfinished READALL ends here
+    g_txLen = g_txOff = 0;
+    journal.discard();
     ble.notifyText(store.clear() ? "CLEAR:OK" : "CLEAR:ERR");
     return;
   }
 
-  oled.statusPage("BLE CMD", cmd.c_str(), "");
+  showStatus("BLE CMD", cmd.c_str(), "", 1500);
+}
+
+// Start sending a journal range (replacing any unfinished one); EMPTY if it
+// has no records. A host that sent CAPS:LZ gets "LZ first=<seq> count=<n>"
+// and the records as block frames (see JournalStore::Reader) instead.
+static void sendJournal(JournalStore::Reader r, bool header) {
+  g_txReader.close();
+  g_txReader = r;
+  g_txLen = g_txOff = 0;
+  g_txReader.setCompressed(g_hostLz);
+  g_txLz = g_txReader.compressed();
+  if (!g_txReader.size()) {
+    g_txReader.close();
+    ble.notifyText("EMPTY", TxPrio::Bulk);
+    return;
+  }
+  if (header || g_txLz) {
+    char h[40];
+    snprintf(h, sizeof(h), "%s first=%lu count=%lu", g_txLz ? "LZ" : "READ",
+             (unsigned long)g_txReader.first(), (unsigned long)g_txReader.count());
+    ble.notifyText(h, TxPrio::Bulk);
+  }
+  pumpBody();
+}
+
+// Queue the READALL body in notification-sized pieces while the bulk class
+// has room, refilling the staging buffer from the journal as it drains.
+// Higher classes only overtake between messages, so small pieces keep replies
+// responsive; text pieces end after a newline when possible so anything in
+// between lands on a line boundary.
+static void pumpBody() {
+  if (!g_txReader) return;
+  const size_t payload = ble.payloadSize();
+  const size_t PIECE = payload < sizeof(g_txBuf) ? payload : sizeof(g_txBuf);
+  for (;;) {
+    if (g_txLen - g_txOff < PIECE && !g_txReader.done()) {
+      memmove(g_txBuf, g_txBuf + g_txOff, g_txLen - g_txOff);
+      g_txLen -= g_txOff;
+      g_txOff = 0;
+      g_txLen += g_txReader.read(g_txBuf + g_txLen, sizeof(g_txBuf) - g_txLen);
+    }
+    size_t n = g_txLen - g_txOff;
+    if (n == 0) break;
+    const size_t room = ble.txFree(TxPrio::Bulk);
+    const size_t cap = room < PIECE ? room : PIECE;
+    if (cap == 0) return;
+    if (n > cap && !g_txLz) {
+      const uint8_t* p = g_txBuf + g_txOff;
+      size_t cut = cap;
+      for (size_t i = cap; i > 0; --i) if (p[i - 1] == '\n') { cut = i; break; }
+      if (cut < cap && room < PIECE) return;   // wait for room for the whole line
+      n = cut;
+    } else if (n > cap) {
+      n = cap;
+    }
+    if (!ble.notifyBytes(g_txBuf + g_txOff, n, TxPrio::Bulk)) return;
+    g_txOff += n;
+  }
+  g_txReader.close();
+  g_txLen = g_txOff = 0;
 }
 
 // --------- OLED helpers ----------
@@ -85,32 +266,89 @@ static void drawHeader(const char* title) {
   oled.println("--------------------");
 }
 
+// Per token only the rows that changed are redrawn; header + all rows when
+// the screen was entered or something else was drawn meanwhile (the
+// hardware-scrolled view has no header).
 static void drawStreaming() {
-  oled.clear();
-  drawHeader("Streaming");
-  TextWrap::wrapPrint([&](const String& line){
-    char buf[64];
-    size_t n = (line.length() < 63) ? line.length() : 63;
-    line.substring(0, n).toCharArray(buf, n+1);
-    oled.println(buf);
-  }, g_streamBuf, 20);
+  const bool full = g_streamView.needsFull(oled);
+  if (full && !g_streamView.hwScroll()) {
+    oled.clear();
+    drawHeader("Streaming");
+  }
+  g_streamView.render(oled, 36, full);
   oled.show();
 }
 
 static void finishStream(const char* reason) {
-  if (g_streamBuf.length()) store.appendLine(g_streamBuf);
-  oled.statusPage("Done", reason, "Returning...");
-  oled.show();
-  delay(450);
+  if (g_streamBuf.length()) journal.append(g_streamBuf);
+  showStatus("Done", reason, "Returning...", 450);
   g_streamActive = false;
+  rt.stop(g_streamTimer);
   g_streamBuf = "";
   screen = Screen::Journal;
-  drawScreen();
+}
+
+// On-device search: the hits stay on the Find screen, one at a time.
+static void runFind(const char* terms) {
+  journal.flush();
+  strncpy(g_findTerms, terms, sizeof(g_findTerms) - 1);
+  g_findTerms[sizeof(g_findTerms) - 1] = '\0';
+  g_uiHitN = store.find(terms, g_uiHits, FIND_MAX);
+  g_uiHitI = 0;
+  loadHit();
+  screen = Screen::Find;
+  requestRedraw();
+}
+
+// Text of the current hit (its first line's worth) into g_findText.
+static void loadHit() {
+  g_findText[0] = '\0';
+  if (g_uiHitI >= g_uiHitN) return;
+  JournalStore::Reader r = store.openSeqs(&g_uiHits[g_uiHitI], 1);
+  const size_t n = r.read((uint8_t*)g_findText, sizeof(g_findText) - 1);
+  r.close();
+  g_findText[n] = '\0';
+  // Drop the "<seq> <ts> " prefix and the line end.
+  const char* t = g_findText;
+  for (uint8_t sp = 0; *t && sp < 2; ++t) if (*t == ' ') sp++;
+  memmove(g_findText, t, strlen(t) + 1);
+  g_findText[strcspn(g_findText, "\r\n")] = '\0';
+}
+
+static void requestRedraw() { g_render.invalidate(); }
+
+static void showStatus(const char* title, const char* line1, const char* line2, uint32_t holdMs) {
+  auto copy = [](char* dst, const char* src) {
+    strncpy(dst, src ? src : "", sizeof(g_status.title) - 1);
+    dst[sizeof(g_status.title) - 1] = '\0';
+  };
+  copy(g_status.title, title);
+  copy(g_status.line1, line1);
+  copy(g_status.line2, line2);
+  g_status.active = true;
+  rt.restart(g_statusTimer, holdMs);
+  requestRedraw();
+}
+
+static uint32_t renderInterval() { return (screen == Screen::Streaming) ? RENDER_STREAM_MS : RENDER_IDLE_MS; }
+
+// Draw one frame if one is due: the status overlay while it lasts, else the current screen.
+static void renderFrame(uint32_t now) {
+  if (!g_render.due(now, renderInterval())) return;
+  if (g_status.active) oled.statusPage(g_status.title, g_status.line1, g_status.line2);
+  else                 drawScreen();
+  g_render.rendered(now);
+  if (!boot.done(BootTimeline::Frame)) {
+    boot.mark(BootTimeline::Frame);
+    char h[160];
+    formatBoot(h, sizeof(h));
+    Serial.println(h);
+  }
 }
 
 static void drawTyping(OledView& oled, const Typist& t) {
   oled.clear();
-  drawHeader("Compose");
+  drawHeader(g_findMode ? "Find" : "Compose");
   String s = t.c_str();
   for (size_t i = 0; i < s.length(); i += 20) {
     String chunk = s.substring(i, min(i+20, s.length()));
@@ -145,8 +383,24 @@ static void drawScreen() {
       drawHeader("Journal");
       oled.println("Short: Compose");
       oled.println("Long : Read all");
-      oled.println("Triple: Go Home");
+      oled.println("Double: Find");
+      break;
+    case Screen::Find: {
+      char line[22];
+      snprintf(line, sizeof(line), "Find %u/%u", (unsigned)(g_uiHitN ? g_uiHitI + 1 : 0), (unsigned)g_uiHitN);
+      drawHeader(line);
+      if (!g_uiHitN) { oled.println("No match for"); oled.println(g_findTerms); break; }
+      snprintf(line, sizeof(line), "#%lu", (unsigned long)g_uiHits[g_uiHitI]);
+      oled.println(line);
+      for (size_t i = 0, n = strlen(g_findText); i < n && i < 40; i += 20) {
+        char row[21];
+        const size_t k = std::min<size_t>(20, n - i);
+        memcpy(row, g_findText + i, k);
+        row[k] = '\0';
+        oled.println(row);
+      }
       break;
+    }
     case Screen::Settings:
       drawHeader("Settings");
       oled.println("Short: (reserved)");
@@ -158,18 +412,31 @@ static void drawScreen() {
   oled.show();
 }
 
-// --------- Boot visuals ----------
-static uint16_t chooseSplashMs(uint16_t longMs, uint16_t shortMs) {
-  auto reason = esp_reset_reason();
-  if (reason == ESP_RST_POWERON) return longMs;
-  return shortMs;
+// --------- Boot ----------
+// The splash is the status overlay: loop() (and BLE) run while it shows.
+// Software, panic and watchdog resets (and deep-sleep wakes) skip it.
+static uint32_t splashMs() {
+  switch (esp_reset_reason()) {
+    case ESP_RST_POWERON: return BOOT_SPLASH_MS;
+    case ESP_RST_SW: case ESP_RST_PANIC: case ESP_RST_INT_WDT: case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT: case ESP_RST_DEEPSLEEP:
+      return 0;
+    default: return BOOT_SPLASH_MS / 4;
+  }
 }
-static void bootStep(const char* title, const char* line1, const char* line2,
-                     uint16_t holdLongMs, uint16_t holdShortMs) {
-  oled.statusPage(title, line1, line2);
-  oled.show();
-  delay(chooseSplashMs(holdLongMs, holdShortMs));
+
+static void formatBoot(char* out, size_t cap) { boot.format(out, cap, (int)esp_reset_reason()); }
+
+static volatile bool g_fsOk = false;
+#if BOOT_FS_TASK
+static TaskHandle_t g_setupTask = nullptr;
+static void fsMountTask(void*) {
+  g_fsOk = store.begin();
+  boot.mark(BootTimeline::Fs);
+  xTaskNotifyGive(g_setupTask);
+  vTaskDelete(nullptr);
 }
+#endif
 
 // --------- One-button grammar (BTN_A with triple press) ----------
 struct OneButton {
@@ -185,6 +452,14 @@ struct OneButton {
 
   void begin() { pinMode(BTN_A, INPUT_PULLUP); }
 
+  // Time until update() has something to decide without a new edge: the
+  // end of the multi-click gap. Presses and releases wake the loop (EV_BUTTON).
+  uint32_t msUntilDue(uint32_t now) const {
+    if (!shortCount) return UINT32_MAX;
+    const uint32_t since = now - lastShortUp;
+    return since > BTN_DOUBLE_GAP ? 0 : BTN_DOUBLE_GAP + 1 - since;
+  }
+
   void update(std::function<void()> onShort,
               std::function<void()> onDouble,
               std::function<void()> onTriple,
@@ -224,82 +499,148 @@ struct OneButton {
 };
 static OneButton one;
 
+static void IRAM_ATTR onButtonEdge() { rt.postFromISR(EV_BUTTON); }
+
+// --------- Loop timing ----------
+static void formatLoopStats(char* out, size_t cap) {
+  const LoopRuntime::Stats& st = rt.stats();
+  snprintf(out, cap, "LOOP passes=%lu p50=%luus p99=%luus max=%luus slept=%llums wakes=%lu timers=%lu late=%lums",
+           (unsigned long)st.passes, (unsigned long)rt.percentileUs(50), (unsigned long)rt.percentileUs(99),
+           (unsigned long)st.workMaxUs, (unsigned long long)st.sleptMs, (unsigned long)st.eventWakes,
+           (unsigned long)st.timersFired, (unsigned long)st.lateMaxMs);
+}
+
+static void printLoopStats() {
+  char h[160];
+  formatLoopStats(h, sizeof(h));
+  Serial.println(h);
+}
+
+// Wake sources and timers for loop(); after ble.begin() and one.begin().
+static void startRuntime() {
+  if (g_statusTimer != LoopRuntime::NONE) return;   // already running
+  rt.begin();
+  ble.setWake([] { rt.post(EV_BLE); });
+  attachInterrupt(digitalPinToInterrupt(BTN_A), onButtonEdge, CHANGE);
+  g_statusTimer = rt.timer([] { g_status.active = false; requestRedraw(); });
+  g_streamTimer = rt.timer([] { if (g_streamActive) finishStream("Timeout"); });
+  if (LOOP_STATS_MS) rt.every(LOOP_STATS_MS, printLoopStats);
+}
+
 // --------- Arduino entry points ----------
+// BLE first, so a phone can connect while the rest comes up; LittleFS
+// mounts on its own task while the panel is set up. Nothing waits on a
+// splash: it is an overlay the first loop() passes draw.
 void setup() {
+  boot.mark(BootTimeline::Setup);
   Serial.begin(115200);
-  delay(300);
-
-  bootStep("OutloudOS", "Flipper Terminal", "", 1500, 250);
-  bool oledOk = oled.begin();
-  bootStep(DEVICE_NAME, oledOk ? "OLED: OK" : "OLED: FAIL", "Mounting FS...", 900, 150);
-  bool fsOk = store.begin();
-  if (!fsOk) Serial.println("LittleFS mount failed");
-  bootStep(DEVICE_NAME, fsOk ? "FS: OK" : "FS: FAIL", "Starting BLE...", 900, 150);
+
   ble.begin(DEVICE_NAME, onBleCommand);
-  bootStep(DEVICE_NAME, "BLE: Ready", "Open phone app", 1200, 200);
+  boot.mark(BootTimeline::Ble);
+#if BOOT_FS_TASK
+  g_setupTask = xTaskGetCurrentTaskHandle();
+  const bool fsTask = xTaskCreate(fsMountTask, "fsmount", 6144, nullptr, 1, nullptr) == pdPASS;
+#else
+  const bool fsTask = false;
+#endif
+  const bool oledOk = oled.begin();
+  boot.mark(BootTimeline::Oled);
+  if (!fsTask) {
+    g_fsOk = store.begin();
+    boot.mark(BootTimeline::Fs);
+  }
+#if BOOT_FS_TASK
+  else ulTaskNotifyTake(pdTRUE, portMAX_DELAY);   // commands need the journal
+#endif
+  if (!oledOk) Serial.println("OLED init failed");
+  if (!g_fsOk) Serial.println("LittleFS mount failed");
+  else if (const uint32_t lost = store.stats().legacyLost)
+    Serial.printf("journal.txt: %lu lines did not fit the log; kept as /journal.txt.bak\n", (unsigned long)lost);
 
   one.begin();
   typist.clear();
   screen = Screen::Home;
-  drawScreen();
+  startRuntime();
+  const uint32_t splash = splashMs();
+  if (!g_fsOk || !oledOk)  showStatus(DEVICE_NAME, oledOk ? "OLED: OK" : "OLED: FAIL", g_fsOk ? "FS: OK" : "FS: FAIL", BOOT_SPLASH_MS);
+  else if (splash)         showStatus("OutloudOS", DEVICE_NAME, "BLE: Ready", splash);
+  requestRedraw();
+  boot.mark(BootTimeline::Ready);
 }
 
+// One pass: due timers, then every module polled once; then block until the
+// nearest deadline any of them reports, or until a BLE callback or a button
+// edge posts an event.
 void loop() {
-  const uint32_t now = millis();
+  rt.startPass(micros());
+  rt.dispatch(millis());
 
   ble.loop();
-
-  if (g_streamActive && (now - g_lastTokenMs) > STREAM_IDLE_TIMEOUT_MS) {
-    finishStream("Timeout");
-  }
+  pumpBody();
 
   one.update(
     /* onShort  */ [](){
       switch (screen) {
-        case Screen::Home:     screen = Screen::Journal;  drawScreen(); break;
-        case Screen::Journal:  screen = Screen::Typing;   typist.clear(); drawTyping(oled, typist); break;
+        case Screen::Home:     screen = Screen::Journal;  requestRedraw(); break;
+        case Screen::Journal:  screen = Screen::Typing;   g_findMode = false; typist.clear(); requestRedraw(); break;
         case Screen::Settings: /* reserved */ break;
-        case Screen::Typing:   typist.next();  drawTyping(oled, typist); break;
+        case Screen::Typing:   typist.next();  requestRedraw(); break;
         case Screen::Streaming: /* ignore */ break;
+        case Screen::Find:
+          if (g_uiHitN) { g_uiHitI = (g_uiHitI + 1) % g_uiHitN; loadHit(); requestRedraw(); }
+          break;
       }
     },
     /* onDouble */ [](){
-      if (screen == Screen::Typing) { typist.backspace(); drawTyping(oled, typist); }
+      if (screen == Screen::Typing) { typist.backspace(); requestRedraw(); }
+      if (screen == Screen::Journal) { screen = Screen::Typing; g_findMode = true; typist.clear(); requestRedraw(); }
     },
     /* onTriple */ [](){
       screen = Screen::Home;
-      drawScreen();
+      requestRedraw();
     },
     /* onLong   */ [](){
       switch (screen) {
-        case Screen::Home:     screen = Screen::Settings; drawScreen(); break;
-        case Screen::Journal: {
+        case Screen::Home:     screen = Screen::Settings; requestRedraw(); break;
+        case Screen::Journal:
           ble.notifyText("READALL");
-          oled.statusPage("Journal", "Requested READALL", "");
-          oled.show();
-          delay(350);
-          drawScreen();
-        } break;
-        case Screen::Settings: {
+          showStatus("Journal", "Requested READALL", "", 350);
+          break;
+        case Screen::Settings:
           ble.notifyText("CLEAR");
-          oled.statusPage("Settings", "CLEAR requested", "");
-          oled.show();
-          delay(350);
-          drawScreen();
-        } break;
-        case Screen::Typing:   typist.accept(); drawTyping(oled, typist); break;
+          showStatus("Settings", "CLEAR requested", "", 350);
+          break;
+        case Screen::Typing:   typist.accept(); requestRedraw(); break;
         case Screen::Streaming: /* ignore */ break;
+        case Screen::Find:     screen = Screen::Journal; requestRedraw(); break;
       }
     },
     /* onVeryLong */ [](){
-      if (screen == Screen::Typing) {
+      if (screen == Screen::Typing && g_findMode) {
+        g_findMode = false;
+        runFind(typist.c_str());
+      } else if (screen == Screen::Typing) {
         String payload = String("PROMPT:") + typist.c_str();
         ble.notifyText(payload);
-        oled.statusPage("Sending...", "See phone app", "");
-        oled.show();
-        delay(400);
-        screen = Screen::Journal; drawScreen();
+        showStatus("Sending...", "See phone app", "", 400);
+        screen = Screen::Journal;
       }
     }
   );
+
+  journal.loop(millis());
+  // Sealed segments are compressed a block per pass while nothing reads them.
+  const bool compacting = !g_txReader && !g_streamActive && store.compactStep();
+  if (!ble.isConnected()) g_hostLz = false;
+  oled.poll();
+  renderFrame(millis());
+
+  const uint32_t now = millis();
+  uint32_t next = compacting ? 0 : UINT32_MAX;
+  next = std::min(next, ble.msUntilDue(now));
+  next = std::min(next, journal.msUntilDue(now));
+  next = std::min(next, g_render.msUntilDue(now, renderInterval()));
+  next = std::min(next, one.msUntilDue(now));
+  if (oled.retrying()) next = std::min<uint32_t>(next, 1);   // the display task does not wake us
+  rt.idle(now, next);
 }
\ No newline at end of file